@@ -0,0 +1,271 @@
+#include "binary.h"
+
+#include <cerrno>
+#include <fstream>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error.h"
+
+namespace {
+
+constexpr std::string_view kMagic = "SCMB\x01";
+
+enum Tag : uint8_t {
+    NIL,
+    FALSE_BOOLEAN,
+    TRUE_BOOLEAN,
+    INTEGER,
+    SYMBOL,
+    SYMBOL_REF,
+    CELL,
+    CELL_REF
+};
+
+[[noreturn]] void Malformed() {
+    throw SyntaxError("Malformed binary data");
+}
+
+}  // namespace
+
+BinaryWriter::BinaryWriter() : data_(kMagic) {
+}
+
+void BinaryWriter::WriteTag(uint8_t tag) {
+    data_.push_back(static_cast<char>(tag));
+}
+
+void BinaryWriter::WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+        data_.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+}
+
+void BinaryWriter::WriteAtom(const std::shared_ptr<Object>& obj) {
+    if (obj == nullptr) {
+        WriteTag(NIL);
+    } else if (Is<Number>(obj)) {
+        auto value = static_cast<uint64_t>(As<Number>(obj)->GetValue());
+        WriteTag(INTEGER);
+        WriteVarint((value << 1) ^ -(value >> 63));
+    } else if (Is<Boolean>(obj)) {
+        WriteTag(As<Boolean>(obj)->GetValue() ? TRUE_BOOLEAN : FALSE_BOOLEAN);
+    } else if (Is<Symbol>(obj)) {
+        const std::string& name = As<Symbol>(obj)->GetName();
+        auto [it, inserted] = symbols_.emplace(name, symbols_.size());
+        if (inserted) {
+            WriteTag(SYMBOL);
+            WriteVarint(name.size());
+            data_ += name;
+        } else {
+            WriteTag(SYMBOL_REF);
+            WriteVarint(it->second);
+        }
+    } else {
+        throw RuntimeError("Only numbers, booleans, symbols and pairs can be serialized");
+    }
+}
+
+void BinaryWriter::Write(const std::shared_ptr<Object>& obj) {
+    // The cdrs of the cells whose cars are being written, innermost last.
+    std::vector<std::shared_ptr<Object>> rest;
+    std::shared_ptr<Object> current = obj;
+    while (true) {
+        if (auto cell = As<Cell>(current)) {
+            auto [it, inserted] = cells_.emplace(cell.get(), cells_.size());
+            if (inserted) {
+                WriteTag(CELL);
+                rest.emplace_back(cell->GetSecond());
+                current = cell->GetFirst();
+                continue;
+            }
+            WriteTag(CELL_REF);
+            WriteVarint(it->second);
+        } else {
+            WriteAtom(current);
+        }
+        if (rest.empty()) {
+            return;
+        }
+        current = std::move(rest.back());
+        rest.pop_back();
+    }
+}
+
+const std::string& BinaryWriter::GetData() const {
+    return data_;
+}
+
+BinaryReader::BinaryReader(std::string_view data) : data_(data) {
+    if (data_.substr(0, kMagic.size()) != kMagic) {
+        Malformed();
+    }
+    position_ = kMagic.size();
+}
+
+bool BinaryReader::IsEnd() const {
+    return position_ == data_.size();
+}
+
+uint8_t BinaryReader::ReadTag() {
+    if (position_ == data_.size()) {
+        Malformed();
+    }
+    return static_cast<uint8_t>(data_[position_++]);
+}
+
+uint64_t BinaryReader::ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = ReadTag();
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    Malformed();
+}
+
+std::shared_ptr<Object> BinaryReader::ReadValue(uint8_t tag) {
+    switch (tag) {
+        case NIL:
+            return nullptr;
+        case FALSE_BOOLEAN:
+            return New<Boolean>(false);
+        case TRUE_BOOLEAN:
+            return New<Boolean>(true);
+        case INTEGER: {
+            uint64_t value = ReadVarint();
+            return New<Number>(static_cast<int64_t>((value >> 1) ^ -(value & 1)));
+        }
+        case SYMBOL: {
+            uint64_t size = ReadVarint();
+            if (size > data_.size() - position_) {
+                Malformed();
+            }
+            symbols_.emplace_back(New<Symbol>(std::string(data_.substr(position_, size))));
+            position_ += size;
+            return symbols_.back();
+        }
+        case SYMBOL_REF: {
+            uint64_t id = ReadVarint();
+            if (id >= symbols_.size()) {
+                Malformed();
+            }
+            return symbols_[id];
+        }
+        case CELL_REF: {
+            uint64_t id = ReadVarint();
+            if (id >= cells_.size()) {
+                Malformed();
+            }
+            return cells_[id];
+        }
+    }
+    Malformed();
+}
+
+std::shared_ptr<Object> BinaryReader::Next() {
+    std::shared_ptr<Object> root;
+    // The cells whose cars are being read, innermost last. The next value goes to the car or the
+    // cdr of target, or is the root if there is no target yet.
+    std::vector<Cell*> open;
+    Cell* target = nullptr;
+    bool first = false;
+    while (true) {
+        uint8_t tag = ReadTag();
+        std::shared_ptr<Object> value;
+        if (tag == CELL) {
+            cells_.emplace_back(New<Cell>());
+            value = cells_.back();
+        } else {
+            value = ReadValue(tag);
+        }
+        if (target == nullptr) {
+            root = value;
+        } else if (first) {
+            target->SetFirst(value);
+        } else {
+            target->SetSecond(value);
+        }
+        if (tag == CELL) {
+            target = cells_.back().get();
+            first = true;
+            open.push_back(target);
+            continue;
+        }
+        // Anything but a new cell completes the innermost open car.
+        if (open.empty()) {
+            return root;
+        }
+        target = open.back();
+        first = false;
+        open.pop_back();
+    }
+}
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw RuntimeError("Can't open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        close(fd);
+        throw RuntimeError("Can't open " + path);
+    }
+    size_ = info.st_size;
+    int error = 0;
+    if (size_ != 0) {
+        data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        error = errno;
+    }
+    close(fd);
+    if (data_ == MAP_FAILED) {
+        throw std::system_error(error, std::generic_category(), "mmap");
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+}
+
+std::string_view MappedFile::GetData() const {
+    return {static_cast<const char*>(data_), size_};
+}
+
+std::string SerializeBinary(const std::shared_ptr<Object>& obj) {
+    BinaryWriter writer;
+    writer.Write(obj);
+    return writer.GetData();
+}
+
+std::shared_ptr<Object> DeserializeBinary(std::string_view data) {
+    BinaryReader reader(data);
+    auto obj = reader.Next();
+    if (!reader.IsEnd()) {
+        Malformed();
+    }
+    return obj;
+}
+
+void SaveBinaryFile(const std::string& path, const std::shared_ptr<Object>& obj) {
+    std::string data = SerializeBinary(obj);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.write(data.data(), data.size())) {
+        throw RuntimeError("Can't write " + path);
+    }
+}
+
+std::shared_ptr<Object> LoadBinaryFile(const std::string& path) {
+    MappedFile file(path);
+    return DeserializeBinary(file.GetData());
+}
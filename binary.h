@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "object.h"
+
+// A stream of data encoded as tagged values: integers are zigzag varints, every symbol
+// name is stored once and referenced by index afterwards, and a cell that was already
+// written is referenced by index, which preserves shared and cyclic structure.
+class BinaryWriter {
+public:
+    BinaryWriter();
+
+    void Write(const std::shared_ptr<Object>& obj);
+    const std::string& GetData() const;
+
+private:
+    void WriteTag(uint8_t tag);
+    void WriteVarint(uint64_t value);
+    void WriteAtom(const std::shared_ptr<Object>& obj);
+
+    std::string data_;
+    std::unordered_map<std::string, uint64_t> symbols_;
+    std::unordered_map<const Cell*, uint64_t> cells_;
+};
+
+// Decodes one datum per Next call directly from the given memory, which must outlive
+// the reader.
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view data);
+
+    bool IsEnd() const;
+    std::shared_ptr<Object> Next();
+
+private:
+    uint8_t ReadTag();
+    uint64_t ReadVarint();
+    std::shared_ptr<Object> ReadValue(uint8_t tag);
+
+    std::string_view data_;
+    size_t position_ = 0;
+    std::vector<std::shared_ptr<Symbol>> symbols_;
+    std::vector<std::shared_ptr<Cell>> cells_;
+};
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    std::string_view GetData() const;
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+std::string SerializeBinary(const std::shared_ptr<Object>& obj);
+std::shared_ptr<Object> DeserializeBinary(std::string_view data);
+
+void SaveBinaryFile(const std::string& path, const std::shared_ptr<Object>& obj);
+std::shared_ptr<Object> LoadBinaryFile(const std::string& path);
@@ -1,58 +1,756 @@
 #include <algorithm>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <unordered_set>
 
+#include "binary.h"
 #include "error.h"
 #include "builtin_functions.h"
+#include "parser.h"
 #include "scheme.h"
 
-#define CHECKER(args, scope, args_list)  \
-    auto args_list = CellToVector(args); \
-    CheckList(args_list);                \
-    CheckTypes(args_list, scope)
+#define CHECKER(args, scope, args_list)                                  \
+    auto args_list = CellToVector(args);                                 \
+    if (auto error = CheckList(args_list); error != nullptr) {           \
+        return error;                                                    \
+    }                                                                    \
+    if (auto error = CheckTypes(args_list, scope); error != nullptr) {   \
+        return error;                                                    \
+    }
+
+#define RETURN_IF_RAISED(obj)          \
+    if (Interpreter::IsRaised(obj)) { \
+        return obj;                    \
+    }
+
+namespace {
+
+// Evaluates all expressions of a body but the last one, which is left to the caller
+// as a tail call.
+std::shared_ptr<Object> EvaluateBody(const std::shared_ptr<Object>& body,
+                                     std::shared_ptr<Scope> scope) {
+    if (!Is<Cell>(body)) {
+        return RaiseError(ErrorKind::SYNTAX, "Body must contain at least one expression");
+    }
+    // The cells of a body are only reachable from its form, which the caller keeps alive.
+    auto* cell = static_cast<Cell*>(body.get());
+    for (Cell* next = cell->GetNextCell(); next != nullptr; next = cell->GetNextCell()) {
+        auto value = Interpreter::Calculate(cell->GetFirst(), scope);
+        RETURN_IF_RAISED(value);
+        cell = next;
+    }
+    if (cell->PeekSecond() != nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
+    }
+    return Interpreter::TailCall(cell->GetFirst(), scope);
+}
+
+// Evaluates the first cond clause whose test is true. Nothing matches if there is no such clause
+// and no else clause.
+std::shared_ptr<Object> EvaluateClauses(const std::shared_ptr<Object>& clauses,
+                                        std::shared_ptr<Scope> scope, bool* matched) {
+    *matched = true;
+    for (auto rest = clauses; rest != nullptr; rest = As<Cell>(rest)->GetSecond()) {
+        if (!Is<Cell>(rest) || !Is<Cell>(As<Cell>(rest)->GetFirst())) {
+            return RaiseError(ErrorKind::SYNTAX, "cond clause must be a list");
+        }
+        auto clause = As<Cell>(As<Cell>(rest)->GetFirst());
+        if (Is<Symbol>(clause->GetFirst()) && As<Symbol>(clause->GetFirst())->GetName() == "else") {
+            if (As<Cell>(rest)->PeekSecond() != nullptr) {
+                return RaiseError(ErrorKind::SYNTAX, "else must be the last cond clause");
+            }
+            return EvaluateBody(clause->GetSecond(), scope);
+        }
+        auto value = Interpreter::Calculate(clause->GetFirst(), scope);
+        RETURN_IF_RAISED(value);
+        if (IsTrue(value)) {
+            if (clause->PeekSecond() == nullptr) {
+                return value;
+            }
+            return EvaluateBody(clause->GetSecond(), scope);
+        }
+    }
+    *matched = false;
+    return nullptr;
+}
+
+// Evaluates obj, turning the exceptions thrown by host code into raised error objects.
+// Limit errors are never caught by scripts.
+std::shared_ptr<Object> CalculateCatching(const std::shared_ptr<Object>& obj,
+                                          std::shared_ptr<Scope> scope) {
+    try {
+        return Interpreter::Calculate(obj, scope);
+    } catch (const SyntaxError& error) {
+        return RaiseError(ErrorKind::SYNTAX, error.what());
+    } catch (const NameError& error) {
+        return RaiseError(ErrorKind::NAME, error.what());
+    } catch (const RuntimeError& error) {
+        return RaiseError(ErrorKind::RUNTIME, error.what());
+    }
+}
+
+class HandlersGuard {
+public:
+    explicit HandlersGuard(const HandlerFrame* handlers)
+        : context_(GetExecutionContext()), saved_(context_.handlers) {
+        context_.handlers = handlers;
+    }
+    HandlersGuard(const HandlersGuard&) = delete;
+    HandlersGuard& operator=(const HandlersGuard&) = delete;
+    ~HandlersGuard() {
+        context_.handlers = saved_;
+    }
+
+private:
+    ExecutionContext& context_;
+    const HandlerFrame* saved_;
+};
+
+struct Binding {
+    std::string name;
+    std::shared_ptr<Object> init;
+    std::shared_ptr<Object> step;
+};
+
+// Parses ((name init [step]) ...). A step is only allowed in do. Returns the raised error if the
+// bindings are malformed.
+std::shared_ptr<Object> ParseBindings(const std::shared_ptr<Object>& bindings, bool with_step,
+                                      std::vector<Binding>* result) {
+    if (bindings && !Is<Cell>(bindings)) {
+        return RaiseError(ErrorKind::SYNTAX, "Bindings must be a list");
+    }
+    auto list = CellToVector(As<Cell>(bindings));
+    if (list.back() != nullptr) {
+        return RaiseError(ErrorKind::SYNTAX, "Bindings must be a proper list");
+    }
+    for (size_t i = 0; i + 1 < list.size(); ++i) {
+        if (!Is<Cell>(list[i])) {
+            return RaiseError(ErrorKind::SYNTAX, "Binding must be a list");
+        }
+        auto binding = CellToVector(As<Cell>(list[i]));
+        size_t size = binding.size() - 1;
+        if (binding.back() != nullptr || size < 2 || size > (with_step ? 3 : 2) ||
+            !Is<Symbol>(binding[0])) {
+            return RaiseError(ErrorKind::SYNTAX,
+                              "Binding must be a name followed by an expression");
+        }
+        result->push_back({As<Symbol>(binding[0])->GetName(), binding[1],
+                           size == 3 ? binding[2] : nullptr});
+    }
+    return nullptr;
+}
+
+// The code shared by the closures of a lambda form. Returns the raised error if the parameters
+// aren't a proper list of names.
+std::shared_ptr<Object> GetLambdaCode(const std::shared_ptr<Cell>& form,
+                                      const std::shared_ptr<Object>& parameters,
+                                      const std::shared_ptr<Object>& body,
+                                      std::shared_ptr<const LambdaCode>* code) {
+    std::shared_ptr<Object> error;
+    *code = LambdaCode::Get(form, [&]() -> std::optional<LambdaCode> {
+        auto list = CellToVector(As<Cell>(parameters));
+        if (list.back() != nullptr) {
+            error = RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
+            return std::nullopt;
+        }
+        std::vector<std::string> names;
+        for (size_t i = 0; i + 1 < list.size(); ++i) {
+            if (!Is<Symbol>(list[i])) {
+                error = RaiseError(ErrorKind::RUNTIME, "Arguments list must only contains names");
+                return std::nullopt;
+            }
+            names.emplace_back(As<Symbol>(list[i])->GetName());
+        }
+        return LambdaCode(std::move(names), As<Cell>(body));
+    });
+    return error;
+}
+
+// The code of the procedure a named let binds, shared like that of a lambda form.
+std::shared_ptr<const LambdaCode> GetNamedLetCode(const std::shared_ptr<Cell>& form,
+                                                  const std::vector<Binding>& bindings) {
+    auto body = As<Cell>(As<Cell>(form->GetSecond())->GetSecond())->GetSecond();
+    return LambdaCode::Get(form, [&] {
+        std::vector<std::string> names;
+        for (const auto& binding : bindings) {
+            names.emplace_back(binding.name);
+        }
+        return LambdaCode(std::move(names), As<Cell>(body));
+    });
+}
+
+// Returns the raised error if obj doesn't evaluate to a buffer.
+std::shared_ptr<Object> CalculateBuffer(const std::shared_ptr<Object>& obj,
+                                        std::shared_ptr<Scope> scope,
+                                        std::shared_ptr<ForeignBuffer>* buffer) {
+    auto value = Interpreter::Calculate(obj, scope);
+    RETURN_IF_RAISED(value);
+    *buffer = As<ForeignBuffer>(value);
+    if (*buffer == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a buffer");
+    }
+    return nullptr;
+}
+
+// Apply of the comparisons: true if compare holds for every two neighbouring arguments.
+template <class Compare>
+std::shared_ptr<Object> CompareNumbers(const std::vector<std::shared_ptr<Object>>& values,
+                                       Compare compare) {
+    for (const auto& value : values) {
+        if (!Is<Number>(value)) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires integer only arguments");
+        }
+    }
+    for (size_t i = 1; i < values.size(); ++i) {
+        if (!compare(As<Number>(values[i - 1])->GetValue(), As<Number>(values[i])->GetValue())) {
+            return New<Boolean>(false);
+        }
+    }
+    return New<Boolean>(true);
+}
+
+template <class Operation>
+std::shared_ptr<Object> FoldNumbers(const std::vector<std::shared_ptr<Object>>& values,
+                                    int64_t result, Operation operation) {
+    for (const auto& value : values) {
+        auto number = As<Number>(value);
+        if (number == nullptr) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires integer only arguments");
+        }
+        result = operation(result, number->GetValue());
+    }
+    return New<Number>(result);
+}
+
+// Numbers, booleans, symbols and strings are compared by value and anything else but two pairs
+// by identity. Returns nullopt for two pairs, which are compared by structure.
+std::optional<bool> CompareValues(Object* first, Object* second) {
+    if (first == second) {
+        return true;
+    }
+    if (auto* number = dynamic_cast<Number*>(first)) {
+        auto* other = dynamic_cast<Number*>(second);
+        return other != nullptr && number->GetValue() == other->GetValue();
+    }
+    if (auto* boolean = dynamic_cast<Boolean*>(first)) {
+        auto* other = dynamic_cast<Boolean*>(second);
+        return other != nullptr && boolean->GetValue() == other->GetValue();
+    }
+    if (auto* symbol = dynamic_cast<Symbol*>(first)) {
+        auto* other = dynamic_cast<Symbol*>(second);
+        return other != nullptr && symbol->GetName() == other->GetName();
+    }
+    if (auto* string = dynamic_cast<String*>(first)) {
+        auto* other = dynamic_cast<String*>(second);
+        return other != nullptr && string->GetValue() == other->GetValue();
+    }
+    if (dynamic_cast<Cell*>(first) == nullptr || dynamic_cast<Cell*>(second) == nullptr) {
+        return false;
+    }
+    return std::nullopt;
+}
+
+// Compares pairs by structure without recursion, charging a step per pair of pairs. A pair of
+// pairs met again is taken as equal, so circular structures are compared too.
+bool IsEqual(const std::shared_ptr<Object>& first, const std::shared_ptr<Object>& second) {
+    if (auto equal = CompareValues(first.get(), second.get())) {
+        return *equal;
+    }
+    // The objects stay alive, nothing is evaluated while they are compared.
+    std::vector<std::pair<Object*, Object*>> pending = {{first.get(), second.get()}};
+    std::set<std::pair<Object*, Object*>> compared;
+    ExecutionContext& context = GetExecutionContext();
+    while (!pending.empty()) {
+        auto [left, right] = pending.back();
+        pending.pop_back();
+        if (auto equal = CompareValues(left, right)) {
+            if (!*equal) {
+                return false;
+            }
+            continue;
+        }
+        if (!compared.emplace(left, right).second) {
+            continue;
+        }
+        context.ConsumeStep();
+        auto* cell = static_cast<Cell*>(left);
+        auto* other = static_cast<Cell*>(right);
+        pending.emplace_back(cell->GetSecond().get(), other->GetSecond().get());
+        pending.emplace_back(cell->GetFirst().get(), other->GetFirst().get());
+    }
+    return true;
+}
+
+// File names are strings, or symbols when the name is a valid one. Returns null otherwise.
+const std::string* GetFileName(const std::shared_ptr<Object>& obj) {
+    if (auto* string = dynamic_cast<String*>(obj.get())) {
+        return &string->GetValue();
+    }
+    if (auto* symbol = dynamic_cast<Symbol*>(obj.get())) {
+        return &symbol->GetName();
+    }
+    return nullptr;
+}
+
+// Calls visit with every cell of a proper list, charging a step for each. Returns the raised
+// error if list isn't one, a circular list included. The list must not change while it is
+// visited.
+template <class Visit>
+std::shared_ptr<Object> VisitList(const std::shared_ptr<Object>& list, Visit visit) {
+    if (list == nullptr) {
+        return nullptr;
+    }
+    auto* cell = dynamic_cast<Cell*>(list.get());
+    if (cell == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a proper list");
+    }
+    ExecutionContext& context = GetExecutionContext();
+    // Follows at half the speed, so the walk only meets it again on a cycle.
+    Cell* slow = cell;
+    for (bool move_slow = false;; move_slow = !move_slow) {
+        context.ConsumeStep();
+        visit(*cell);
+        Cell* next = cell->GetNextCell();
+        if (next == nullptr) {
+            break;
+        }
+        cell = next;
+        if (move_slow) {
+            slow = slow->GetNextCell();
+        }
+        if (cell == slow) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires a proper list");
+        }
+    }
+    if (cell->PeekSecond() != nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a proper list");
+    }
+    return nullptr;
+}
+
+bool IsProperList(const std::shared_ptr<Object>& list) {
+    if (VisitList(list, [](const Cell&) {}) == nullptr) {
+        return true;
+    }
+    Interpreter::TakeRaised();
+    return false;
+}
+
+// Reads (procedure [init] sequence ...) from an evaluated call, sequences starting at
+// sequence_begin.
+std::shared_ptr<Object> ParseProcedureAndSequences(
+    const std::vector<std::shared_ptr<Object>>& args_list, size_t sequence_begin,
+    std::shared_ptr<Function>* function, std::vector<std::shared_ptr<Object>>* sequences) {
+    *function = args_list.size() < sequence_begin + 2 ? nullptr : As<Function>(args_list[1]);
+    if (*function == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a procedure and lists");
+    }
+    sequences->assign(args_list.begin() + sequence_begin, args_list.end() - 1);
+    return nullptr;
+}
+
+// Like ParseProcedureAndSequences, but the sequences must be proper lists.
+std::shared_ptr<Object> ParseProcedureAndLists(
+    const std::vector<std::shared_ptr<Object>>& args_list, size_t list_begin,
+    std::shared_ptr<Function>* function, std::vector<std::shared_ptr<Object>>* lists) {
+    auto error = ParseProcedureAndSequences(args_list, list_begin, function, lists);
+    RETURN_IF_RAISED(error);
+    // The walk itself doesn't look for cycles, a circular list would keep it going forever.
+    for (const auto& list : *lists) {
+        if (!IsProperList(list)) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires proper lists");
+        }
+    }
+    return nullptr;
+}
+
+// Moves every list to its cdr and puts the cars into values from offset on, charging a step.
+// Returns false once a list has ended, setting *error if it isn't a proper one. The lists are
+// owned, so callbacks may change them between the steps.
+bool NextElements(std::vector<std::shared_ptr<Object>>* lists,
+                  std::vector<std::shared_ptr<Object>>* values, size_t offset,
+                  std::shared_ptr<Object>* error) {
+    GetExecutionContext().ConsumeStep();
+    for (size_t i = 0; i < lists->size(); ++i) {
+        auto& list = (*lists)[i];
+        auto* cell = dynamic_cast<Cell*>(list.get());
+        if (cell == nullptr) {
+            if (list != nullptr) {
+                *error = RaiseError(ErrorKind::RUNTIME, "Function requires proper lists");
+            }
+            return false;
+        }
+        (*values)[offset + i] = cell->GetFirst();
+        list = cell->GetSecond();
+    }
+    return true;
+}
+
+// member and assoc: the first sublist whose car, or the car of whose car when by_key is set,
+// matches the key by equality or by the optional procedure.
+std::shared_ptr<Object> FindInList(const std::vector<std::shared_ptr<Object>>& args_list,
+                                   std::shared_ptr<Scope> scope, bool by_key) {
+    if (args_list.size() != 4 && args_list.size() != 5) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires two or three arguments");
+    }
+    std::shared_ptr<Function> compare;
+    if (args_list.size() == 5) {
+        compare = As<Function>(args_list[3]);
+        if (compare == nullptr) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires a procedure to compare with");
+        }
+    }
+    std::vector<std::shared_ptr<Object>> values = {args_list[1], nullptr};
+    ExecutionContext& context = GetExecutionContext();
+    // Follows at half the speed to find cycles. The list is owned, the procedure may change it.
+    auto slow = args_list[2];
+    bool move_slow = false;
+    for (auto rest = args_list[2]; rest != nullptr;) {
+        context.ConsumeStep();
+        auto* cell = dynamic_cast<Cell*>(rest.get());
+        if (cell == nullptr) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires a proper list");
+        }
+        values[1] = cell->GetFirst();
+        if (by_key) {
+            auto* pair = dynamic_cast<Cell*>(values[1].get());
+            if (pair == nullptr) {
+                return RaiseError(ErrorKind::RUNTIME, "Function requires a list of pairs");
+            }
+            values[1] = pair->GetFirst();
+        }
+        bool matched = false;
+        if (compare != nullptr) {
+            auto result = compare->Apply(values, scope);
+            RETURN_IF_RAISED(result);
+            matched = IsTrue(result);
+        } else {
+            matched = IsEqual(values[0], values[1]);
+        }
+        if (matched) {
+            return by_key ? cell->GetFirst() : rest;
+        }
+        rest = cell->GetSecond();
+        if (move_slow) {
+            auto* slow_cell = dynamic_cast<Cell*>(slow.get());
+            slow = slow_cell != nullptr ? slow_cell->GetSecond() : rest;
+        }
+        move_slow = !move_slow;
+        if (rest != nullptr && rest == slow) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires a proper list");
+        }
+    }
+    return New<Boolean>(false);
+}
+
+// The rest of a stream pair, forcing the promise in its cdr. A cdr that isn't a promise is
+// returned as it is, so eager lists work as streams too.
+std::shared_ptr<Object> ForceRest(const Cell& pair) {
+    auto rest = pair.GetSecond();
+    if (auto promise = As<Promise>(rest)) {
+        return promise->Force();
+    }
+    return rest;
+}
+
+std::shared_ptr<Object> MapStreams(std::shared_ptr<Function> function,
+                                   std::vector<std::shared_ptr<Object>> streams,
+                                   std::shared_ptr<Scope> scope) {
+    std::vector<std::shared_ptr<Object>> values(streams.size());
+    for (size_t i = 0; i < streams.size(); ++i) {
+        auto* pair = dynamic_cast<Cell*>(streams[i].get());
+        if (pair == nullptr) {
+            if (streams[i] != nullptr) {
+                return RaiseError(ErrorKind::RUNTIME, "Function requires streams");
+            }
+            return nullptr;
+        }
+        values[i] = pair->GetFirst();
+    }
+    auto value = function->Apply(values, scope);
+    RETURN_IF_RAISED(value);
+    auto rest = New<Promise>([function, streams = std::move(streams), scope]() mutable {
+        for (auto& stream : streams) {
+            stream = ForceRest(*As<Cell>(stream));
+            RETURN_IF_RAISED(stream);
+        }
+        return MapStreams(function, std::move(streams), scope);
+    });
+    return New<Cell>(std::move(value), std::move(rest));
+}
+
+std::shared_ptr<Object> FilterStream(std::shared_ptr<Function> predicate,
+                                     std::shared_ptr<Object> stream,
+                                     std::shared_ptr<Scope> scope) {
+    std::vector<std::shared_ptr<Object>> values(1);
+    while (stream != nullptr) {
+        auto pair = As<Cell>(stream);
+        if (pair == nullptr) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires a stream");
+        }
+        values[0] = pair->GetFirst();
+        auto keep = predicate->Apply(values, scope);
+        RETURN_IF_RAISED(keep);
+        if (IsTrue(keep)) {
+            auto rest = New<Promise>([predicate, pair, scope] {
+                auto next = ForceRest(*pair);
+                RETURN_IF_RAISED(next);
+                return FilterStream(predicate, std::move(next), scope);
+            });
+            return New<Cell>(std::move(values[0]), std::move(rest));
+        }
+        stream = ForceRest(*pair);
+        RETURN_IF_RAISED(stream);
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Object> TakeStream(int64_t count, const std::shared_ptr<Object>& stream) {
+    if (count <= 0 || stream == nullptr) {
+        return nullptr;
+    }
+    auto pair = As<Cell>(stream);
+    if (pair == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a stream");
+    }
+    if (count == 1) {
+        // The rest of the source isn't needed, so it is never forced.
+        return New<Cell>(pair->GetFirst(), New<Promise>(std::shared_ptr<Object>(nullptr)));
+    }
+    auto rest = New<Promise>([count, pair] {
+        auto next = ForceRest(*pair);
+        RETURN_IF_RAISED(next);
+        return TakeStream(count - 1, next);
+    });
+    return New<Cell>(pair->GetFirst(), std::move(rest));
+}
+
+struct FileReader {
+    explicit FileReader(const std::string& path) : file(path), tokenizer(&file) {
+    }
+
+    std::ifstream file;
+    Tokenizer tokenizer;
+    // The syntax error the file ended with, raised again when the stream is forced again.
+    std::optional<std::string> error;
+};
+
+// A stream of the top-level data of a file, each read when the stream reaches it.
+std::shared_ptr<Object> ReadFileStream(const std::shared_ptr<FileReader>& reader) {
+    if (reader->error) {
+        return RaiseError(ErrorKind::SYNTAX, *reader->error);
+    }
+    if (reader->tokenizer.IsEnd()) {
+        return nullptr;
+    }
+    std::shared_ptr<Object> datum;
+    try {
+        datum = Read(&reader->tokenizer);
+    } catch (const SyntaxError& error) {
+        reader->error = error.what();
+        return RaiseError(ErrorKind::SYNTAX, *reader->error);
+    }
+    return New<Cell>(std::move(datum), New<Promise>([reader] { return ReadFileStream(reader); }));
+}
+
+// Stable natural merge sort: splits the elements into ascending runs and merges neighbouring
+// runs until one is left. Returns the raised error of less, if any.
+std::shared_ptr<Object> MergeSort(std::vector<std::shared_ptr<Object>>* elements,
+                                  const std::shared_ptr<Function>& less,
+                                  std::shared_ptr<Scope> scope) {
+    std::vector<std::shared_ptr<Object>> values(2);
+    std::shared_ptr<Object> error;
+    auto before = [&](const std::shared_ptr<Object>& first, const std::shared_ptr<Object>& second) {
+        values[0] = first;
+        values[1] = second;
+        auto result = less->Apply(values, scope);
+        if (Interpreter::IsRaised(result)) {
+            error = result;
+            return false;
+        }
+        return IsTrue(result);
+    };
+
+    auto& items = *elements;
+    std::vector<size_t> bounds = {0};
+    for (size_t i = 1; i < items.size(); ++i) {
+        if (before(items[i], items[i - 1])) {
+            bounds.push_back(i);
+        }
+        RETURN_IF_RAISED(error);
+    }
+    bounds.push_back(items.size());
+
+    std::vector<std::shared_ptr<Object>> merged(items.size());
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged_bounds = {0};
+        for (size_t run = 0; run + 1 < bounds.size(); run += 2) {
+            size_t left = bounds[run];
+            size_t middle = bounds[run + 1];
+            size_t end = run + 2 < bounds.size() ? bounds[run + 2] : middle;
+            size_t right = middle;
+            size_t out = left;
+            while (left < middle && right < end) {
+                if (before(items[right], items[left])) {
+                    merged[out++] = std::move(items[right++]);
+                } else {
+                    merged[out++] = std::move(items[left++]);
+                }
+                RETURN_IF_RAISED(error);
+            }
+            std::move(items.begin() + left, items.begin() + middle, merged.begin() + out);
+            out += middle - left;
+            std::move(items.begin() + right, items.begin() + end, merged.begin() + out);
+            merged_bounds.push_back(end);
+        }
+        items.swap(merged);
+        bounds = std::move(merged_bounds);
+    }
+    return nullptr;
+}
+
+// Whether the list holds only names and is proper.
+bool IsNameList(const std::vector<std::shared_ptr<Object>>& list) {
+    return list.back() == nullptr && std::all_of(list.begin(), list.end() - 1, [](const auto& obj) {
+               return Is<Symbol>(obj);
+           });
+}
+
+Record* AsRecordOf(const std::shared_ptr<Object>& obj, const RecordType* type) {
+    auto record = dynamic_cast<Record*>(obj.get());
+    return record != nullptr && record->GetType() == type ? record : nullptr;
+}
+
+}  // namespace
+
+bool IsSpecialForm(const std::string& name) {
+    static const std::unordered_set<std::string> kSpecialForms = {
+        "quote", "if",   "define", "set!",  "let",    "let*",        "letrec",
+        "do",    "cond", "begin",  "and",   "or",     "lambda",      "delay",
+        "guard", "cons-stream",    "define-record-type"};
+    return kSpecialForms.contains(name);
+}
+
+void PrepareForm(const std::shared_ptr<Object>& form) {
+    std::vector<std::shared_ptr<Object>> pending = {form};
+    while (!pending.empty()) {
+        auto cell = As<Cell>(pending.back());
+        pending.pop_back();
+        if (cell == nullptr) {
+            continue;
+        }
+        auto list = CellToVector(cell);
+        if (list.back() != nullptr) {
+            continue;
+        }
+        if (Is<Symbol>(list[0])) {
+            const auto& name = As<Symbol>(list[0])->GetName();
+            if (name == "quote") {
+                continue;
+            }
+            auto commands = list.size() > 2 ? As<Cell>(cell->GetSecond())->GetSecond() : nullptr;
+            std::shared_ptr<const LambdaCode> code;
+            std::shared_ptr<Object> error;
+            if (name == "lambda" && list.size() > 3 && (!list[1] || Is<Cell>(list[1]))) {
+                error = GetLambdaCode(cell, list[1], commands, &code);
+            } else if (name == "define" && list.size() > 3 && Is<Cell>(list[1])) {
+                auto arguments = As<Cell>(list[1])->GetSecond();
+                if (!arguments || Is<Cell>(arguments)) {
+                    error = GetLambdaCode(cell, arguments, commands, &code);
+                }
+            } else if (name == "let" && list.size() > 4 && Is<Symbol>(list[1])) {
+                std::vector<Binding> bindings;
+                error = ParseBindings(list[2], false, &bindings);
+                if (!Interpreter::IsRaised(error)) {
+                    GetNamedLetCode(cell, bindings);
+                }
+            }
+            if (Interpreter::IsRaised(error)) {
+                // Left for the evaluation to report.
+                Interpreter::TakeRaised();
+            }
+        }
+        pending.insert(pending.end(), list.begin(), list.end() - 1);
+    }
+}
 
-void DefaultListChecker::CheckList(std::vector<std::shared_ptr<Object>>& args_list) {
+std::shared_ptr<Object> DefaultListChecker::CheckList(
+    std::vector<std::shared_ptr<Object>>& args_list) {
     if (args_list.back() != nullptr) {
-        throw RuntimeError("Combination must be a proper list");
+        return RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
     }
+    return nullptr;
 }
 
-void UnaryFunctionChecker::CheckList(std::vector<std::shared_ptr<Object>>& args_list) {
+std::shared_ptr<Object> UnaryFunctionChecker::CheckList(
+    std::vector<std::shared_ptr<Object>>& args_list) {
     if (args_list.back() != nullptr) {
-        throw RuntimeError("Combination must be a proper list");
+        return RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
     }
     if (args_list.size() != 3) {
-        throw RuntimeError("Unary function requires exactly one argument");
+        return RaiseError(ErrorKind::RUNTIME, "Unary function requires exactly one argument");
     }
+    return nullptr;
 }
 
-void BinaryFunctionChecker::CheckList(std::vector<std::shared_ptr<Object>>& args_list) {
+std::shared_ptr<Object> BinaryFunctionChecker::CheckList(
+    std::vector<std::shared_ptr<Object>>& args_list) {
     if (args_list.back() != nullptr) {
-        throw RuntimeError("Combination must be a proper list");
+        return RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
     }
     if (args_list.size() != 4) {
-        throw RuntimeError("Binary function requires exactly two arguments");
+        return RaiseError(ErrorKind::RUNTIME, "Binary function requires exactly two arguments");
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Object> NullaryFunctionChecker::CheckList(
+    std::vector<std::shared_ptr<Object>>& args_list) {
+    if (args_list.back() != nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
     }
+    if (args_list.size() != 2) {
+        return RaiseError(ErrorKind::RUNTIME, "Function doesn't take any arguments");
+    }
+    return nullptr;
 }
 
-void NonEmptyListChecker::CheckList(std::vector<std::shared_ptr<Object>>& args_list) {
+std::shared_ptr<Object> NonEmptyListChecker::CheckList(
+    std::vector<std::shared_ptr<Object>>& args_list) {
     if (args_list.back() != nullptr) {
-        throw RuntimeError("Combination must be a proper list");
+        return RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
     }
     if (args_list.size() < 3) {
-        throw RuntimeError("Function requires at least one argument");
+        return RaiseError(ErrorKind::RUNTIME, "Function requires at least one argument");
     }
+    return nullptr;
 }
 
-void DefaultTypeChecker::CheckTypes(std::vector<std::shared_ptr<Object>>&, std::shared_ptr<Scope>) {
+std::shared_ptr<Object> DefaultTypeChecker::CheckTypes(std::vector<std::shared_ptr<Object>>&,
+                                                       std::shared_ptr<Scope>) {
+    return nullptr;
 }
 
-void IntegerTypeChecker::CheckTypes(std::vector<std::shared_ptr<Object>>& args_list,
-                                    std::shared_ptr<Scope> scope) {
+std::shared_ptr<Object> IntegerTypeChecker::CheckTypes(
+    std::vector<std::shared_ptr<Object>>& args_list, std::shared_ptr<Scope> scope) {
     for (size_t i = 1; i + 1 < args_list.size(); ++i) {
         args_list[i] = Interpreter::Calculate(args_list[i], scope);
+        RETURN_IF_RAISED(args_list[i]);
         if (!Is<Number>(args_list[i])) {
-            throw RuntimeError("Function requires integer only arguments");
+            return RaiseError(ErrorKind::RUNTIME, "Function requires integer only arguments");
         }
     }
+    return nullptr;
+}
+
+std::shared_ptr<Object> AnyTypeChecker::CheckTypes(std::vector<std::shared_ptr<Object>>& args_list,
+                                                   std::shared_ptr<Scope> scope) {
+    for (size_t i = 1; i + 1 < args_list.size(); ++i) {
+        args_list[i] = Interpreter::Calculate(args_list[i], scope);
+        RETURN_IF_RAISED(args_list[i]);
+    }
+    return nullptr;
 }
 
 std::shared_ptr<Object> Quote::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
@@ -62,38 +760,54 @@ std::shared_ptr<Object> Quote::Invoke(std::shared_ptr<Cell> args, std::shared_pt
 
 std::shared_ptr<Object> IsNumber::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
-    return std::make_shared<Boolean>(
-        Is<Number>(Interpreter::Calculate(CellToVector(args)[1], scope)));
+    auto value = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(value);
+    return New<Boolean>(Is<Number>(value));
 }
 
 std::shared_ptr<Object> Equal::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     for (size_t i = 2; i + 1 < args_list.size(); ++i) {
         if (As<Number>(args_list[i - 1])->GetValue() != As<Number>(args_list[i])->GetValue()) {
-            return std::make_shared<Boolean>(false);
+            return New<Boolean>(false);
         }
     }
-    return std::make_shared<Boolean>(true);
+    return New<Boolean>(true);
+}
+
+std::shared_ptr<Object> Equal::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                     std::shared_ptr<Scope>) {
+    return CompareNumbers(values, std::equal_to<int64_t>{});
 }
 
 std::shared_ptr<Object> Greater::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     for (size_t i = 2; i + 1 < args_list.size(); ++i) {
         if (As<Number>(args_list[i - 1])->GetValue() <= As<Number>(args_list[i])->GetValue()) {
-            return std::make_shared<Boolean>(false);
+            return New<Boolean>(false);
         }
     }
-    return std::make_shared<Boolean>(true);
+    return New<Boolean>(true);
+}
+
+std::shared_ptr<Object> Greater::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                       std::shared_ptr<Scope>) {
+    return CompareNumbers(values, std::greater<int64_t>{});
 }
 
 std::shared_ptr<Object> Less::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     for (size_t i = 2; i + 1 < args_list.size(); ++i) {
         if (As<Number>(args_list[i - 1])->GetValue() >= As<Number>(args_list[i])->GetValue()) {
-            return std::make_shared<Boolean>(false);
+            return New<Boolean>(false);
         }
     }
-    return std::make_shared<Boolean>(true);
+    return New<Boolean>(true);
+}
+
+std::shared_ptr<Object> Less::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                    std::shared_ptr<Scope>) {
+    return CompareNumbers(values, std::less<int64_t>{});
 }
 
 std::shared_ptr<Object> NotGreater::Invoke(std::shared_ptr<Cell> args,
@@ -101,20 +815,30 @@ std::shared_ptr<Object> NotGreater::Invoke(std::shared_ptr<Cell> args,
     CHECKER(args, scope, args_list);
     for (size_t i = 2; i + 1 < args_list.size(); ++i) {
         if (As<Number>(args_list[i - 1])->GetValue() > As<Number>(args_list[i])->GetValue()) {
-            return std::make_shared<Boolean>(false);
+            return New<Boolean>(false);
         }
     }
-    return std::make_shared<Boolean>(true);
+    return New<Boolean>(true);
+}
+
+std::shared_ptr<Object> NotGreater::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                          std::shared_ptr<Scope>) {
+    return CompareNumbers(values, std::less_equal<int64_t>{});
 }
 
 std::shared_ptr<Object> NotLess::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     for (size_t i = 2; i + 1 < args_list.size(); ++i) {
         if (As<Number>(args_list[i - 1])->GetValue() < As<Number>(args_list[i])->GetValue()) {
-            return std::make_shared<Boolean>(false);
+            return New<Boolean>(false);
         }
     }
-    return std::make_shared<Boolean>(true);
+    return New<Boolean>(true);
+}
+
+std::shared_ptr<Object> NotLess::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                       std::shared_ptr<Scope>) {
+    return CompareNumbers(values, std::greater_equal<int64_t>{});
 }
 
 std::shared_ptr<Object> Sum::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
@@ -123,7 +847,12 @@ std::shared_ptr<Object> Sum::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<
     for (size_t i = 1; i + 1 < args_list.size(); ++i) {
         result += As<Number>(args_list[i])->GetValue();
     }
-    return std::make_shared<Number>(result);
+    return New<Number>(result);
+}
+
+std::shared_ptr<Object> Sum::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                   std::shared_ptr<Scope>) {
+    return FoldNumbers(values, 0, std::plus<int64_t>{});
 }
 
 std::shared_ptr<Object> Subtraction::Invoke(std::shared_ptr<Cell> args,
@@ -133,7 +862,7 @@ std::shared_ptr<Object> Subtraction::Invoke(std::shared_ptr<Cell> args,
     for (size_t i = 2; i + 1 < args_list.size(); ++i) {
         result -= As<Number>(args_list[i])->GetValue();
     }
-    return std::make_shared<Number>(result);
+    return New<Number>(result);
 }
 
 std::shared_ptr<Object> Product::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
@@ -142,7 +871,12 @@ std::shared_ptr<Object> Product::Invoke(std::shared_ptr<Cell> args, std::shared_
     for (size_t i = 1; i + 1 < args_list.size(); ++i) {
         result *= As<Number>(args_list[i])->GetValue();
     }
-    return std::make_shared<Number>(result);
+    return New<Number>(result);
+}
+
+std::shared_ptr<Object> Product::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                       std::shared_ptr<Scope>) {
+    return FoldNumbers(values, 1, std::multiplies<int64_t>{});
 }
 
 std::shared_ptr<Object> Division::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
@@ -151,7 +885,7 @@ std::shared_ptr<Object> Division::Invoke(std::shared_ptr<Cell> args, std::shared
     for (size_t i = 2; i + 1 < args_list.size(); ++i) {
         result /= As<Number>(args_list[i])->GetValue();
     }
-    return std::make_shared<Number>(result);
+    return New<Number>(result);
 }
 
 std::shared_ptr<Object> Maximum::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
@@ -160,7 +894,7 @@ std::shared_ptr<Object> Maximum::Invoke(std::shared_ptr<Cell> args, std::shared_
     for (size_t i = 2; i + 1 < args_list.size(); ++i) {
         result = std::max(result, As<Number>(args_list[i])->GetValue());
     }
-    return std::make_shared<Number>(result);
+    return New<Number>(result);
 }
 
 std::shared_ptr<Object> Minimum::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
@@ -169,59 +903,63 @@ std::shared_ptr<Object> Minimum::Invoke(std::shared_ptr<Cell> args, std::shared_
     for (size_t i = 2; i + 1 < args_list.size(); ++i) {
         result = std::min(result, As<Number>(args_list[i])->GetValue());
     }
-    return std::make_shared<Number>(result);
+    return New<Number>(result);
 }
 
 std::shared_ptr<Object> Absolute::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
-    return std::make_shared<Number>(abs(As<Number>(args_list[1])->GetValue()));
+    return New<Number>(abs(As<Number>(args_list[1])->GetValue()));
 }
 
 std::shared_ptr<Object> IsPair::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     auto to_check = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(to_check);
     if (!Is<Cell>(to_check)) {
-        return std::make_shared<Boolean>(false);
-    }
-    auto as_vector = CellToVector(As<Cell>(to_check));
-    if ((as_vector.size() == 2 && as_vector.back() != nullptr) ||
-        (as_vector.size() == 3 && as_vector.back() == nullptr)) {
-        return std::make_shared<Boolean>(true);
+        return New<Boolean>(false);
     }
-    return std::make_shared<Boolean>(false);
+    // A single pair or a list of two.
+    auto* pair = static_cast<Cell*>(to_check.get());
+    auto* next = pair->GetNextCell();
+    return New<Boolean>(next == nullptr ? pair->PeekSecond() != nullptr
+                                        : next->PeekSecond() == nullptr);
 }
 
 std::shared_ptr<Object> IsNull::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
-    return std::make_shared<Boolean>(Interpreter::Calculate(args_list[1], scope) == nullptr);
+    auto value = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(value);
+    return New<Boolean>(value == nullptr);
 }
 
 std::shared_ptr<Object> IsList::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     args_list[1] = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(args_list[1]);
     if (args_list[1] == nullptr) {
-        return std::make_shared<Boolean>(true);
+        return New<Boolean>(true);
     }
     if (!Is<Cell>(args_list[1])) {
-        return std::make_shared<Boolean>(false);
+        return New<Boolean>(false);
     }
-    if (CellToVector(As<Cell>(args_list[1])).back() != nullptr) {
-        return std::make_shared<Boolean>(false);
-    }
-    return std::make_shared<Boolean>(true);
+    return New<Boolean>(IsProperList(args_list[1]));
 }
 
 std::shared_ptr<Object> MakePair::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
-    return std::make_shared<Cell>(Interpreter::Calculate(args_list[1], scope),
-                                  Interpreter::Calculate(args_list[2], scope));
+    auto first = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(first);
+    auto second = Interpreter::Calculate(args_list[2], scope);
+    RETURN_IF_RAISED(second);
+    return New<Cell>(std::move(first), std::move(second));
 }
 
 std::shared_ptr<Object> Front::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     args_list[1] = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(args_list[1]);
     if (!Is<Cell>(args_list[1])) {
-        throw RuntimeError("Function requires only not empty list");
+        return RaiseError(ErrorKind::RUNTIME, "Function requires only not empty list");
     }
     return As<Cell>(args_list[1])->GetFirst();
 }
@@ -230,8 +968,9 @@ std::shared_ptr<Object> AfterFront::Invoke(std::shared_ptr<Cell> args,
                                            std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     args_list[1] = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(args_list[1]);
     if (!Is<Cell>(args_list[1])) {
-        throw RuntimeError("Function requires only not empty list");
+        return RaiseError(ErrorKind::RUNTIME, "Function requires only not empty list");
     }
     return As<Cell>(args_list[1])->GetSecond();
 }
@@ -240,7 +979,9 @@ std::shared_ptr<Object> MakeList::Invoke(std::shared_ptr<Cell> args, std::shared
     CHECKER(args, scope, args_list);
     std::vector<std::shared_ptr<Object>> result_vector;
     for (size_t i = 1; i + 1 < args_list.size(); ++i) {
-        result_vector.emplace_back(Interpreter::Calculate(args_list[i], scope));
+        auto value = Interpreter::Calculate(args_list[i], scope);
+        RETURN_IF_RAISED(value);
+        result_vector.emplace_back(std::move(value));
     }
     result_vector.emplace_back(nullptr);
     return VectorToCell(result_vector);
@@ -250,17 +991,20 @@ std::shared_ptr<Object> GetListElement::Invoke(std::shared_ptr<Cell> args,
                                                std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     args_list[1] = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(args_list[1]);
     args_list[2] = Interpreter::Calculate(args_list[2], scope);
-    if (!Is<Cell>(args_list[1]) || !Is<Number>(args_list[2])) {
-        throw RuntimeError("Function requires only a proper list and a number");
+    RETURN_IF_RAISED(args_list[2]);
+    if (!Is<Cell>(args_list[1]) || !Is<Number>(args_list[2]) || !IsProperList(args_list[1])) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires only a proper list and a number");
     }
-    auto list = CellToVector(As<Cell>(args_list[1]));
-    size_t id = As<Number>(args_list[2])->GetValue();
-    if (list.back() != nullptr) {
-        throw RuntimeError("Function requires only a proper list and a number");
+    int64_t index = As<Number>(args_list[2])->GetValue();
+    if (index < 0) {
+        return RaiseError(ErrorKind::RUNTIME, "Function is trying to access non-existent element");
     }
+    auto list = CellToVector(As<Cell>(args_list[1]));
+    size_t id = index;
     if (list.size() <= id + 1) {
-        throw RuntimeError("Function is trying to access non-existent element");
+        return RaiseError(ErrorKind::RUNTIME, "Function is trying to access non-existent element");
     }
     return list[id];
 }
@@ -269,17 +1013,20 @@ std::shared_ptr<Object> GetListTail::Invoke(std::shared_ptr<Cell> args,
                                             std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     args_list[1] = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(args_list[1]);
     args_list[2] = Interpreter::Calculate(args_list[2], scope);
-    if (!Is<Cell>(args_list[1]) || !Is<Number>(args_list[2])) {
-        throw RuntimeError("Function requires only a proper list and a number");
+    RETURN_IF_RAISED(args_list[2]);
+    if (!Is<Cell>(args_list[1]) || !Is<Number>(args_list[2]) || !IsProperList(args_list[1])) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires only a proper list and a number");
     }
-    auto list = CellToVector(As<Cell>(args_list[1]));
-    size_t id = As<Number>(args_list[2])->GetValue();
-    if (list.back() != nullptr) {
-        throw RuntimeError("Function requires only a proper list and a number");
+    int64_t index = As<Number>(args_list[2])->GetValue();
+    if (index < 0) {
+        return RaiseError(ErrorKind::RUNTIME, "Function is trying to access non-existent element");
     }
+    auto list = CellToVector(As<Cell>(args_list[1]));
+    size_t id = index;
     if (list.size() <= id) {
-        throw RuntimeError("Function is trying to access non-existent element");
+        return RaiseError(ErrorKind::RUNTIME, "Function is trying to access non-existent element");
     }
     return VectorToCell(std::vector<std::shared_ptr<Object>>{list.begin() + id, list.end()});
 }
@@ -287,24 +1034,27 @@ std::shared_ptr<Object> GetListTail::Invoke(std::shared_ptr<Cell> args,
 std::shared_ptr<Object> IsBoolean::Invoke(std::shared_ptr<Cell> args,
                                           std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
-    return std::make_shared<Boolean>(Is<Boolean>(Interpreter::Calculate(args_list[1], scope)));
+    auto value = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(value);
+    return New<Boolean>(Is<Boolean>(value));
 }
 
 std::shared_ptr<Object> LogicalNot::Invoke(std::shared_ptr<Cell> args,
                                            std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     args_list[1] = Interpreter::Calculate(args_list[1], scope);
-    return std::make_shared<Boolean>(Is<Boolean>(args_list[1]) &&
-                                     !As<Boolean>(args_list[1])->GetValue());
+    RETURN_IF_RAISED(args_list[1]);
+    return New<Boolean>(Is<Boolean>(args_list[1]) && !As<Boolean>(args_list[1])->GetValue());
 }
 
 std::shared_ptr<Object> LogicalAnd::Invoke(std::shared_ptr<Cell> args,
                                            std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
-    std::shared_ptr<Object> last_visited = std::make_shared<Boolean>(true);
+    std::shared_ptr<Object> last_visited = New<Boolean>(true);
     for (size_t i = 1; i + 1 < args_list.size(); ++i) {
-        last_visited = args_list[i] = Interpreter::Calculate(args_list[i], scope);
-        if (Is<Boolean>(args_list[i]) && !As<Boolean>(args_list[i])->GetValue()) {
+        last_visited = Interpreter::Calculate(args_list[i], scope);
+        RETURN_IF_RAISED(last_visited);
+        if (!IsTrue(last_visited)) {
             return last_visited;
         }
     }
@@ -314,10 +1064,11 @@ std::shared_ptr<Object> LogicalAnd::Invoke(std::shared_ptr<Cell> args,
 std::shared_ptr<Object> LogicalOr::Invoke(std::shared_ptr<Cell> args,
                                           std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
-    std::shared_ptr<Object> last_visited = std::make_shared<Boolean>(false);
+    std::shared_ptr<Object> last_visited = New<Boolean>(false);
     for (size_t i = 1; i + 1 < args_list.size(); ++i) {
-        last_visited = args_list[i] = Interpreter::Calculate(args_list[i], scope);
-        if (Is<Boolean>(args_list[i]) && As<Boolean>(args_list[i])->GetValue()) {
+        last_visited = Interpreter::Calculate(args_list[i], scope);
+        RETURN_IF_RAISED(last_visited);
+        if (IsTrue(last_visited)) {
             return last_visited;
         }
     }
@@ -328,77 +1079,98 @@ std::shared_ptr<Object> If::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<S
     CHECKER(args, scope, args_list);
     if (args_list.size() == 4) {
         args_list[1] = Interpreter::Calculate(args_list[1], scope);
+        RETURN_IF_RAISED(args_list[1]);
         if (!Is<Boolean>(args_list[1]) || As<Boolean>(args_list[1])->GetValue()) {
-            return Interpreter::Calculate(args_list[2], scope);
+            return Interpreter::TailCall(args_list[2], scope);
         }
         return nullptr;
     } else if (args_list.size() == 5) {
         args_list[1] = Interpreter::Calculate(args_list[1], scope);
+        RETURN_IF_RAISED(args_list[1]);
         if (!Is<Boolean>(args_list[1]) || As<Boolean>(args_list[1])->GetValue()) {
-            return Interpreter::Calculate(args_list[2], scope);
+            return Interpreter::TailCall(args_list[2], scope);
         }
-        return Interpreter::Calculate(args_list[3], scope);
+        return Interpreter::TailCall(args_list[3], scope);
     }
-    throw SyntaxError("if requires exactly two or three arguments");
+    return RaiseError(ErrorKind::SYNTAX, "if requires exactly two or three arguments");
 }
 
 std::shared_ptr<Object> Define::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     if (!Is<Symbol>(args_list[1])) {
         if (!Is<Cell>(args_list[1])) {
-            throw SyntaxError("define first argument must be a name or a list of names");
+            return RaiseError(ErrorKind::SYNTAX,
+                              "define first argument must be a name or a list of names");
         }
         if (!Is<Symbol>(As<Cell>(args_list[1])->GetFirst())) {
-            throw SyntaxError("define first argument must be a name or a list of names");
+            return RaiseError(ErrorKind::SYNTAX,
+                              "define first argument must be a name or a list of names");
         }
         auto arguments = As<Cell>(args_list[1])->GetSecond();
         if (arguments && !Is<Cell>(arguments)) {
-            throw RuntimeError("Combination must be a proper list");
+            return RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
         }
         auto commands = As<Cell>(args->GetSecond())->GetSecond();
         if (commands == nullptr) {
-            throw SyntaxError("lambda-define must contains at least one command");
+            return RaiseError(ErrorKind::SYNTAX,
+                              "lambda-define must contains at least one command");
         }
-        scope->Define(As<Symbol>(As<Cell>(args_list[1])->GetFirst())->GetName(),
-                      std::make_shared<Lambda>(As<Cell>(arguments), As<Cell>(commands), scope));
-        return nullptr;
+        std::shared_ptr<const LambdaCode> code;
+        auto error = GetLambdaCode(args, arguments, commands, &code);
+        RETURN_IF_RAISED(error);
+        return scope->Define(As<Symbol>(As<Cell>(args_list[1])->GetFirst())->GetName(),
+                             New<Lambda>(std::move(code), scope));
     }
     if (args_list.size() != 4) {
-        throw SyntaxError("define requires exactly 2 arguments");
+        return RaiseError(ErrorKind::SYNTAX, "define requires exactly 2 arguments");
     }
-    scope->Define(As<Symbol>(args_list[1])->GetName(), Interpreter::Calculate(args_list[2], scope));
-    return nullptr;
+    auto value = Interpreter::Calculate(args_list[2], scope);
+    RETURN_IF_RAISED(value);
+    return scope->Define(As<Symbol>(args_list[1])->GetName(), std::move(value));
 }
 
 std::shared_ptr<Object> Set::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     if (args_list.size() != 4) {
-        throw SyntaxError("set! requires exactly 2 arguments");
+        return RaiseError(ErrorKind::SYNTAX, "set! requires exactly 2 arguments");
     }
     if (!Is<Symbol>(args_list[1])) {
-        throw SyntaxError("set! first argument should be a name");
+        return RaiseError(ErrorKind::SYNTAX, "set! first argument should be a name");
     }
-    scope->Set(As<Symbol>(args_list[1])->GetName(), Interpreter::Calculate(args_list[2], scope));
-    return nullptr;
+    auto value = Interpreter::Calculate(args_list[2], scope);
+    RETURN_IF_RAISED(value);
+    return scope->Set(As<Symbol>(args_list[1])->GetName(), std::move(value));
 }
 
 std::shared_ptr<Object> SetFront::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     auto list = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(list);
     if (!Is<Cell>(list)) {
-        throw RuntimeError("set-car! requires lists only");
+        return RaiseError(ErrorKind::RUNTIME, "set-car! requires lists only");
     }
-    As<Cell>(list)->SetFirst(Interpreter::Calculate(args_list[2], scope));
+    if (As<Cell>(list)->IsFrozen()) {
+        return RaiseError(ErrorKind::RUNTIME, "set-car! can't change a frozen pair");
+    }
+    auto value = Interpreter::Calculate(args_list[2], scope);
+    RETURN_IF_RAISED(value);
+    As<Cell>(list)->SetFirst(std::move(value));
     return nullptr;
 }
 
 std::shared_ptr<Object> SetTail::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     auto list = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(list);
     if (!Is<Cell>(list)) {
-        throw RuntimeError("set-cdr! requires lists only");
+        return RaiseError(ErrorKind::RUNTIME, "set-cdr! requires lists only");
+    }
+    if (As<Cell>(list)->IsFrozen()) {
+        return RaiseError(ErrorKind::RUNTIME, "set-cdr! can't change a frozen pair");
     }
-    As<Cell>(list)->SetSecond(Interpreter::Calculate(args_list[2], scope));
+    auto value = Interpreter::Calculate(args_list[2], scope);
+    RETURN_IF_RAISED(value);
+    As<Cell>(list)->SetSecond(std::move(value));
     return nullptr;
 }
 
@@ -406,20 +1178,912 @@ std::shared_ptr<Object> MakeLambda::Invoke(std::shared_ptr<Cell> args,
                                            std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
     if (args_list.size() == 2) {
-        throw SyntaxError("lambda requires arguments and commands");
+        return RaiseError(ErrorKind::SYNTAX, "lambda requires arguments and commands");
     }
     if (args_list.size() == 3) {
-        throw SyntaxError("lambda requires at least one command");
+        return RaiseError(ErrorKind::SYNTAX, "lambda requires at least one command");
     }
     auto arguments = args_list[1];
     if (arguments && !Is<Cell>(arguments)) {
-        throw SyntaxError("lambda requires arguments as list");
+        return RaiseError(ErrorKind::SYNTAX, "lambda requires arguments as list");
     }
     auto commands = As<Cell>(args->GetSecond())->GetSecond();
-    return std::make_shared<Lambda>(As<Cell>(arguments), As<Cell>(commands), scope);
+    std::shared_ptr<const LambdaCode> code;
+    auto error = GetLambdaCode(args, arguments, commands, &code);
+    RETURN_IF_RAISED(error);
+    return New<Lambda>(std::move(code), scope);
 }
 
 std::shared_ptr<Object> IsSymbol::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
     CHECKER(args, scope, args_list);
-    return std::make_shared<Boolean>(Is<Symbol>(Interpreter::Calculate(args_list[1], scope)));
-}
\ No newline at end of file
+    auto value = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(value);
+    return New<Boolean>(Is<Symbol>(value));
+}
+
+std::shared_ptr<Object> WriteBinaryFile::Invoke(std::shared_ptr<Cell> args,
+                                                std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto obj = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(obj);
+    auto path = Interpreter::Calculate(args_list[2], scope);
+    RETURN_IF_RAISED(path);
+    const std::string* name = GetFileName(path);
+    if (name == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "write-binary requires a file name");
+    }
+    SaveBinaryFile(*name, obj);
+    return nullptr;
+}
+
+std::shared_ptr<Object> ReadBinaryFile::Invoke(std::shared_ptr<Cell> args,
+                                               std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto path = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(path);
+    const std::string* name = GetFileName(path);
+    if (name == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "read-binary requires a file name");
+    }
+    return LoadBinaryFile(*name);
+}
+
+std::shared_ptr<Object> HeapStatistics::Invoke(std::shared_ptr<Cell> args,
+                                               std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    HeapStats stats = GetHeapStats();
+    std::vector<std::shared_ptr<Object>> result;
+    for (size_t i = 0; i < static_cast<size_t>(ObjectType::COUNT); ++i) {
+        result.emplace_back(VectorToCell(
+            {New<Symbol>(GetObjectTypeName(static_cast<ObjectType>(i))),
+             New<Number>(stats.types[i].allocations), New<Number>(stats.types[i].live_objects),
+             New<Number>(stats.types[i].live_bytes), nullptr}));
+    }
+    result.emplace_back(
+        VectorToCell({New<Symbol>("live-bytes"), New<Number>(stats.live_bytes), nullptr}));
+    result.emplace_back(VectorToCell(
+        {New<Symbol>("peak-live-bytes"), New<Number>(stats.peak_live_bytes), nullptr}));
+    result.emplace_back(nullptr);
+    return VectorToCell(result);
+}
+
+std::shared_ptr<Object> SlabStatistics::Invoke(std::shared_ptr<Cell> args,
+                                               std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::vector<std::shared_ptr<Object>> result;
+    for (const auto& slab : GetSlabStats()) {
+        result.emplace_back(VectorToCell(
+            {New<Symbol>(GetSlabArenaName(slab.arena)),
+             New<Number>(static_cast<int64_t>(slab.block_size)), New<Number>(slab.reserved_blocks),
+             New<Number>(slab.shared_free_blocks), New<Number>(slab.refills),
+             New<Number>(slab.releases), nullptr}));
+    }
+    result.emplace_back(nullptr);
+    return VectorToCell(result);
+}
+
+std::shared_ptr<Object> Let::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (args_list.size() > 2 && Is<Symbol>(args_list[1])) {
+        if (args_list.size() < 5) {
+            return RaiseError(ErrorKind::SYNTAX,
+                              "named let requires bindings and at least one expression");
+        }
+        std::vector<Binding> bindings;
+        auto error = ParseBindings(args_list[2], false, &bindings);
+        RETURN_IF_RAISED(error);
+        auto code = GetNamedLetCode(args, bindings);
+        auto body = As<Cell>(As<Cell>(args->GetSecond())->GetSecond())->GetSecond();
+        auto loop_scope = New<Scope>(scope);
+        loop_scope->Define(As<Symbol>(args_list[1])->GetName(),
+                           New<Lambda>(std::move(code), loop_scope));
+        auto body_scope = New<Scope>(loop_scope);
+        for (const auto& binding : bindings) {
+            auto value = Interpreter::Calculate(binding.init, scope);
+            RETURN_IF_RAISED(value);
+            body_scope->Define(binding.name, std::move(value));
+        }
+        return EvaluateBody(body, body_scope);
+    }
+    if (args_list.size() < 4) {
+        return RaiseError(ErrorKind::SYNTAX, "let requires bindings and at least one expression");
+    }
+    std::vector<Binding> bindings;
+    auto error = ParseBindings(args_list[1], false, &bindings);
+    RETURN_IF_RAISED(error);
+    auto let_scope = New<Scope>(scope);
+    for (const auto& binding : bindings) {
+        auto value = Interpreter::Calculate(binding.init, scope);
+        RETURN_IF_RAISED(value);
+        let_scope->Define(binding.name, std::move(value));
+    }
+    return EvaluateBody(As<Cell>(args->GetSecond())->GetSecond(), let_scope);
+}
+
+std::shared_ptr<Object> LetStar::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (args_list.size() < 4) {
+        return RaiseError(ErrorKind::SYNTAX, "let* requires bindings and at least one expression");
+    }
+    std::vector<Binding> bindings;
+    auto error = ParseBindings(args_list[1], false, &bindings);
+    RETURN_IF_RAISED(error);
+    // Every binding gets a scope of its own, so a closure made by an init only sees the
+    // bindings before it.
+    auto let_scope = scope;
+    for (const auto& binding : bindings) {
+        auto value = Interpreter::Calculate(binding.init, let_scope);
+        RETURN_IF_RAISED(value);
+        let_scope = New<Scope>(std::move(let_scope));
+        let_scope->Define(binding.name, std::move(value));
+    }
+    if (bindings.empty()) {
+        let_scope = New<Scope>(std::move(let_scope));
+    }
+    return EvaluateBody(As<Cell>(args->GetSecond())->GetSecond(), let_scope);
+}
+
+std::shared_ptr<Object> LetRec::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (args_list.size() < 4) {
+        return RaiseError(ErrorKind::SYNTAX,
+                          "letrec requires bindings and at least one expression");
+    }
+    std::vector<Binding> bindings;
+    auto error = ParseBindings(args_list[1], false, &bindings);
+    RETURN_IF_RAISED(error);
+    auto let_scope = New<Scope>(scope);
+    for (const auto& binding : bindings) {
+        let_scope->Define(binding.name, nullptr);
+    }
+    std::vector<std::shared_ptr<Object>> values;
+    for (const auto& binding : bindings) {
+        auto value = Interpreter::Calculate(binding.init, let_scope);
+        RETURN_IF_RAISED(value);
+        values.emplace_back(std::move(value));
+    }
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        let_scope->Define(bindings[i].name, values[i]);
+    }
+    return EvaluateBody(As<Cell>(args->GetSecond())->GetSecond(), let_scope);
+}
+
+std::shared_ptr<Object> Do::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (args_list.size() < 4 || !Is<Cell>(args_list[2])) {
+        return RaiseError(ErrorKind::SYNTAX, "do requires bindings and a termination clause");
+    }
+    std::vector<Binding> bindings;
+    auto error = ParseBindings(args_list[1], true, &bindings);
+    RETURN_IF_RAISED(error);
+    std::vector<std::shared_ptr<Object>> values;
+    for (const auto& binding : bindings) {
+        auto value = Interpreter::Calculate(binding.init, scope);
+        RETURN_IF_RAISED(value);
+        values.emplace_back(std::move(value));
+    }
+    auto test = As<Cell>(args_list[2]);
+    std::shared_ptr<Scope> loop_scope;
+    while (true) {
+        // Every iteration binds the variables afresh, so closures made in the body keep the
+        // values of their own iteration.
+        loop_scope = New<Scope>(scope);
+        for (size_t i = 0; i < bindings.size(); ++i) {
+            loop_scope->Define(bindings[i].name, values[i]);
+        }
+        auto done = Interpreter::Calculate(test->GetFirst(), loop_scope);
+        RETURN_IF_RAISED(done);
+        if (IsTrue(done)) {
+            break;
+        }
+        for (size_t i = 3; i + 1 < args_list.size(); ++i) {
+            auto value = Interpreter::Calculate(args_list[i], loop_scope);
+            RETURN_IF_RAISED(value);
+        }
+        for (size_t i = 0; i < bindings.size(); ++i) {
+            if (bindings[i].step) {
+                values[i] = Interpreter::Calculate(bindings[i].step, loop_scope);
+                RETURN_IF_RAISED(values[i]);
+            } else {
+                loop_scope->Lookup(bindings[i].name, &values[i]);
+            }
+        }
+    }
+    if (test->GetSecond() == nullptr) {
+        return nullptr;
+    }
+    return EvaluateBody(test->GetSecond(), loop_scope);
+}
+
+std::shared_ptr<Object> Cond::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    bool matched;
+    return EvaluateClauses(args->GetSecond(), scope, &matched);
+}
+
+std::shared_ptr<Object> Begin::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (args_list.size() == 2) {
+        return nullptr;
+    }
+    return EvaluateBody(args->GetSecond(), scope);
+}
+
+std::shared_ptr<Object> IsBuffer::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto value = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(value);
+    return New<Boolean>(Is<ForeignBuffer>(value));
+}
+
+std::shared_ptr<Object> BufferLength::Invoke(std::shared_ptr<Cell> args,
+                                             std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::shared_ptr<ForeignBuffer> buffer;
+    if (auto error = CalculateBuffer(args_list[1], scope, &buffer); error != nullptr) {
+        return error;
+    }
+    return New<Number>(buffer->GetSize());
+}
+
+std::shared_ptr<Object> BufferRef::Invoke(std::shared_ptr<Cell> args,
+                                          std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::shared_ptr<ForeignBuffer> buffer;
+    if (auto error = CalculateBuffer(args_list[1], scope, &buffer); error != nullptr) {
+        return error;
+    }
+    auto index = Interpreter::Calculate(args_list[2], scope);
+    RETURN_IF_RAISED(index);
+    if (!Is<Number>(index) || As<Number>(index)->GetValue() < 0) {
+        return RaiseError(ErrorKind::RUNTIME,
+                          "Function requires a buffer and a non-negative number");
+    }
+    return buffer->Get(As<Number>(index)->GetValue());
+}
+
+std::shared_ptr<Object> BufferToList::Invoke(std::shared_ptr<Cell> args,
+                                             std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::shared_ptr<ForeignBuffer> buffer;
+    if (auto error = CalculateBuffer(args_list[1], scope, &buffer); error != nullptr) {
+        return error;
+    }
+    std::shared_ptr<Object> result = nullptr;
+    for (size_t i = buffer->GetSize(); i > 0; --i) {
+        result = New<Cell>(buffer->Get(i - 1), result);
+    }
+    return result;
+}
+
+std::shared_ptr<Object> BufferForEach::Invoke(std::shared_ptr<Cell> args,
+                                              std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto function = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(function);
+    if (!Is<Function>(function)) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a procedure and a buffer");
+    }
+    std::shared_ptr<ForeignBuffer> buffer;
+    if (auto error = CalculateBuffer(args_list[2], scope, &buffer); error != nullptr) {
+        return error;
+    }
+    std::vector<std::shared_ptr<Object>> values(1);
+    for (size_t i = 0; i < buffer->GetSize(); ++i) {
+        values[0] = buffer->Get(i);
+        auto result = As<Function>(function)->Apply(values, scope);
+        RETURN_IF_RAISED(result);
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Object> Guard::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (args_list.size() < 4 || !Is<Cell>(args_list[1]) ||
+        !Is<Symbol>(As<Cell>(args_list[1])->GetFirst())) {
+        return RaiseError(ErrorKind::SYNTAX, "guard requires a variable, clauses and a body");
+    }
+    std::shared_ptr<Object> result;
+    {
+        HandlerFrame frame{nullptr, GetExecutionContext().handlers};
+        HandlersGuard handlers_guard(&frame);
+        for (size_t i = 2; i + 1 < args_list.size(); ++i) {
+            result = CalculateCatching(args_list[i], scope);
+            if (Interpreter::IsRaised(result)) {
+                break;
+            }
+        }
+    }
+    if (!Interpreter::IsRaised(result)) {
+        return result;
+    }
+    auto error = Interpreter::TakeRaised();
+    auto guard_scope = New<Scope>(scope);
+    guard_scope->Define(As<Symbol>(As<Cell>(args_list[1])->GetFirst())->GetName(), error);
+    bool matched;
+    result = EvaluateClauses(As<Cell>(args_list[1])->GetSecond(), guard_scope, &matched);
+    if (!matched) {
+        return Interpreter::Raise(std::move(error));
+    }
+    return result;
+}
+
+std::shared_ptr<Object> WithExceptionHandler::Invoke(std::shared_ptr<Cell> args,
+                                                     std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto handler = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(handler);
+    auto thunk = Interpreter::Calculate(args_list[2], scope);
+    RETURN_IF_RAISED(thunk);
+    if (!Is<Function>(handler) || !Is<Function>(thunk)) {
+        return RaiseError(ErrorKind::RUNTIME, "with-exception-handler requires two procedures");
+    }
+    std::shared_ptr<Object> result;
+    {
+        HandlerFrame frame{handler, GetExecutionContext().handlers};
+        HandlersGuard handlers_guard(&frame);
+        auto call = New<Cell>(thunk, nullptr);
+        result = CalculateCatching(call, scope);
+    }
+    if (!Interpreter::IsRaised(result)) {
+        return result;
+    }
+    return As<Function>(handler)->Apply({Interpreter::TakeRaised()}, scope);
+}
+
+std::shared_ptr<Object> RaiseObject::Invoke(std::shared_ptr<Cell> args,
+                                            std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto obj = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(obj);
+    return Interpreter::Raise(std::move(obj));
+}
+
+std::shared_ptr<Object> RaiseContinuable::Invoke(std::shared_ptr<Cell> args,
+                                                 std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto obj = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(obj);
+    const HandlerFrame* frame = GetExecutionContext().handlers;
+    if (frame == nullptr || frame->handler == nullptr) {
+        return Interpreter::Raise(std::move(obj));
+    }
+    HandlersGuard handlers_guard(frame->next);
+    return As<Function>(frame->handler)->Apply({std::move(obj)}, scope);
+}
+
+std::shared_ptr<Object> MakeError::Invoke(std::shared_ptr<Cell> args,
+                                          std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::vector<std::shared_ptr<Object>> values;
+    for (size_t i = 1; i + 1 < args_list.size(); ++i) {
+        auto value = Interpreter::Calculate(args_list[i], scope);
+        RETURN_IF_RAISED(value);
+        values.emplace_back(std::move(value));
+    }
+    if (!Is<Symbol>(values[0])) {
+        return RaiseError(ErrorKind::RUNTIME, "error requires a message as a symbol");
+    }
+    std::string message = As<Symbol>(values[0])->GetName();
+    values.erase(values.begin());
+    values.emplace_back(nullptr);
+    return Interpreter::Raise(New<ErrorObject>(ErrorKind::RUNTIME, message, VectorToCell(values)));
+}
+
+std::shared_ptr<Object> IsErrorObject::Invoke(std::shared_ptr<Cell> args,
+                                              std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto value = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(value);
+    return New<Boolean>(Is<ErrorObject>(value));
+}
+
+std::shared_ptr<Object> ErrorObjectMessage::Invoke(std::shared_ptr<Cell> args,
+                                                   std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto value = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(value);
+    if (!Is<ErrorObject>(value)) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires an error object");
+    }
+    return New<Symbol>(As<ErrorObject>(value)->GetMessage());
+}
+
+std::shared_ptr<Object> ErrorObjectIrritants::Invoke(std::shared_ptr<Cell> args,
+                                                     std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto value = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(value);
+    if (!Is<ErrorObject>(value)) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires an error object");
+    }
+    return As<ErrorObject>(value)->GetIrritants();
+}
+
+std::shared_ptr<Object> Length::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    int64_t length = 0;
+    if (auto error = VisitList(args_list[1], [&](const Cell&) { ++length; }); error != nullptr) {
+        return error;
+    }
+    return New<Number>(length);
+}
+
+std::shared_ptr<Object> Append::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (args_list.size() == 2) {
+        return nullptr;
+    }
+    std::vector<std::shared_ptr<Object>> elements;
+    for (size_t i = 1; i + 2 < args_list.size(); ++i) {
+        auto error = VisitList(args_list[i],
+                               [&](const Cell& cell) { elements.emplace_back(cell.GetFirst()); });
+        RETURN_IF_RAISED(error);
+    }
+    // The last argument becomes the tail of the result without being copied.
+    auto tail = args_list[args_list.size() - 2];
+    if (elements.empty()) {
+        return tail;
+    }
+    return CellChunk::MakeList(elements, std::move(tail));
+}
+
+std::shared_ptr<Object> Reverse::Invoke(std::shared_ptr<Cell> args,
+                                        std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::vector<std::shared_ptr<Object>> elements;
+    auto error = VisitList(args_list[1],
+                           [&](const Cell& cell) { elements.emplace_back(cell.GetFirst()); });
+    RETURN_IF_RAISED(error);
+    std::reverse(elements.begin(), elements.end());
+    return CellChunk::MakeList(elements, nullptr);
+}
+
+std::shared_ptr<Object> Map::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::shared_ptr<Function> function;
+    std::vector<std::shared_ptr<Object>> lists;
+    if (auto error = ParseProcedureAndLists(args_list, 2, &function, &lists); error != nullptr) {
+        return error;
+    }
+    std::vector<std::shared_ptr<Object>> values(lists.size());
+    std::vector<std::shared_ptr<Object>> results;
+    std::shared_ptr<Object> error;
+    while (NextElements(&lists, &values, 0, &error)) {
+        auto result = function->Apply(values, scope);
+        RETURN_IF_RAISED(result);
+        results.emplace_back(std::move(result));
+    }
+    RETURN_IF_RAISED(error);
+    return CellChunk::MakeList(results, nullptr);
+}
+
+std::shared_ptr<Object> Filter::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::shared_ptr<Function> predicate;
+    std::vector<std::shared_ptr<Object>> lists;
+    if (auto error = ParseProcedureAndLists(args_list, 2, &predicate, &lists); error != nullptr) {
+        return error;
+    }
+    std::vector<std::shared_ptr<Object>> values(1);
+    std::vector<std::shared_ptr<Object>> results;
+    std::shared_ptr<Object> error;
+    while (NextElements(&lists, &values, 0, &error)) {
+        auto result = predicate->Apply(values, scope);
+        RETURN_IF_RAISED(result);
+        if (IsTrue(result)) {
+            results.emplace_back(values[0]);
+        }
+    }
+    RETURN_IF_RAISED(error);
+    return CellChunk::MakeList(results, nullptr);
+}
+
+std::shared_ptr<Object> FoldLeft::Invoke(std::shared_ptr<Cell> args,
+                                         std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::shared_ptr<Function> function;
+    std::vector<std::shared_ptr<Object>> lists;
+    if (auto error = ParseProcedureAndLists(args_list, 3, &function, &lists); error != nullptr) {
+        return error;
+    }
+    std::vector<std::shared_ptr<Object>> values(lists.size() + 1);
+    values[0] = args_list[2];
+    std::shared_ptr<Object> error;
+    while (NextElements(&lists, &values, 1, &error)) {
+        values[0] = function->Apply(values, scope);
+        RETURN_IF_RAISED(values[0]);
+    }
+    RETURN_IF_RAISED(error);
+    return values[0];
+}
+
+std::shared_ptr<Object> FoldRight::Invoke(std::shared_ptr<Cell> args,
+                                          std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::shared_ptr<Function> function;
+    std::vector<std::shared_ptr<Object>> lists;
+    if (auto error = ParseProcedureAndLists(args_list, 3, &function, &lists); error != nullptr) {
+        return error;
+    }
+    size_t count = lists.size();
+    std::vector<std::shared_ptr<Object>> values(count + 1);
+    // The elements of every step, the calls are made from the last step back.
+    std::vector<std::shared_ptr<Object>> steps;
+    std::shared_ptr<Object> error;
+    while (NextElements(&lists, &values, 0, &error)) {
+        steps.insert(steps.end(), values.begin(), values.begin() + count);
+    }
+    RETURN_IF_RAISED(error);
+    values[count] = args_list[2];
+    for (size_t end = steps.size(); end > 0; end -= count) {
+        std::move(steps.begin() + (end - count), steps.begin() + end, values.begin());
+        values[count] = function->Apply(values, scope);
+        RETURN_IF_RAISED(values[count]);
+    }
+    return values[count];
+}
+
+std::shared_ptr<Object> ForEach::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::shared_ptr<Function> function;
+    std::vector<std::shared_ptr<Object>> lists;
+    if (auto error = ParseProcedureAndLists(args_list, 2, &function, &lists); error != nullptr) {
+        return error;
+    }
+    std::vector<std::shared_ptr<Object>> values(lists.size());
+    std::shared_ptr<Object> error;
+    while (NextElements(&lists, &values, 0, &error)) {
+        auto result = function->Apply(values, scope);
+        RETURN_IF_RAISED(result);
+    }
+    RETURN_IF_RAISED(error);
+    return nullptr;
+}
+
+std::shared_ptr<Object> Member::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return FindInList(args_list, scope, false);
+}
+
+std::shared_ptr<Object> Assoc::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return FindInList(args_list, scope, true);
+}
+
+std::shared_ptr<Object> Sort::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto less = As<Function>(args_list[2]);
+    if (less == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a list and a procedure");
+    }
+    std::vector<std::shared_ptr<Object>> elements;
+    auto error = VisitList(args_list[1],
+                           [&](const Cell& cell) { elements.emplace_back(cell.GetFirst()); });
+    RETURN_IF_RAISED(error);
+    error = MergeSort(&elements, less, scope);
+    RETURN_IF_RAISED(error);
+    return CellChunk::MakeList(elements, nullptr);
+}
+
+std::shared_ptr<Object> Delay::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return New<Promise>(args_list[1], scope);
+}
+
+std::shared_ptr<Object> MakePromise::Invoke(std::shared_ptr<Cell> args,
+                                            std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (Is<Promise>(args_list[1])) {
+        return args_list[1];
+    }
+    return New<Promise>(args_list[1]);
+}
+
+std::shared_ptr<Object> Force::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (auto promise = As<Promise>(args_list[1])) {
+        return promise->Force();
+    }
+    return args_list[1];
+}
+
+std::shared_ptr<Object> IsPromise::Invoke(std::shared_ptr<Cell> args,
+                                          std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return New<Boolean>(Is<Promise>(args_list[1]));
+}
+
+std::shared_ptr<Object> ConsStream::Invoke(std::shared_ptr<Cell> args,
+                                           std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto first = Interpreter::Calculate(args_list[1], scope);
+    RETURN_IF_RAISED(first);
+    return New<Cell>(std::move(first), New<Promise>(args_list[2], scope));
+}
+
+std::shared_ptr<Object> StreamCar::Invoke(std::shared_ptr<Cell> args,
+                                          std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (!Is<Cell>(args_list[1])) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a not empty stream");
+    }
+    return As<Cell>(args_list[1])->GetFirst();
+}
+
+std::shared_ptr<Object> StreamCdr::Invoke(std::shared_ptr<Cell> args,
+                                          std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (!Is<Cell>(args_list[1])) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a not empty stream");
+    }
+    return ForceRest(*As<Cell>(args_list[1]));
+}
+
+std::shared_ptr<Object> IsStreamPair::Invoke(std::shared_ptr<Cell> args,
+                                             std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return New<Boolean>(Is<Cell>(args_list[1]) &&
+                        Is<Promise>(As<Cell>(args_list[1])->GetSecond()));
+}
+
+std::shared_ptr<Object> IsStreamNull::Invoke(std::shared_ptr<Cell> args,
+                                             std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return New<Boolean>(args_list[1] == nullptr);
+}
+
+std::shared_ptr<Object> StreamMap::Invoke(std::shared_ptr<Cell> args,
+                                          std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    std::shared_ptr<Function> function;
+    std::vector<std::shared_ptr<Object>> streams;
+    if (auto error = ParseProcedureAndSequences(args_list, 2, &function, &streams);
+        error != nullptr) {
+        return error;
+    }
+    return MapStreams(std::move(function), std::move(streams), scope);
+}
+
+std::shared_ptr<Object> StreamFilter::Invoke(std::shared_ptr<Cell> args,
+                                             std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto predicate = As<Function>(args_list[1]);
+    if (predicate == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a procedure and a stream");
+    }
+    return FilterStream(std::move(predicate), std::move(args_list[2]), scope);
+}
+
+std::shared_ptr<Object> StreamTake::Invoke(std::shared_ptr<Cell> args,
+                                           std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (!Is<Number>(args_list[1])) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires a number and a stream");
+    }
+    return TakeStream(As<Number>(args_list[1])->GetValue(), args_list[2]);
+}
+
+std::shared_ptr<Object> StreamFold::Invoke(std::shared_ptr<Cell> args,
+                                           std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    auto function = args_list.size() == 5 ? As<Function>(args_list[1]) : nullptr;
+    if (function == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME,
+                          "Function requires a procedure, an initial value and a stream");
+    }
+    std::vector<std::shared_ptr<Object>> values = {args_list[2], nullptr};
+    // The head isn't kept, so the stream is freed as it is consumed.
+    auto stream = std::move(args_list[3]);
+    while (stream != nullptr) {
+        auto pair = As<Cell>(stream);
+        if (pair == nullptr) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires a stream");
+        }
+        values[1] = pair->GetFirst();
+        values[0] = function->Apply(values, scope);
+        RETURN_IF_RAISED(values[0]);
+        stream = ForceRest(*pair);
+        RETURN_IF_RAISED(stream);
+    }
+    return values[0];
+}
+
+std::shared_ptr<Object> StreamToList::Invoke(std::shared_ptr<Cell> args,
+                                             std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    // (stream->list [count] stream)
+    if ((args_list.size() != 3 && args_list.size() != 4) ||
+        (args_list.size() == 4 && !Is<Number>(args_list[1]))) {
+        return RaiseError(ErrorKind::RUNTIME, "Function requires an optional number and a stream");
+    }
+    auto count = args_list.size() == 4 ? As<Number>(args_list[1])->GetValue() : INT64_MAX;
+    auto stream = std::move(args_list[args_list.size() - 2]);
+    std::vector<std::shared_ptr<Object>> elements;
+    for (int64_t i = 0; i < count && stream != nullptr; ++i) {
+        auto pair = As<Cell>(stream);
+        if (pair == nullptr) {
+            return RaiseError(ErrorKind::RUNTIME, "Function requires a stream");
+        }
+        elements.emplace_back(pair->GetFirst());
+        if (i + 1 < count) {
+            stream = ForceRest(*pair);
+            RETURN_IF_RAISED(stream);
+        }
+    }
+    return CellChunk::MakeList(elements, nullptr);
+}
+
+std::shared_ptr<Object> ReadStream::Invoke(std::shared_ptr<Cell> args,
+                                           std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    const std::string* name = GetFileName(args_list[1]);
+    if (name == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "read-stream requires a file name");
+    }
+    auto reader = std::make_shared<FileReader>(*name);
+    if (!reader->file.is_open()) {
+        return RaiseError(ErrorKind::RUNTIME, "Can't open " + *name);
+    }
+    return ReadFileStream(reader);
+}
+
+std::shared_ptr<Object> DefineRecordType::Invoke(std::shared_ptr<Cell> args,
+                                                 std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    if (args_list.size() < 5 || !Is<Symbol>(args_list[1]) || !Is<Symbol>(args_list[3])) {
+        return RaiseError(ErrorKind::SYNTAX,
+                          "define-record-type requires a type name, a constructor and a predicate");
+    }
+    std::vector<std::string> fields;
+    std::vector<std::vector<std::shared_ptr<Object>>> specs;
+    for (size_t i = 4; i + 1 < args_list.size(); ++i) {
+        auto spec = Is<Cell>(args_list[i]) ? CellToVector(As<Cell>(args_list[i]))
+                                           : std::vector<std::shared_ptr<Object>>{};
+        if ((spec.size() != 3 && spec.size() != 4) || !IsNameList(spec)) {
+            return RaiseError(ErrorKind::SYNTAX,
+                              "Record field must be (field accessor [modifier])");
+        }
+        const auto& name = As<Symbol>(spec[0])->GetName();
+        if (std::find(fields.begin(), fields.end(), name) != fields.end()) {
+            return RaiseError(ErrorKind::SYNTAX, "Duplicate record field " + name);
+        }
+        fields.push_back(name);
+        specs.push_back(std::move(spec));
+    }
+    auto constructor = Is<Cell>(args_list[2]) ? CellToVector(As<Cell>(args_list[2]))
+                                              : std::vector<std::shared_ptr<Object>>{};
+    if (constructor.size() < 2 || !IsNameList(constructor)) {
+        return RaiseError(ErrorKind::SYNTAX, "Record constructor must be (name field ...)");
+    }
+    std::vector<size_t> slots;
+    for (size_t i = 1; i + 1 < constructor.size(); ++i) {
+        const auto& name = As<Symbol>(constructor[i])->GetName();
+        auto it = std::find(fields.begin(), fields.end(), name);
+        if (it == fields.end()) {
+            return RaiseError(ErrorKind::SYNTAX, "Unknown record field " + name);
+        }
+        slots.push_back(it - fields.begin());
+    }
+    auto type = New<RecordType>(As<Symbol>(args_list[1])->GetName(), std::move(fields));
+    // The other definitions go to the same scope, so only the first one can fail.
+    auto error = scope->Define(type->GetName(), type);
+    RETURN_IF_RAISED(error);
+    scope->Define(As<Symbol>(constructor[0])->GetName(),
+                  New<RecordConstructor>(type, std::move(slots)));
+    scope->Define(As<Symbol>(args_list[3])->GetName(), New<RecordPredicate>(type));
+    for (size_t i = 0; i < specs.size(); ++i) {
+        const auto& accessor = As<Symbol>(specs[i][1])->GetName();
+        scope->Define(accessor, New<RecordAccessor>(accessor, type, i));
+        if (specs[i].size() == 4) {
+            const auto& modifier = As<Symbol>(specs[i][2])->GetName();
+            scope->Define(modifier, New<RecordModifier>(modifier, type, i));
+        }
+    }
+    return nullptr;
+}
+
+RecordConstructor::RecordConstructor(std::shared_ptr<const RecordType> type,
+                                     std::vector<size_t> slots)
+    : type_(std::move(type)), slots_(std::move(slots)) {
+}
+
+std::shared_ptr<Object> RecordConstructor::Invoke(std::shared_ptr<Cell> args,
+                                                  std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return Construct(std::span(args_list).subspan(1, args_list.size() - 2));
+}
+
+std::shared_ptr<Object> RecordConstructor::Apply(
+    const std::vector<std::shared_ptr<Object>>& values, std::shared_ptr<Scope>) {
+    return Construct(values);
+}
+
+std::shared_ptr<Object> RecordConstructor::Construct(
+    std::span<const std::shared_ptr<Object>> values) const {
+    if (values.size() != slots_.size()) {
+        return RaiseError(ErrorKind::RUNTIME,
+                          "The amount of given arguments doesn't much the amount of requiring");
+    }
+    std::vector<std::shared_ptr<Object>> slots(type_->GetFields().size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        slots[slots_[i]] = values[i];
+    }
+    return New<Record>(type_, std::move(slots));
+}
+
+RecordPredicate::RecordPredicate(std::shared_ptr<const RecordType> type) : type_(std::move(type)) {
+}
+
+std::shared_ptr<Object> RecordPredicate::Invoke(std::shared_ptr<Cell> args,
+                                                std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return New<Boolean>(AsRecordOf(args_list[1], type_.get()) != nullptr);
+}
+
+std::shared_ptr<Object> RecordPredicate::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                               std::shared_ptr<Scope>) {
+    if (values.size() != 1) {
+        return RaiseError(ErrorKind::RUNTIME, "Unary function requires exactly one argument");
+    }
+    return New<Boolean>(AsRecordOf(values[0], type_.get()) != nullptr);
+}
+
+RecordAccessor::RecordAccessor(std::string name, std::shared_ptr<const RecordType> type,
+                               size_t slot)
+    : name_(std::move(name)), type_(std::move(type)), slot_(slot) {
+}
+
+std::shared_ptr<Object> RecordAccessor::Invoke(std::shared_ptr<Cell> args,
+                                               std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return Load(args_list[1]);
+}
+
+std::shared_ptr<Object> RecordAccessor::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                              std::shared_ptr<Scope>) {
+    if (values.size() != 1) {
+        return RaiseError(ErrorKind::RUNTIME, "Unary function requires exactly one argument");
+    }
+    return Load(values[0]);
+}
+
+std::shared_ptr<Object> RecordAccessor::Load(const std::shared_ptr<Object>& value) const {
+    auto record = AsRecordOf(value, type_.get());
+    if (record == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, name_ + " requires a record of " + type_->GetName());
+    }
+    return record->Get(slot_);
+}
+
+RecordModifier::RecordModifier(std::string name, std::shared_ptr<const RecordType> type,
+                               size_t slot)
+    : name_(std::move(name)), type_(std::move(type)), slot_(slot) {
+}
+
+std::shared_ptr<Object> RecordModifier::Invoke(std::shared_ptr<Cell> args,
+                                               std::shared_ptr<Scope> scope) {
+    CHECKER(args, scope, args_list);
+    return Store(args_list[1], std::move(args_list[2]));
+}
+
+std::shared_ptr<Object> RecordModifier::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                              std::shared_ptr<Scope>) {
+    if (values.size() != 2) {
+        return RaiseError(ErrorKind::RUNTIME, "Binary function requires exactly two arguments");
+    }
+    return Store(values[0], values[1]);
+}
+
+std::shared_ptr<Object> RecordModifier::Store(const std::shared_ptr<Object>& value,
+                                              std::shared_ptr<Object> field) const {
+    auto record = AsRecordOf(value, type_.get());
+    if (record == nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, name_ + " requires a record of " + type_->GetName());
+    }
+    if (record->IsFrozen()) {
+        return RaiseError(ErrorKind::RUNTIME, name_ + " can't change a frozen record");
+    }
+    record->Set(slot_, std::move(field));
+    return nullptr;
+}
@@ -9,32 +9,46 @@
 
 class DefaultListChecker {
 public:
-    void CheckList(std::vector<std::shared_ptr<Object>>& args_list);
+    std::shared_ptr<Object> CheckList(std::vector<std::shared_ptr<Object>>& args_list);
 };
 
 class UnaryFunctionChecker {
 public:
-    void CheckList(std::vector<std::shared_ptr<Object>>& args_list);
+    std::shared_ptr<Object> CheckList(std::vector<std::shared_ptr<Object>>& args_list);
 };
 
 class BinaryFunctionChecker {
 public:
-    void CheckList(std::vector<std::shared_ptr<Object>>& args_list);
+    std::shared_ptr<Object> CheckList(std::vector<std::shared_ptr<Object>>& args_list);
+};
+
+class NullaryFunctionChecker {
+public:
+    std::shared_ptr<Object> CheckList(std::vector<std::shared_ptr<Object>>& args_list);
 };
 
 class NonEmptyListChecker {
 public:
-    void CheckList(std::vector<std::shared_ptr<Object>>& args_list);
+    std::shared_ptr<Object> CheckList(std::vector<std::shared_ptr<Object>>& args_list);
 };
 
 class DefaultTypeChecker {
 public:
-    void CheckTypes(std::vector<std::shared_ptr<Object>>& args_list, std::shared_ptr<Scope> scope);
+    std::shared_ptr<Object> CheckTypes(std::vector<std::shared_ptr<Object>>& args_list,
+                                       std::shared_ptr<Scope> scope);
 };
 
 class IntegerTypeChecker {
 public:
-    void CheckTypes(std::vector<std::shared_ptr<Object>>& args_list, std::shared_ptr<Scope> scope);
+    std::shared_ptr<Object> CheckTypes(std::vector<std::shared_ptr<Object>>& args_list,
+                                       std::shared_ptr<Scope> scope);
+};
+
+// Evaluates every argument without restricting its type.
+class AnyTypeChecker {
+public:
+    std::shared_ptr<Object> CheckTypes(std::vector<std::shared_ptr<Object>>& args_list,
+                                       std::shared_ptr<Scope> scope);
 };
 
 class Quote : public Function, UnaryFunctionChecker, DefaultTypeChecker {
@@ -53,36 +67,48 @@ class Equal : public Function, DefaultListChecker, IntegerTypeChecker {
 public:
     std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                    std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
 };
 
 class Greater : public Function, DefaultListChecker, IntegerTypeChecker {
 public:
     std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                    std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
 };
 
 class Less : public Function, DefaultListChecker, IntegerTypeChecker {
 public:
     std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                    std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
 };
 
 class NotGreater : public Function, DefaultListChecker, IntegerTypeChecker {
 public:
     std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                    std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
 };
 
 class NotLess : public Function, DefaultListChecker, IntegerTypeChecker {
 public:
     std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                    std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
 };
 
 class Sum : public Function, DefaultListChecker, IntegerTypeChecker {
 public:
     std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                    std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
 };
 
 class Subtraction : public Function, NonEmptyListChecker, IntegerTypeChecker {
@@ -95,6 +121,8 @@ class Product : public Function, DefaultListChecker, IntegerTypeChecker {
 public:
     std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                    std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
 };
 
 class Division : public Function, NonEmptyListChecker, IntegerTypeChecker {
@@ -239,4 +267,381 @@ class IsSymbol : public Function, UnaryFunctionChecker, DefaultTypeChecker {
 public:
     std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                    std::shared_ptr<Scope> scope) override;
-};
\ No newline at end of file
+};
+
+class WriteBinaryFile : public Function, BinaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class ReadBinaryFile : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class HeapStatistics : public Function, NullaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+// One list (arena block-size reserved-blocks shared-free-blocks refills releases) per size
+// class in use.
+class SlabStatistics : public Function, NullaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Let : public Function, DefaultListChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class LetStar : public Function, DefaultListChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class LetRec : public Function, DefaultListChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Do : public Function, DefaultListChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Cond : public Function, DefaultListChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Begin : public Function, DefaultListChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class IsBuffer : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class BufferLength : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class BufferRef : public Function, BinaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class BufferToList : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class BufferForEach : public Function, BinaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Guard : public Function, DefaultListChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class WithExceptionHandler : public Function, BinaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class RaiseObject : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class RaiseContinuable : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class MakeError : public Function, NonEmptyListChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class IsErrorObject : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class ErrorObjectMessage : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class ErrorObjectIrritants : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Length : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Append : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Reverse : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Map : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Filter : public Function, BinaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class FoldLeft : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class FoldRight : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class ForEach : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Member : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Assoc : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Sort : public Function, BinaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Delay : public Function, UnaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class MakePromise : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class Force : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class IsPromise : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class ConsStream : public Function, BinaryFunctionChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class StreamCar : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class StreamCdr : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class IsStreamPair : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class IsStreamNull : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class StreamMap : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class StreamFilter : public Function, BinaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class StreamTake : public Function, BinaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class StreamFold : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class StreamToList : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+class ReadStream : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+// (define-record-type name (constructor field ...) predicate (field accessor [modifier]) ...)
+class DefineRecordType : public Function, DefaultListChecker, DefaultTypeChecker {
+public:
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+};
+
+// Procedures generated by define-record-type. A record is recognized by comparing its type
+// descriptor, and fields are addressed by their slot index.
+class RecordConstructor : public Function, DefaultListChecker, AnyTypeChecker {
+public:
+    // slots[i] is the slot initialized by the i-th argument, the other slots are empty.
+    RecordConstructor(std::shared_ptr<const RecordType> type, std::vector<size_t> slots);
+
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
+
+private:
+    std::shared_ptr<Object> Construct(std::span<const std::shared_ptr<Object>> values) const;
+
+    std::shared_ptr<const RecordType> type_;
+    std::vector<size_t> slots_;
+};
+
+class RecordPredicate : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    explicit RecordPredicate(std::shared_ptr<const RecordType> type);
+
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
+
+private:
+    std::shared_ptr<const RecordType> type_;
+};
+
+class RecordAccessor : public Function, UnaryFunctionChecker, AnyTypeChecker {
+public:
+    RecordAccessor(std::string name, std::shared_ptr<const RecordType> type, size_t slot);
+
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
+
+private:
+    std::shared_ptr<Object> Load(const std::shared_ptr<Object>& value) const;
+
+    std::string name_;
+    std::shared_ptr<const RecordType> type_;
+    size_t slot_;
+};
+
+class RecordModifier : public Function, BinaryFunctionChecker, AnyTypeChecker {
+public:
+    RecordModifier(std::string name, std::shared_ptr<const RecordType> type, size_t slot);
+
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
+
+private:
+    std::shared_ptr<Object> Store(const std::shared_ptr<Object>& value,
+                                  std::shared_ptr<Object> field) const;
+
+    std::string name_;
+    std::shared_ptr<const RecordType> type_;
+    size_t slot_;
+};
+
+// Whether the builtin bound to name takes its arguments as unevaluated syntax.
+bool IsSpecialForm(const std::string& name);
+
+// Builds the code of the lambda, procedure define and named let forms in form ahead of their
+// first evaluation. Malformed ones are left for the evaluation to report.
+void PrepareForm(const std::shared_ptr<Object>& form);
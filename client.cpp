@@ -0,0 +1,41 @@
+#include "client.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+Client::Client(const std::string& socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long");
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+    fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+    if (connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        int error = errno;
+        close(fd_);
+        throw std::system_error(error, std::generic_category(), "connect");
+    }
+}
+
+Client::~Client() {
+    close(fd_);
+}
+
+Response Client::Evaluate(const std::string& source) {
+    WriteFrame(fd_, source);
+    std::string payload;
+    if (!ReadFrame(fd_, &payload)) {
+        throw std::runtime_error("Server closed the connection");
+    }
+    return DecodeResponse(payload);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include "protocol.h"
+
+class Client {
+public:
+    explicit Client(const std::string& socket_path);
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+    ~Client();
+
+    Response Evaluate(const std::string& source);
+
+private:
+    int fd_ = -1;
+};
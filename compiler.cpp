@@ -0,0 +1,670 @@
+#include "compiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "builtin_functions.h"
+#include "parser.h"
+#include "tokenizer.h"
+
+namespace {
+
+using Forms = std::vector<std::shared_ptr<Object>>;
+
+// Builtins computed inline, by the C++ operator applied to the values of the arguments.
+const std::unordered_map<std::string, std::string> kArithmetic = {
+    {"+", "+"}, {"-", "-"}, {"*", "*"}};
+const std::unordered_map<std::string, std::string> kComparisons = {
+    {"=", "=="}, {"<", "<"}, {">", ">"}, {"<=", "<="}, {">=", ">="}};
+
+// A top-level form, with its parts if it is (define (name parameter ...) body ...).
+struct Definition {
+    std::shared_ptr<Object> form;
+    std::string name;
+    std::vector<std::string> parameters;
+    Forms body;
+    // The C++ function, empty if the form is evaluated by the interpreter, and its adapter to
+    // CompiledFunction::Code.
+    std::string function;
+    std::string entry;
+};
+
+// The elements of a proper list, false if obj isn't one.
+bool ToElements(const std::shared_ptr<Object>& obj, Forms* elements) {
+    if (!Is<Cell>(obj)) {
+        return false;
+    }
+    *elements = CellToVector(As<Cell>(obj));
+    if (elements->back() != nullptr) {
+        return false;
+    }
+    elements->pop_back();
+    return true;
+}
+
+// The name defined by a define form, empty for other forms.
+std::string GetDefinedName(const std::shared_ptr<Object>& form) {
+    Forms elements;
+    if (!ToElements(form, &elements) || elements.size() < 2 || !Is<Symbol>(elements[0]) ||
+        As<Symbol>(elements[0])->GetName() != "define") {
+        return "";
+    }
+    auto target = elements[1];
+    if (Is<Cell>(target)) {
+        target = As<Cell>(target)->GetFirst();
+    }
+    return Is<Symbol>(target) ? As<Symbol>(target)->GetName() : "";
+}
+
+bool ParseDefinition(Definition* definition) {
+    Forms elements;
+    Forms signature;
+    if (!ToElements(definition->form, &elements) || elements.size() < 3 ||
+        !Is<Symbol>(elements[0]) || As<Symbol>(elements[0])->GetName() != "define" ||
+        !ToElements(elements[1], &signature)) {
+        return false;
+    }
+    std::unordered_set<std::string> parameters;
+    for (const auto& name : signature) {
+        if (!Is<Symbol>(name) || !parameters.insert(As<Symbol>(name)->GetName()).second) {
+            return false;
+        }
+    }
+    definition->name = As<Symbol>(signature[0])->GetName();
+    for (size_t i = 1; i < signature.size(); ++i) {
+        definition->parameters.emplace_back(As<Symbol>(signature[i])->GetName());
+    }
+    definition->body.assign(elements.begin() + 2, elements.end());
+    return true;
+}
+
+std::string ToCppString(const std::string& text) {
+    std::string literal = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            literal += '\\';
+        }
+        literal += c;
+    }
+    return literal + "\"";
+}
+
+std::string ToIdentifier(const std::string& name) {
+    std::string identifier;
+    for (char c : name) {
+        identifier += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    }
+    return identifier;
+}
+
+class ModuleCompiler {
+public:
+    explicit ModuleCompiler(const Forms& forms);
+
+    std::string Compile();
+
+private:
+    bool IsCompilable(const std::shared_ptr<Object>& expr, const Definition& definition) const;
+    // The native function called by name from the function being compiled, if any.
+    const Definition* FindCallee(const std::string& name, size_t arity) const;
+    bool IsInlined(const std::string& name) const;
+    // Whether a call of name with arity arguments is computed inline.
+    bool IsInlinedCall(const std::string& name, size_t arity) const;
+
+    void CompileFunction(const Definition& definition);
+    // Emits the code computing expr and returns a C++ expression holding its value.
+    std::string Evaluate(const std::shared_ptr<Object>& expr);
+    std::string EvaluateCall(const Forms& form);
+    // Emits the code computing the function and the arguments of a call through Function::Apply.
+    // Returns the Function* and stores the variable holding the function and the list of the
+    // values in function and values.
+    std::string EvaluateApplied(const Forms& form, std::string* function, std::string* values);
+    // Emits the code computing the arguments of a call and returns the list of their values.
+    std::string EvaluateArguments(const Forms& form);
+    // Like Evaluate, returns a C++ expression of whether the value is true.
+    std::string EvaluateCondition(const std::shared_ptr<Object>& expr);
+    // Like Evaluate, and checks that the value is a number. Returns a C++ expression of its value.
+    std::string EvaluateInteger(const std::shared_ptr<Object>& expr);
+    // Emits the code returning the value of expr from the function being compiled.
+    void Return(const std::shared_ptr<Object>& expr);
+    void ReturnIfRaised(const std::string& variable);
+
+    std::string AddConstant(const std::shared_ptr<Object>& datum);
+    std::string AddName(const std::string& name);
+    std::string NewVariable();
+    void Line(const std::string& text);
+
+    std::vector<Definition> definitions_;
+    std::unordered_map<std::string, size_t> definition_counts_;
+    std::unordered_map<std::string, const Definition*> natives_;
+    std::vector<std::string> constants_;
+    std::unordered_map<std::string, size_t> constant_indices_;
+    std::unordered_map<std::string, size_t> names_;
+    std::ostringstream code_;
+
+    // State of the function being compiled.
+    const Definition* function_ = nullptr;
+    std::unordered_map<std::string, size_t> parameters_;
+    size_t variable_count_ = 0;
+    size_t indent_ = 0;
+};
+
+ModuleCompiler::ModuleCompiler(const Forms& forms) {
+    for (const auto& form : forms) {
+        ++definition_counts_[GetDefinedName(form)];
+    }
+    definitions_.reserve(forms.size());
+    for (const auto& form : forms) {
+        auto& definition = definitions_.emplace_back();
+        definition.form = form;
+        if (!ParseDefinition(&definition)) {
+            continue;
+        }
+        bool compilable = true;
+        for (const auto& expr : definition.body) {
+            compilable = compilable && IsCompilable(expr, definition);
+        }
+        if (compilable) {
+            auto suffix = std::to_string(definitions_.size() - 1) + "_" +
+                          ToIdentifier(definition.name);
+            definition.function = "Native" + suffix;
+            definition.entry = "Call" + suffix;
+            // Functions of the module defined more than once are always looked up.
+            if (definition_counts_[definition.name] == 1) {
+                natives_[definition.name] = &definition;
+            }
+        }
+    }
+}
+
+bool ModuleCompiler::IsCompilable(const std::shared_ptr<Object>& expr,
+                                  const Definition& definition) const {
+    if (Is<Number>(expr) || Is<Boolean>(expr) || Is<Symbol>(expr)) {
+        return true;
+    }
+    Forms form;
+    if (!ToElements(expr, &form)) {
+        return false;
+    }
+    const auto& head = form[0];
+    if (Is<Symbol>(head)) {
+        const std::string& name = As<Symbol>(head)->GetName();
+        bool is_parameter = std::find(definition.parameters.begin(), definition.parameters.end(),
+                                      name) != definition.parameters.end();
+        if (!is_parameter && name == "quote") {
+            return form.size() == 2;
+        }
+        if (!is_parameter && name == "if" && form.size() != 3 && form.size() != 4) {
+            return false;
+        }
+        // Bodies using any other special form stay interpreted.
+        if (!is_parameter && name != "if" && IsSpecialForm(name)) {
+            return false;
+        }
+    } else if (!Is<Cell>(head)) {
+        return false;
+    }
+    for (const auto& element : form) {
+        if (!IsCompilable(element, definition)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const Definition* ModuleCompiler::FindCallee(const std::string& name, size_t arity) const {
+    if (parameters_.contains(name)) {
+        return nullptr;
+    }
+    auto it = natives_.find(name);
+    if (it == natives_.end() || it->second->parameters.size() != arity) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+bool ModuleCompiler::IsInlined(const std::string& name) const {
+    return !parameters_.contains(name) && !definition_counts_.contains(name) &&
+           (kArithmetic.contains(name) || kComparisons.contains(name) || name == "not");
+}
+
+bool ModuleCompiler::IsInlinedCall(const std::string& name, size_t arity) const {
+    if (!IsInlined(name)) {
+        return false;
+    }
+    if (kArithmetic.contains(name)) {
+        return name != "-" || arity > 0;
+    }
+    return arity == (kComparisons.contains(name) ? 2 : 1);
+}
+
+std::string ModuleCompiler::Compile() {
+    for (const auto& definition : definitions_) {
+        if (!definition.function.empty()) {
+            CompileFunction(definition);
+        }
+    }
+
+    std::ostringstream out;
+    size_t native_count = 0;
+    for (const auto& definition : definitions_) {
+        native_count += !definition.function.empty();
+    }
+    out << "// Generated by CompileModule: " << native_count << " of " << definitions_.size()
+        << " top-level forms compiled to native code.\n"
+        << "#include \"compiler.h\"\n\n"
+        << "namespace {\n\n"
+        << "using Value = std::shared_ptr<Object>;\n\n";
+    for (size_t i = 0; i < constants_.size(); ++i) {
+        out << "const Value& Constant" << i << "() {\n"
+            << "    static const Value value = ReadModuleDatum(" << ToCppString(constants_[i])
+            << ");\n"
+            << "    return value;\n"
+            << "}\n\n";
+    }
+    std::vector<std::string> names(names_.size());
+    for (const auto& [name, index] : names_) {
+        names[index] = name;
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+        out << "const std::string kName" << i << " = " << ToCppString(names[i]) << ";\n";
+    }
+    if (!names.empty()) {
+        out << "\n";
+    }
+    for (const auto& definition : definitions_) {
+        if (definition.function.empty()) {
+            continue;
+        }
+        out << "Value " << definition.function
+            << "(const std::shared_ptr<Scope>& scope, NativeTailCall* tail";
+        for (size_t i = 0; i < definition.parameters.size(); ++i) {
+            out << ", Value arg" << i;
+        }
+        out << ");\n"
+            << "Value " << definition.entry << "(const std::shared_ptr<Scope>& scope, "
+            << "const std::vector<Value>& values, NativeTailCall* tail);\n";
+    }
+    out << "\n" << code_.str();
+    for (const auto& definition : definitions_) {
+        if (definition.function.empty()) {
+            continue;
+        }
+        out << "Value " << definition.entry << "(const std::shared_ptr<Scope>& scope, "
+            << "[[maybe_unused]] const std::vector<Value>& values, NativeTailCall* tail) {\n"
+            << "    return " << definition.function << "(scope, tail";
+        for (size_t i = 0; i < definition.parameters.size(); ++i) {
+            out << ", values[" << i << "]";
+        }
+        out << ");\n}\n\n";
+    }
+    out << "}  // namespace\n\n"
+        << "extern \"C\" void " << kModuleInitName << "(const std::shared_ptr<Scope>& scope) {\n";
+    for (const auto& definition : definitions_) {
+        if (definition.function.empty()) {
+            out << "    EvaluateModuleForm("
+                << ToCppString(Interpreter::ToString(definition.form)) << ", scope);\n";
+        } else {
+            out << "    ThrowIfRaised(scope->Define(" << ToCppString(definition.name)
+                << ", New<CompiledFunction>(" << definition.parameters.size() << ", "
+                << definition.entry << ", scope)));\n";
+        }
+    }
+    out << "}\n";
+    return out.str();
+}
+
+void ModuleCompiler::CompileFunction(const Definition& definition) {
+    function_ = &definition;
+    parameters_.clear();
+    for (size_t i = 0; i < definition.parameters.size(); ++i) {
+        parameters_[definition.parameters[i]] = i;
+    }
+    variable_count_ = 0;
+
+    code_ << "// " << definition.name << "\n"
+          << "Value " << definition.function
+          << "([[maybe_unused]] const std::shared_ptr<Scope>& scope, "
+          << "[[maybe_unused]] NativeTailCall* tail";
+    for (size_t i = 0; i < definition.parameters.size(); ++i) {
+        code_ << ", Value arg" << i;
+    }
+    code_ << ") {\n";
+    indent_ = 1;
+    Line("ExecutionContext& context = GetExecutionContext();");
+    Line("if (!context.HasStackFor(static_cast<const char*>(__builtin_frame_address(0)))) {");
+    Line("    return RaiseError(ErrorKind::RUNTIME, \"Evaluation stack overflow\");");
+    Line("}");
+    Line("DepthGuard depth_guard(context);");
+    // Self tail calls assign the parameters and start over.
+    Line("while (true) {");
+    ++indent_;
+    Line("context.ConsumeStep();");
+    for (size_t i = 0; i + 1 < definition.body.size(); ++i) {
+        Evaluate(definition.body[i]);
+    }
+    Return(definition.body.back());
+    --indent_;
+    Line("}");
+    code_ << "}\n\n";
+    function_ = nullptr;
+}
+
+std::string ModuleCompiler::Evaluate(const std::shared_ptr<Object>& expr) {
+    if (Is<Number>(expr) || Is<Boolean>(expr)) {
+        return AddConstant(expr);
+    }
+    if (Is<Symbol>(expr)) {
+        const std::string& name = As<Symbol>(expr)->GetName();
+        if (auto it = parameters_.find(name); it != parameters_.end()) {
+            return "arg" + std::to_string(it->second);
+        }
+        auto variable = NewVariable();
+        Line("Value " + variable + ";");
+        Line("if (!scope->Lookup(" + AddName(name) + ", &" + variable + ")) {");
+        Line("    return RaiseError(ErrorKind::NAME, " +
+             ToCppString("Unknown variable : " + name) + ");");
+        Line("}");
+        return variable;
+    }
+    Forms form;
+    ToElements(expr, &form);
+    if (Is<Symbol>(form[0]) && !parameters_.contains(As<Symbol>(form[0])->GetName())) {
+        const std::string& name = As<Symbol>(form[0])->GetName();
+        if (name == "quote") {
+            return AddConstant(form[1]);
+        }
+        if (name == "if") {
+            auto variable = NewVariable();
+            Line("Value " + variable + ";");
+            auto condition = EvaluateCondition(form[1]);
+            Line("if (" + condition + ") {");
+            ++indent_;
+            Line(variable + " = " + Evaluate(form[2]) + ";");
+            --indent_;
+            if (form.size() == 4) {
+                Line("} else {");
+                ++indent_;
+                Line(variable + " = " + Evaluate(form[3]) + ";");
+                --indent_;
+            }
+            Line("}");
+            return variable;
+        }
+    }
+    return EvaluateCall(form);
+}
+
+std::string ModuleCompiler::EvaluateCall(const Forms& form) {
+    size_t arity = form.size() - 1;
+    std::string name = Is<Symbol>(form[0]) ? As<Symbol>(form[0])->GetName() : "";
+    std::string value;
+    // Only calls can raise an error after their arguments are computed.
+    bool may_raise = false;
+    if (IsInlinedCall(name, arity) && kArithmetic.contains(name)) {
+        value = name == "*" ? "int64_t{1}" : "int64_t{0}";
+        for (size_t i = 1; i < form.size(); ++i) {
+            auto number = EvaluateInteger(form[i]);
+            value = i == 1 ? number : value + " " + kArithmetic.at(name) + " " + number;
+        }
+        value = "New<Number>(" + value + ")";
+    } else if (IsInlinedCall(name, arity) && kComparisons.contains(name)) {
+        auto left = EvaluateInteger(form[1]);
+        auto right = EvaluateInteger(form[2]);
+        value = "New<Boolean>(" + left + " " + kComparisons.at(name) + " " + right + ")";
+    } else if (IsInlinedCall(name, arity)) {
+        value = "New<Boolean>(!IsTrue(" + Evaluate(form[1]) + "))";
+    } else if (const Definition* callee = FindCallee(name, arity)) {
+        // The callee may leave a tail call, which is made before its value is used.
+        value = callee->function + "(scope, tail";
+        for (size_t i = 1; i < form.size(); ++i) {
+            value += ", " + Evaluate(form[i]);
+        }
+        value = "FinishTailCalls(scope, tail, " + value + "))";
+        may_raise = true;
+    } else {
+        std::string function;
+        std::string values;
+        auto pointer = EvaluateApplied(form, &function, &values);
+        value = pointer + "->Apply({" + values + "}, scope)";
+        may_raise = true;
+    }
+    auto variable = NewVariable();
+    Line("Value " + variable + " = " + value + ";");
+    if (may_raise) {
+        ReturnIfRaised(variable);
+    }
+    return variable;
+}
+
+std::string ModuleCompiler::EvaluateApplied(const Forms& form, std::string* function,
+                                            std::string* values) {
+    *function = Evaluate(form[0]);
+    auto pointer = NewVariable();
+    Line("auto* " + pointer + " = dynamic_cast<Function*>(" + *function + ".get());");
+    Line("if (" + pointer + " == nullptr) {");
+    Line("    return RaiseError(ErrorKind::RUNTIME, \"List doesn't return any value\");");
+    Line("}");
+    *values = EvaluateArguments(form);
+    return pointer;
+}
+
+std::string ModuleCompiler::EvaluateArguments(const Forms& form) {
+    std::string values;
+    for (size_t i = 1; i < form.size(); ++i) {
+        values += (i == 1 ? "" : ", ") + Evaluate(form[i]);
+    }
+    return values;
+}
+
+std::string ModuleCompiler::EvaluateCondition(const std::shared_ptr<Object>& expr) {
+    Forms form;
+    if (ToElements(expr, &form) && Is<Symbol>(form[0])) {
+        const std::string& name = As<Symbol>(form[0])->GetName();
+        if (IsInlined(name) && kComparisons.contains(name) && form.size() == 3) {
+            auto left = EvaluateInteger(form[1]);
+            auto right = EvaluateInteger(form[2]);
+            return left + " " + kComparisons.at(name) + " " + right;
+        }
+        if (IsInlined(name) && name == "not" && form.size() == 2) {
+            return "!(" + EvaluateCondition(form[1]) + ")";
+        }
+    }
+    return "IsTrue(" + Evaluate(expr) + ")";
+}
+
+std::string ModuleCompiler::EvaluateInteger(const std::shared_ptr<Object>& expr) {
+    if (Is<Number>(expr) && As<Number>(expr)->GetValue() > INT64_MIN) {
+        return "int64_t{" + std::to_string(As<Number>(expr)->GetValue()) + "}";
+    }
+    auto value = Evaluate(expr);
+    auto number = NewVariable();
+    Line("auto* " + number + " = dynamic_cast<Number*>(" + value + ".get());");
+    Line("if (" + number + " == nullptr) {");
+    Line("    return RaiseError(ErrorKind::RUNTIME, "
+         "\"Function requires integer only arguments\");");
+    Line("}");
+    return number + "->GetValue()";
+}
+
+void ModuleCompiler::Return(const std::shared_ptr<Object>& expr) {
+    Forms form;
+    if (!ToElements(expr, &form)) {
+        Line("return " + Evaluate(expr) + ";");
+        return;
+    }
+    std::string name = Is<Symbol>(form[0]) ? As<Symbol>(form[0])->GetName() : "";
+    size_t arity = form.size() - 1;
+    if (name == "if" && !parameters_.contains(name)) {
+        auto condition = EvaluateCondition(form[1]);
+        Line("if (" + condition + ") {");
+        ++indent_;
+        Return(form[2]);
+        --indent_;
+        Line("} else {");
+        ++indent_;
+        if (form.size() == 4) {
+            Return(form[3]);
+        } else {
+            Line("return nullptr;");
+        }
+        --indent_;
+        Line("}");
+        return;
+    }
+    const Definition* callee = FindCallee(name, arity);
+    if (callee == function_) {
+        // The arguments may use the parameters, so all of them are computed first.
+        std::vector<std::string> arguments;
+        for (size_t i = 1; i < form.size(); ++i) {
+            auto value = Evaluate(form[i]);
+            auto variable = NewVariable();
+            Line("Value " + variable + " = " + value + ";");
+            arguments.emplace_back(variable);
+        }
+        for (size_t i = 0; i < arguments.size(); ++i) {
+            Line("arg" + std::to_string(i) + " = std::move(" + arguments[i] + ");");
+        }
+        Line("continue;");
+        return;
+    }
+    // Other calls are left to the caller, so mutual recursion doesn't grow the stack either.
+    if (callee != nullptr) {
+        Line("tail->values = {" + EvaluateArguments(form) + "};");
+        Line("tail->code = " + callee->entry + ";");
+        Line("return nullptr;");
+    } else if ((name == "quote" && !parameters_.contains(name)) || IsInlinedCall(name, arity)) {
+        Line("return " + Evaluate(expr) + ";");
+    } else {
+        std::string function;
+        std::string values;
+        auto pointer = EvaluateApplied(form, &function, &values);
+        Line("tail->values = {" + values + "};");
+        Line("tail->function = std::shared_ptr<Function>(" + function + ", " + pointer + ");");
+        Line("return nullptr;");
+    }
+}
+
+void ModuleCompiler::ReturnIfRaised(const std::string& variable) {
+    Line("if (Interpreter::IsRaised(" + variable + ")) {");
+    Line("    return " + variable + ";");
+    Line("}");
+}
+
+std::string ModuleCompiler::AddConstant(const std::shared_ptr<Object>& datum) {
+    if (Is<Boolean>(datum)) {
+        return As<Boolean>(datum)->GetValue() ? "Value(GetSharedBoolean(true))"
+                                              : "Value(GetSharedBoolean(false))";
+    }
+    if (Is<Number>(datum)) {
+        int64_t value = As<Number>(datum)->GetValue();
+        if (value >= kMinSharedNumber && value <= kMaxSharedNumber) {
+            return "Value(GetSharedNumber(" + std::to_string(value) + "))";
+        }
+    }
+    auto [it, inserted] =
+        constant_indices_.emplace(Interpreter::ToString(datum), constant_indices_.size());
+    if (inserted) {
+        constants_.emplace_back(it->first);
+    }
+    return "Constant" + std::to_string(it->second) + "()";
+}
+
+std::string ModuleCompiler::AddName(const std::string& name) {
+    return "kName" + std::to_string(names_.emplace(name, names_.size()).first->second);
+}
+
+std::string ModuleCompiler::NewVariable() {
+    return "t" + std::to_string(variable_count_++);
+}
+
+void ModuleCompiler::Line(const std::string& text) {
+    code_ << std::string(indent_ * 4, ' ') << text << "\n";
+}
+
+}  // namespace
+
+std::string CompileModule(const std::vector<std::shared_ptr<Object>>& forms) {
+    return ModuleCompiler(forms).Compile();
+}
+
+CompiledFunction::CompiledFunction(size_t arity, Code code, std::shared_ptr<Scope> scope)
+    : arity_(arity), code_(code), scope_(std::move(scope)) {
+}
+
+std::shared_ptr<Object> CompiledFunction::Invoke(std::shared_ptr<Cell> args,
+                                                 std::shared_ptr<Scope> scope) {
+    auto args_list = CellToVector(args);
+    if (args_list.back() != nullptr) {
+        return RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
+    }
+    if (args_list.size() - 2 != arity_) {
+        return RaiseError(ErrorKind::RUNTIME,
+                          "The amount of given arguments doesn't much the amount of requiring");
+    }
+    std::vector<std::shared_ptr<Object>> values;
+    values.reserve(arity_);
+    for (size_t i = 1; i + 1 < args_list.size(); ++i) {
+        auto value = Interpreter::Calculate(args_list[i], scope);
+        if (Interpreter::IsRaised(value)) {
+            return value;
+        }
+        values.emplace_back(std::move(value));
+    }
+    NativeTailCall tail;
+    auto value = code_(scope_, values, &tail);
+    while (tail.code != nullptr) {
+        values = std::move(tail.values);
+        value = std::exchange(tail.code, nullptr)(scope_, values, &tail);
+    }
+    if (tail.function != nullptr) {
+        // Evaluated by the caller, so calls back and forth with interpreted code stay flat too.
+        return Interpreter::TailCall(MakeApplication(std::move(tail.function), tail.values),
+                                     scope);
+    }
+    return value;
+}
+
+std::shared_ptr<Object> CompiledFunction::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                                std::shared_ptr<Scope>) {
+    if (values.size() != arity_) {
+        return RaiseError(ErrorKind::RUNTIME,
+                          "The amount of given arguments doesn't much the amount of requiring");
+    }
+    NativeTailCall tail;
+    return FinishTailCalls(scope_, &tail, code_(scope_, values, &tail));
+}
+
+std::shared_ptr<Object> FinishTailCalls(const std::shared_ptr<Scope>& scope, NativeTailCall* tail,
+                                        std::shared_ptr<Object> value) {
+    std::vector<std::shared_ptr<Object>> values;
+    while (tail->code != nullptr || tail->function != nullptr) {
+        values = std::move(tail->values);
+        tail->values.clear();
+        if (auto code = std::exchange(tail->code, nullptr)) {
+            value = code(scope, values, tail);
+        } else {
+            value = std::exchange(tail->function, nullptr)->Apply(values, scope);
+        }
+    }
+    return value;
+}
+
+std::shared_ptr<Object> ReadModuleDatum(const std::string& text) {
+    std::stringstream ss{text};
+    Tokenizer tokenizer{&ss};
+    auto datum = Read(&tokenizer);
+    if (!tokenizer.IsEnd()) {
+        throw SyntaxError("Input isn't one whole object");
+    }
+    return datum;
+}
+
+void EvaluateModuleForm(const std::string& text, const std::shared_ptr<Scope>& scope) {
+    ThrowIfRaised(Interpreter::Calculate(ReadModuleDatum(text), scope));
+}
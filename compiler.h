@@ -0,0 +1,71 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "error.h"
+#include "object.h"
+#include "scheme.h"
+
+// Translates the top-level forms of a source into a C++ translation unit, to be built as a shared
+// library against this runtime and loaded with Interpreter::LoadModule. The host has to export
+// the runtime to the library, e.g. by linking with -rdynamic.
+//
+// Every (define (name parameter ...) body ...) whose body only uses numbers, booleans, quote,
+// variables, if and calls becomes a native function. The arithmetic and comparison builtins are
+// inlined, calls of the module's other native functions and self tail calls are direct, and any
+// other call goes through Function::Apply. Other tail calls are left to the caller (see
+// NativeTailCall), so they don't grow the stack either. The remaining forms are kept as source
+// and evaluated by the interpreter when the module is loaded, in the original order. Native code
+// raises the same errors as the interpreter does, but it assumes that the inlined builtins and
+// the functions of the module aren't redefined.
+std::string CompileModule(const std::vector<std::shared_ptr<Object>>& forms);
+
+// Entry point of a compiled module, called with the scope to define its functions in.
+using ModuleInit = void (*)(const std::shared_ptr<Scope>& scope);
+inline constexpr char kModuleInitName[] = "SchemeModuleInit";
+
+// Runtime support of the generated code.
+
+struct NativeTailCall;
+
+// A native function of a compiled module. The code gets the evaluated arguments, already
+// checked against the arity, and the scope the module was loaded into.
+class CompiledFunction : public Function {
+public:
+    using Code = std::shared_ptr<Object> (*)(const std::shared_ptr<Scope>& scope,
+                                             const std::vector<std::shared_ptr<Object>>& values,
+                                             NativeTailCall* tail);
+
+    CompiledFunction(size_t arity, Code code, std::shared_ptr<Scope> scope);
+
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
+
+private:
+    size_t arity_;
+    Code code_;
+    std::shared_ptr<Scope> scope_;
+};
+
+// A call in tail position that native code leaves to its caller: it stores the callee and the
+// arguments here and returns null. The callee is either native code of the module or function.
+struct NativeTailCall {
+    CompiledFunction::Code code = nullptr;
+    std::shared_ptr<Function> function;
+    std::vector<std::shared_ptr<Object>> values;
+};
+
+// Makes the calls left in tail, each of which may leave another one, and returns the value of
+// the last. value is what the code that left the first call returned.
+std::shared_ptr<Object> FinishTailCalls(const std::shared_ptr<Scope>& scope, NativeTailCall* tail,
+                                        std::shared_ptr<Object> value);
+
+// Parses the text of a single datum. Throws SyntaxError if it isn't one.
+std::shared_ptr<Object> ReadModuleDatum(const std::string& text);
+
+// Evaluates a top-level form of the module given as text, throwing the error it raises.
+void EvaluateModuleForm(const std::string& text, const std::shared_ptr<Scope>& scope);
@@ -0,0 +1,80 @@
+#include "context.h"
+
+#include <algorithm>
+
+#include "error.h"
+
+void CancellationHandle::Cancel() {
+    cancelled_.store(true, std::memory_order_relaxed);
+}
+
+void CancellationHandle::Reset() {
+    cancelled_.store(false, std::memory_order_relaxed);
+}
+
+bool CancellationHandle::IsCancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+}
+
+uint64_t ExecutionContext::GetEvaluationId() {
+    static std::atomic<uint64_t> last_id = 0;
+    if (evaluation_id == 0) {
+        evaluation_id = last_id.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    return evaluation_id;
+}
+
+void ExecutionContext::Pause() {
+    if (yield) {
+        yield(yield_argument);
+    }
+    if (cancellation && cancellation->IsCancelled()) {
+        throw LimitError("Evaluation was cancelled");
+    }
+    ConsumeStep();
+}
+
+void ExecutionContext::Refuel() {
+    if (yield) {
+        yield(yield_argument);
+    }
+    if (cancellation && cancellation->IsCancelled()) {
+        throw LimitError("Evaluation was cancelled");
+    }
+    if (granted_steps >= limits.max_steps) {
+        throw LimitError("Evaluation step limit exceeded");
+    }
+    fuel = std::min(fuel_chunk, limits.max_steps - granted_steps);
+    granted_steps += fuel;
+}
+
+void ExecutionContext::AllocationLimitExceeded() const {
+    throw LimitError("Evaluation memory limit exceeded");
+}
+
+void ExecutionContext::DepthLimitExceeded() const {
+    throw LimitError("Evaluation recursion depth limit exceeded");
+}
+
+ExecutionContextGuard::ExecutionContextGuard(const Limits& limits,
+                                             const CancellationHandle* cancellation,
+                                             ScopeOverlay* overlay)
+    : saved_(GetExecutionContext()) {
+    ExecutionContext& context = GetExecutionContext();
+    context = ExecutionContext{};
+    context.limits = limits;
+    context.cancellation = cancellation;
+    context.overlay = overlay;
+    context.yield = saved_.yield;
+    context.yield_argument = saved_.yield_argument;
+    context.stack_limit = saved_.stack_limit;
+    context.stack_end = saved_.stack_end;
+    context.evaluation_id = saved_.evaluation_id;
+    context.fuel_chunk = saved_.fuel_chunk;
+    context.fuel = std::min(context.fuel_chunk, limits.max_steps);
+    context.granted_steps = context.fuel;
+}
+
+ExecutionContextGuard::~ExecutionContextGuard() {
+    GetExecutionContext() = saved_;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+class Object;
+struct ScopeOverlay;
+
+struct Limits {
+    uint64_t max_steps = std::numeric_limits<uint64_t>::max();
+    uint64_t max_allocated_bytes = std::numeric_limits<uint64_t>::max();
+    uint64_t max_allocated_objects = std::numeric_limits<uint64_t>::max();
+    uint64_t max_depth = std::numeric_limits<uint64_t>::max();
+    // Size of the stack evaluation runs on, which bounds the depth of non-tail recursion.
+    uint64_t max_stack_bytes = 1ull << 30;
+};
+
+// Can be triggered from any thread. A cancelled handle stays cancelled until Reset.
+class CancellationHandle {
+public:
+    void Cancel();
+    void Reset();
+    bool IsCancelled() const;
+
+private:
+    std::atomic<bool> cancelled_ = false;
+};
+
+// Handlers installed by with-exception-handler, innermost first. A null handler belongs to guard,
+// which always handles an error by escaping from its body.
+struct HandlerFrame {
+    std::shared_ptr<Object> handler;
+    const HandlerFrame* next = nullptr;
+};
+
+// Per-thread accounting of the evaluation that is currently running. Steps are handed out
+// in chunks, so the hot path only decrements a counter and the cancellation flag is polled
+// once per chunk. A cooperative scheduler installs a yield hook that runs between chunks.
+struct ExecutionContext {
+    static constexpr uint64_t kFuelChunk = 1024;
+    // Left for builtins and error handling below the deepest evaluation frame.
+    static constexpr size_t kStackReserve = 256 << 10;
+
+    Limits limits;
+    const CancellationHandle* cancellation = nullptr;
+    void (*yield)(void*) = nullptr;
+    void* yield_argument = nullptr;
+    uint64_t fuel_chunk = kFuelChunk;
+    uint64_t fuel = kFuelChunk;
+    uint64_t granted_steps = kFuelChunk;
+    uint64_t allocated_bytes = 0;
+    uint64_t allocated_objects = 0;
+    uint64_t depth = 0;
+    const HandlerFrame* handlers = nullptr;
+    // Bindings of frozen scopes assigned by the running interpreter, see Interpreter::Fork.
+    ScopeOverlay* overlay = nullptr;
+    // Lowest address evaluation frames may use, null when the stack isn't managed. Calculate
+    // checks against stack_limit, which starts above stack_end when a run can learn that it
+    // went deep, and is lowered to stack_end once reached.
+    const char* stack_limit = nullptr;
+    const char* stack_end = nullptr;
+    // Identifies the running evaluation for the promises it forces, zero until it is asked
+    // for. Nested evaluations on the same stack share it, a task carries its own.
+    uint64_t evaluation_id = 0;
+
+    void ConsumeStep() {
+        if (fuel == 0) {
+            Refuel();
+        }
+        --fuel;
+    }
+
+    void ChargeAllocation(uint64_t bytes, uint64_t objects = 1) {
+        allocated_bytes += bytes;
+        allocated_objects += objects;
+        if (allocated_objects > limits.max_allocated_objects ||
+            allocated_bytes > limits.max_allocated_bytes) {
+            AllocationLimitExceeded();
+        }
+    }
+
+    // Whether an evaluation frame at the given address is above the stack limit. Lowers the
+    // limit to stack_end when the soft limit is reached.
+    bool HasStackFor(const char* frame) {
+        if (frame < stack_limit) [[unlikely]] {
+            if (frame < stack_end) {
+                return false;
+            }
+            stack_limit = stack_end;
+        }
+        return true;
+    }
+
+    uint64_t GetSteps() const {
+        return granted_steps - fuel;
+    }
+
+    uint64_t GetEvaluationId();
+    // Called in a loop while this evaluation waits for another one: yields to the scheduler if
+    // there is one and charges a step, throwing once cancelled or out of steps.
+    void Pause();
+    void Refuel();
+    [[noreturn]] void AllocationLimitExceeded() const;
+    [[noreturn]] void DepthLimitExceeded() const;
+};
+
+inline ExecutionContext& GetExecutionContext() {
+    static constinit thread_local ExecutionContext context;
+    return context;
+}
+
+// Installs a fresh context for one evaluation and restores the previous one afterwards.
+// The yield hook and the stack limit of the enclosing context are inherited.
+class ExecutionContextGuard {
+public:
+    ExecutionContextGuard(const Limits& limits, const CancellationHandle* cancellation,
+                          ScopeOverlay* overlay = nullptr);
+    ExecutionContextGuard(const ExecutionContextGuard&) = delete;
+    ExecutionContextGuard& operator=(const ExecutionContextGuard&) = delete;
+    ~ExecutionContextGuard();
+
+private:
+    ExecutionContext saved_;
+};
+
+class DepthGuard {
+public:
+    explicit DepthGuard(ExecutionContext& context) : context_(context) {
+        if (++context_.depth > context_.limits.max_depth) {
+            --context_.depth;
+            context_.DepthLimitExceeded();
+        }
+    }
+    DepthGuard(const DepthGuard&) = delete;
+    DepthGuard& operator=(const DepthGuard&) = delete;
+    ~DepthGuard() {
+        --context_.depth;
+    }
+
+private:
+    ExecutionContext& context_;
+};
@@ -0,0 +1,107 @@
+#include "evaluation_stack.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <system_error>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "context.h"
+#include "stack_switch.h"
+
+namespace {
+
+// Only this much of the top of the stack stays committed after a deeper run.
+constexpr size_t kKeptStackBytes = 1 << 20;
+
+// A context that runs on the stack forever and calls one body per switch to it, so a run
+// costs two context switches and no makecontext.
+class EvaluationStack {
+public:
+    EvaluationStack() : page_(sysconf(_SC_PAGESIZE)) {
+    }
+    EvaluationStack(const EvaluationStack&) = delete;
+    EvaluationStack& operator=(const EvaluationStack&) = delete;
+    ~EvaluationStack() {
+        if (base_ != nullptr) {
+            munmap(base_, size_);
+        }
+    }
+
+    void Run(size_t stack_size, const std::function<void()>& body) {
+        stack_size = (std::max(stack_size, 2 * ExecutionContext::kStackReserve) + page_ - 1) /
+                     page_ * page_;
+        Reserve(stack_size + page_);
+        ExecutionContext& context = GetExecutionContext();
+        const char* top = base_ + size_;
+        context.stack_end = top - stack_size + ExecutionContext::kStackReserve;
+        context.stack_limit = std::max(context.stack_end, top - kKeptStackBytes);
+        body_ = &body;
+        SwitchStack(&caller_, callee_);
+        bool deep = context.stack_limit == context.stack_end;
+        context.stack_limit = context.stack_end = nullptr;
+        if (deep && size_ > kKeptStackBytes + page_) {
+            madvise(base_ + page_, size_ - kKeptStackBytes - page_, MADV_DONTNEED);
+        }
+        if (exception_) {
+            std::rethrow_exception(std::exchange(exception_, nullptr));
+        }
+    }
+
+private:
+    void Reserve(size_t size) {
+        if (size <= size_) {
+            return;
+        }
+        void* stack = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (stack == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+        if (mprotect(stack, page_, PROT_NONE) < 0) {
+            int error = errno;
+            munmap(stack, size);
+            throw std::system_error(error, std::generic_category(), "mprotect");
+        }
+        if (base_ != nullptr) {
+            munmap(base_, size_);
+        }
+        base_ = static_cast<char*>(stack);
+        size_ = size;
+        callee_ = PrepareStack(base_ + page_, size_ - page_, &EvaluationStack::Loop, this);
+    }
+
+    [[noreturn]] static void Loop(void* self) {
+        auto* stack = static_cast<EvaluationStack*>(self);
+        while (true) {
+            try {
+                (*stack->body_)();
+            } catch (...) {
+                stack->exception_ = std::current_exception();
+            }
+            SwitchStack(&stack->callee_, stack->caller_);
+        }
+    }
+
+    size_t page_;
+    char* base_ = nullptr;
+    size_t size_ = 0;
+    void* callee_ = nullptr;
+    void* caller_ = nullptr;
+    const std::function<void()>* body_ = nullptr;
+    std::exception_ptr exception_;
+};
+
+}  // namespace
+
+void RunOnEvaluationStack(size_t stack_size, const std::function<void()>& body) {
+    if (GetExecutionContext().stack_limit != nullptr) {
+        body();
+        return;
+    }
+    static thread_local EvaluationStack stack;
+    stack.Run(stack_size, body);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Calls body on a stack of stack_size bytes owned by the calling thread. The stack is reserved
+// once per thread and reused, its pages are committed only when touched and the deep ones are
+// released after the run. While body runs, Calculate reports an overflow once fewer than
+// kStackReserve bytes are left.
+// If the current execution context already has a stack limit (a nested run or a task running
+// on a fiber), body is simply called on the current stack.
+void RunOnEvaluationStack(size_t stack_size, const std::function<void()>& body);
@@ -0,0 +1,80 @@
+#include "fiber.h"
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "stack_switch.h"
+
+Fiber::Fiber(std::function<void()> body, size_t stack_size)
+    : body_(std::move(body)), stack_size_(stack_size) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    stack_size_ = (stack_size_ + page - 1) / page * page + page;
+    void* stack = mmap(nullptr, stack_size_, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+    stack_ = static_cast<char*>(stack);
+    if (mprotect(stack_, page, PROT_NONE) < 0) {
+        int error = errno;
+        munmap(stack_, stack_size_);
+        throw std::system_error(error, std::generic_category(), "mprotect");
+    }
+    context_ = PrepareStack(stack_ + page, stack_size_ - page, &Fiber::Start, this);
+}
+
+Fiber::~Fiber() {
+    Cancel();
+    munmap(stack_, stack_size_);
+}
+
+void Fiber::Start(void* fiber) {
+    auto* self = static_cast<Fiber*>(fiber);
+    try {
+        self->body_();
+    } catch (const Cancelled&) {
+    } catch (...) {
+        self->exception_ = std::current_exception();
+    }
+    self->finished_ = true;
+    SwitchStack(&self->context_, self->caller_);
+    __builtin_unreachable();
+}
+
+void Fiber::Resume() {
+    if (finished_) {
+        return;
+    }
+    started_ = true;
+    SwitchStack(&caller_, context_);
+    if (exception_) {
+        std::rethrow_exception(std::exchange(exception_, nullptr));
+    }
+}
+
+void Fiber::Yield() {
+    SwitchStack(&context_, caller_);
+    if (cancelling_) {
+        throw Cancelled{};
+    }
+}
+
+void Fiber::Cancel() {
+    if (started_ && !finished_) {
+        cancelling_ = true;
+        SwitchStack(&caller_, context_);
+    }
+    finished_ = true;
+}
+
+bool Fiber::IsFinished() const {
+    return finished_;
+}
+
+const char* Fiber::GetStackBottom() const {
+    return stack_ + sysconf(_SC_PAGESIZE);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+
+// A stackful coroutine running on its own mmap'ed stack. The stack is reserved lazily,
+// so only the pages actually touched by the body consume memory, and ends in a guard page.
+class Fiber {
+public:
+    static constexpr size_t kDefaultStackSize = 8 << 20;
+
+    explicit Fiber(std::function<void()> body, size_t stack_size = kDefaultStackSize);
+    Fiber(const Fiber&) = delete;
+    Fiber& operator=(const Fiber&) = delete;
+    ~Fiber();
+
+    // Runs the body until it yields or finishes. Rethrows an exception escaping the body.
+    void Resume();
+    // Must be called from inside the body.
+    void Yield();
+    // Unwinds the stack of a suspended body.
+    void Cancel();
+
+    bool IsFinished() const;
+    // Lowest usable address of the stack.
+    const char* GetStackBottom() const;
+
+private:
+    struct Cancelled {};
+
+    [[noreturn]] static void Start(void* fiber);
+
+    std::function<void()> body_;
+    char* stack_ = nullptr;
+    size_t stack_size_;
+    void* context_ = nullptr;
+    void* caller_ = nullptr;
+    std::exception_ptr exception_;
+    bool started_ = false;
+    bool finished_ = false;
+    bool cancelling_ = false;
+};
@@ -0,0 +1,151 @@
+#include "heap_stats.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "error.h"
+
+namespace {
+
+struct TypeCounters {
+    std::atomic<int64_t> allocations = 0;
+    std::atomic<int64_t> live_objects = 0;
+    std::atomic<int64_t> live_bytes = 0;
+};
+
+struct HeapCounters {
+    TypeCounters types[static_cast<size_t>(ObjectType::COUNT)];
+    std::atomic<int64_t> live_bytes = 0;
+    std::atomic<int64_t> peak_live_bytes = 0;
+};
+
+HeapCounters& GetHeapCounters() {
+    static HeapCounters counters;
+    return counters;
+}
+
+}  // namespace
+
+const char* GetObjectTypeName(ObjectType type) {
+    switch (type) {
+        case ObjectType::NUMBER:
+            return "number";
+        case ObjectType::BOOLEAN:
+            return "boolean";
+        case ObjectType::SYMBOL:
+            return "symbol";
+        case ObjectType::CELL:
+            return "cell";
+        case ObjectType::LAMBDA:
+            return "lambda";
+        case ObjectType::SCOPE:
+            return "scope";
+        default:
+            return "other";
+    }
+}
+
+const TypeStats& HeapStats::operator[](ObjectType type) const {
+    return types[static_cast<size_t>(type)];
+}
+
+HeapStats operator-(const HeapStats& after, const HeapStats& before) {
+    HeapStats delta;
+    for (size_t i = 0; i < static_cast<size_t>(ObjectType::COUNT); ++i) {
+        delta.types[i].allocations = after.types[i].allocations - before.types[i].allocations;
+        delta.types[i].live_objects = after.types[i].live_objects - before.types[i].live_objects;
+        delta.types[i].live_bytes = after.types[i].live_bytes - before.types[i].live_bytes;
+    }
+    delta.live_bytes = after.live_bytes - before.live_bytes;
+    delta.peak_live_bytes = after.peak_live_bytes;
+    return delta;
+}
+
+void SetHeapStatsEnabled(bool enabled) {
+    GetHeapStatsFlag().store(enabled, std::memory_order_relaxed);
+}
+
+HeapStats GetHeapStats() {
+    auto& counters = GetHeapCounters();
+    HeapStats stats;
+    for (size_t i = 0; i < static_cast<size_t>(ObjectType::COUNT); ++i) {
+        stats.types[i].allocations = counters.types[i].allocations.load(std::memory_order_relaxed);
+        stats.types[i].live_objects =
+            counters.types[i].live_objects.load(std::memory_order_relaxed);
+        stats.types[i].live_bytes = counters.types[i].live_bytes.load(std::memory_order_relaxed);
+    }
+    stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+    stats.peak_live_bytes = counters.peak_live_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void RecordAllocation(ObjectType type, size_t bytes, size_t count) {
+    auto& counters = GetHeapCounters();
+    auto& type_counters = counters.types[static_cast<size_t>(type)];
+    type_counters.allocations.fetch_add(count, std::memory_order_relaxed);
+    type_counters.live_objects.fetch_add(count, std::memory_order_relaxed);
+    type_counters.live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    int64_t live = counters.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    int64_t peak = counters.peak_live_bytes.load(std::memory_order_relaxed);
+    while (peak < live &&
+           !counters.peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void RecordDeallocation(ObjectType type, size_t bytes, size_t count) {
+    auto& counters = GetHeapCounters();
+    auto& type_counters = counters.types[static_cast<size_t>(type)];
+    type_counters.live_objects.fetch_sub(count, std::memory_order_relaxed);
+    type_counters.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    counters.live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void WriteHeapStatsMetrics(std::ostream& out, const HeapStats& stats) {
+    out << "# TYPE scheme_heap_allocations_total counter\n";
+    for (size_t i = 0; i < static_cast<size_t>(ObjectType::COUNT); ++i) {
+        out << "scheme_heap_allocations_total{type=\""
+            << GetObjectTypeName(static_cast<ObjectType>(i)) << "\"} "
+            << stats.types[i].allocations << "\n";
+    }
+    out << "# TYPE scheme_heap_live_objects gauge\n";
+    for (size_t i = 0; i < static_cast<size_t>(ObjectType::COUNT); ++i) {
+        out << "scheme_heap_live_objects{type=\"" << GetObjectTypeName(static_cast<ObjectType>(i))
+            << "\"} " << stats.types[i].live_objects << "\n";
+    }
+    out << "# TYPE scheme_heap_live_bytes gauge\n";
+    for (size_t i = 0; i < static_cast<size_t>(ObjectType::COUNT); ++i) {
+        out << "scheme_heap_live_bytes{type=\"" << GetObjectTypeName(static_cast<ObjectType>(i))
+            << "\"} " << stats.types[i].live_bytes << "\n";
+    }
+    out << "# TYPE scheme_heap_peak_live_bytes gauge\n"
+        << "scheme_heap_peak_live_bytes " << stats.peak_live_bytes << "\n";
+}
+
+void WriteSlabStatsMetrics(std::ostream& out, const std::vector<SlabStats>& stats) {
+    auto write = [&](const char* name, const char* type, int64_t SlabStats::*counter) {
+        out << "# TYPE " << name << " " << type << "\n";
+        for (const auto& slab : stats) {
+            out << name << "{arena=\"" << GetSlabArenaName(slab.arena) << "\",block_size=\""
+                << slab.block_size << "\"} " << slab.*counter << "\n";
+        }
+    };
+    write("scheme_slab_reserved_blocks", "gauge", &SlabStats::reserved_blocks);
+    write("scheme_slab_shared_free_blocks", "gauge", &SlabStats::shared_free_blocks);
+    write("scheme_slab_refills_total", "counter", &SlabStats::refills);
+    write("scheme_slab_releases_total", "counter", &SlabStats::releases);
+}
+
+void ExportHeapStats(const std::string& path) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        WriteHeapStatsMetrics(out, GetHeapStats());
+        WriteSlabStatsMetrics(out, GetSlabStats());
+        if (!out) {
+            throw RuntimeError("Can't write " + temporary);
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw RuntimeError("Can't write " + path);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "slab_allocator.h"
+
+enum class ObjectType { NUMBER, BOOLEAN, SYMBOL, CELL, LAMBDA, SCOPE, OTHER, COUNT };
+
+const char* GetObjectTypeName(ObjectType type);
+
+struct TypeStats {
+    int64_t allocations = 0;
+    int64_t live_objects = 0;
+    int64_t live_bytes = 0;
+};
+
+struct HeapStats {
+    TypeStats types[static_cast<size_t>(ObjectType::COUNT)];
+    int64_t live_bytes = 0;
+    int64_t peak_live_bytes = 0;
+
+    const TypeStats& operator[](ObjectType type) const;
+};
+
+// The difference of every counter except the peak, which is taken from the later snapshot.
+HeapStats operator-(const HeapStats& after, const HeapStats& before);
+
+inline std::atomic<bool>& GetHeapStatsFlag() {
+    static std::atomic<bool> enabled = false;
+    return enabled;
+}
+
+inline bool IsHeapStatsEnabled() {
+    return GetHeapStatsFlag().load(std::memory_order_relaxed);
+}
+
+// Objects created while the statistics are disabled are never counted, not even when
+// they are freed later.
+void SetHeapStatsEnabled(bool enabled);
+HeapStats GetHeapStats();
+
+void RecordAllocation(ObjectType type, size_t bytes, size_t count = 1);
+void RecordDeallocation(ObjectType type, size_t bytes, size_t count = 1);
+
+// Prometheus text exposition format.
+void WriteHeapStatsMetrics(std::ostream& out, const HeapStats& stats);
+void WriteSlabStatsMetrics(std::ostream& out, const std::vector<SlabStats>& stats);
+// Heap and slab metrics. Replaces the file atomically, so a scraper never observes a partially
+// written one.
+void ExportHeapStats(const std::string& path);
+
+template <class T>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    explicit TrackingAllocator(ObjectType type) : type_(type) {
+    }
+
+    template <class U>
+    TrackingAllocator(const TrackingAllocator<U>& other) : type_(other.GetType()) {
+    }
+
+    T* allocate(size_t n) {
+        RecordAllocation(type_, n * sizeof(T));
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        RecordDeallocation(type_, n * sizeof(T));
+        std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    ObjectType GetType() const {
+        return type_;
+    }
+
+    template <class U>
+    bool operator==(const TrackingAllocator<U>& other) const {
+        return type_ == other.GetType();
+    }
+
+private:
+    ObjectType type_;
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "error.h"
+#include "object.h"
+#include "scheme.h"
+
+// Conversions between Scheme objects and the parameter and result types of native functions.
+template <class T>
+struct NativeType;
+
+template <>
+struct NativeType<int64_t> {
+    static int64_t FromObject(const std::shared_ptr<Object>& obj) {
+        auto* number = dynamic_cast<Number*>(obj.get());
+        if (number == nullptr) {
+            throw RuntimeError("Function requires integer only arguments");
+        }
+        return number->GetValue();
+    }
+
+    static std::shared_ptr<Object> ToObject(int64_t value) {
+        return New<Number>(value);
+    }
+};
+
+template <>
+struct NativeType<bool> {
+    static bool FromObject(const std::shared_ptr<Object>& obj) {
+        auto* boolean = dynamic_cast<Boolean*>(obj.get());
+        if (boolean == nullptr) {
+            throw RuntimeError("Function requires boolean only arguments");
+        }
+        return boolean->GetValue();
+    }
+
+    static std::shared_ptr<Object> ToObject(bool value) {
+        return New<Boolean>(value);
+    }
+};
+
+template <>
+struct NativeType<std::string> {
+    static const std::string& FromObject(const std::shared_ptr<Object>& obj) {
+        auto* symbol = dynamic_cast<Symbol*>(obj.get());
+        if (symbol == nullptr) {
+            throw RuntimeError("Function requires symbol only arguments");
+        }
+        return symbol->GetName();
+    }
+
+    static std::shared_ptr<Object> ToObject(std::string value) {
+        return New<Symbol>(std::move(value));
+    }
+};
+
+template <>
+struct NativeType<std::shared_ptr<Object>> {
+    static const std::shared_ptr<Object>& FromObject(const std::shared_ptr<Object>& obj) {
+        return obj;
+    }
+
+    static std::shared_ptr<Object> ToObject(std::shared_ptr<Object> value) {
+        return value;
+    }
+};
+
+// Evaluates exactly sizeof...(Args) arguments, converts each of them with a single type
+// check and calls the wrapped callable.
+template <class F, class Result, class... Args>
+class NativeFunction : public Function {
+public:
+    explicit NativeFunction(F func) : func_(std::move(func)) {
+    }
+
+    std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
+                                   std::shared_ptr<Scope> scope) override {
+        std::array<std::shared_ptr<Object>, sizeof...(Args)> values;
+        std::shared_ptr<Object> rest = args->GetSecond();
+        for (auto& value : values) {
+            auto* cell = dynamic_cast<Cell*>(rest.get());
+            if (cell == nullptr) {
+                return RaiseError(
+                    ErrorKind::RUNTIME,
+                    "The amount of given arguments doesn't much the amount of requiring");
+            }
+            value = Interpreter::Calculate(cell->GetFirst(), scope);
+            if (Interpreter::IsRaised(value)) {
+                return value;
+            }
+            rest = cell->GetSecond();
+        }
+        if (rest != nullptr) {
+            return RaiseError(ErrorKind::RUNTIME,
+                              "The amount of given arguments doesn't much the amount of requiring");
+        }
+        return Call(values, std::index_sequence_for<Args...>{});
+    }
+
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope>) override {
+        if (values.size() != sizeof...(Args)) {
+            return RaiseError(ErrorKind::RUNTIME,
+                              "The amount of given arguments doesn't much the amount of requiring");
+        }
+        return Call(values, std::index_sequence_for<Args...>{});
+    }
+
+private:
+    template <class Values, size_t... I>
+    std::shared_ptr<Object> Call(const Values& values, std::index_sequence<I...>) {
+        if constexpr (std::is_void_v<Result>) {
+            func_(NativeType<std::decay_t<Args>>::FromObject(values[I])...);
+            return nullptr;
+        } else {
+            return NativeType<std::decay_t<Result>>::ToObject(
+                func_(NativeType<std::decay_t<Args>>::FromObject(values[I])...));
+        }
+    }
+
+    F func_;
+};
+
+template <class F, class Signature>
+struct NativeFunctionOf;
+
+template <class F, class Result, class... Args>
+struct NativeFunctionOf<F, Result (*)(Args...)> {
+    using Type = NativeFunction<F, Result, Args...>;
+};
+
+template <class F, class Class, class Result, class... Args>
+struct NativeFunctionOf<F, Result (Class::*)(Args...)> {
+    using Type = NativeFunction<F, Result, Args...>;
+};
+
+template <class F, class Class, class Result, class... Args>
+struct NativeFunctionOf<F, Result (Class::*)(Args...) const> {
+    using Type = NativeFunction<F, Result, Args...>;
+};
+
+template <class F>
+std::shared_ptr<Function> MakeNativeFunction(F func) {
+    if constexpr (std::is_pointer_v<F>) {
+        return std::make_shared<typename NativeFunctionOf<F, F>::Type>(func);
+    } else {
+        using Type = typename NativeFunctionOf<F, decltype(&F::operator())>::Type;
+        return std::make_shared<Type>(std::move(func));
+    }
+}
+
+template <class F>
+void Interpreter::Register(const std::string& name, F func) {
+    ThrowIfRaised(scope_->Define(name, MakeNativeFunction(std::move(func))));
+}
@@ -2,7 +2,11 @@
 #include "builtin_functions.h"
 #include "object.h"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 
 Number::Number(int64_t value) : value_(value) {
 }
@@ -18,6 +22,24 @@ bool Boolean::GetValue() {
     return value_;
 }
 
+// Never destroyed, so they outlive every object referring to them.
+const std::shared_ptr<Boolean>& GetSharedBoolean(bool value) {
+    static const auto kBooleans = new std::shared_ptr<Boolean>[2]{
+        std::make_shared<Boolean>(false), std::make_shared<Boolean>(true)};
+    return kBooleans[value];
+}
+
+const std::shared_ptr<Number>& GetSharedNumber(int64_t value) {
+    static const auto kNumbers = [] {
+        auto numbers = new std::shared_ptr<Number>[kMaxSharedNumber - kMinSharedNumber + 1];
+        for (int64_t i = kMinSharedNumber; i <= kMaxSharedNumber; ++i) {
+            numbers[i - kMinSharedNumber] = std::make_shared<Number>(i);
+        }
+        return numbers;
+    }();
+    return kNumbers[value - kMinSharedNumber];
+}
+
 Symbol::Symbol(const std::string& s) : name_(s) {
 }
 
@@ -25,10 +47,63 @@ const std::string& Symbol::GetName() const {
     return name_;
 }
 
+String::String(std::string value) : value_(std::move(value)) {
+}
+
+const std::string& String::GetValue() const {
+    return value_;
+}
+
+namespace {
+
+// Set in the pointer second_ holds for a frozen cell.
+constexpr uintptr_t kFrozenBit = 1;
+
+}  // namespace
+
 Cell::Cell(std::shared_ptr<Object> first, std::shared_ptr<Object> second)
     : first_(first), second_(second) {
 }
 
+Cell::~Cell() {
+    ReleaseChain(std::move(first_));
+    ReleaseChain(TakeSecond());
+}
+
+void Cell::ReleaseChain(std::shared_ptr<Object> next) {
+    // Nested lists whose last reference is dropped here, released after the current chain.
+    std::vector<std::shared_ptr<Object>> nested;
+    while (true) {
+        if (next != nullptr && next.use_count() == 1) {
+            if (auto* cell = dynamic_cast<Cell*>(next.get())) {
+                // A chunked cell is only freed with its chunk, which next owns alone then. The
+                // cells up to the end of the chunk are emptied first, so freeing it recurses
+                // into nothing.
+                while (true) {
+                    if (cell->first_.use_count() == 1 && Is<Cell>(cell->first_)) {
+                        nested.push_back(std::move(cell->first_));
+                    }
+                    if (!cell->IsChunked()) {
+                        break;
+                    }
+                    ++cell;
+                }
+                next = cell->TakeSecond();
+                continue;
+            }
+            if (auto* promise = dynamic_cast<Promise*>(next.get())) {
+                next = std::move(promise->value_);
+                continue;
+            }
+        }
+        if (nested.empty()) {
+            return;
+        }
+        next = std::move(nested.back());
+        nested.pop_back();
+    }
+}
+
 void Cell::SetFirst(std::shared_ptr<Object> shd_ptr) {
     first_ = shd_ptr;
 }
@@ -42,74 +117,510 @@ std::shared_ptr<Object> Cell::GetFirst() const {
 }
 
 std::shared_ptr<Object> Cell::GetSecond() const {
+    if (IsChunked()) {
+        return std::shared_ptr<Object>(GetChunk()->shared_from_this(), const_cast<Cell*>(this + 1));
+    }
+    if (IsFrozen()) {
+        return std::shared_ptr<Object>(second_, GetStoredSecond());
+    }
     return second_;
 }
 
+Object* Cell::PeekSecond() const {
+    if (IsChunked()) {
+        return const_cast<Cell*>(this + 1);
+    }
+    return GetStoredSecond();
+}
+
+Cell* Cell::GetNextCell() const {
+    if (IsChunked()) {
+        return const_cast<Cell*>(this + 1);
+    }
+    return dynamic_cast<Cell*>(GetStoredSecond());
+}
+
+void Cell::Freeze() {
+    auto stored = reinterpret_cast<uintptr_t>(second_.get());
+    second_ = std::shared_ptr<Object>(std::move(second_),
+                                      reinterpret_cast<Object*>(stored | kFrozenBit));
+}
+
+bool Cell::IsFrozen() const {
+    return reinterpret_cast<uintptr_t>(second_.get()) & kFrozenBit;
+}
+
+bool Cell::IsChunked() const {
+    return GetStoredSecond() != nullptr && !std::shared_ptr<Object>().owner_before(second_);
+}
+
+CellChunk* Cell::GetChunk() const {
+    return reinterpret_cast<CellChunk*>(GetStoredSecond());
+}
+
+Object* Cell::GetStoredSecond() const {
+    return reinterpret_cast<Object*>(reinterpret_cast<uintptr_t>(second_.get()) & ~kFrozenBit);
+}
+
+std::shared_ptr<Object> Cell::TakeSecond() {
+    Object* second = GetStoredSecond();
+    return std::shared_ptr<Object>(std::move(second_), second);
+}
+
+CellChunk::CellChunk(size_t size) : cells_(size) {
+    GetExecutionContext().ChargeAllocation(size * sizeof(Cell), size);
+    if (IsHeapStatsEnabled()) [[unlikely]] {
+        tracked_ = true;
+        RecordAllocation(ObjectType::CELL, size * sizeof(Cell), size);
+    }
+}
+
+CellChunk::~CellChunk() {
+    if (tracked_) {
+        RecordDeallocation(ObjectType::CELL, cells_.size() * sizeof(Cell), cells_.size());
+    }
+}
+
+std::shared_ptr<Cell> CellChunk::MakeList(std::span<const std::shared_ptr<Object>> elements,
+                                          std::shared_ptr<Object> tail) {
+    // Bounds the memory a reference to the end of a long list keeps alive.
+    constexpr size_t kMaxChunkSize = 1024;
+    for (size_t end = elements.size(); end > 0;) {
+        size_t begin = end - std::min(end, kMaxChunkSize);
+        auto chunk = std::make_shared<CellChunk>(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            Cell& cell = chunk->cells_[i - begin];
+            cell.first_ = elements[i];
+            if (i + 1 < end) {
+                cell.second_ = std::shared_ptr<Object>(std::shared_ptr<Object>(),
+                                                       reinterpret_cast<Object*>(chunk.get()));
+            }
+        }
+        chunk->cells_.back().second_ = std::move(tail);
+        Cell* first = chunk->cells_.data();
+        tail = std::shared_ptr<Cell>(std::move(chunk), first);
+        end = begin;
+    }
+    return As<Cell>(tail);
+}
+
 std::vector<std::shared_ptr<Object>> CellToVector(std::shared_ptr<Cell> obj) {
     if (obj == nullptr) {
         return {nullptr};
     }
-    std::vector<std::shared_ptr<Object>> ans = {obj->GetFirst()};
-    std::shared_ptr<Object> ptr = obj->GetSecond();
-    while (ptr != nullptr && Is<Cell>(ptr)) {
-        ans.emplace_back(As<Cell>(ptr)->GetFirst());
-        ptr = As<Cell>(ptr)->GetSecond();
+    // Sized up front, every call of a function converts its form.
+    size_t size = 2;
+    for (Cell* cell = obj->GetNextCell(); cell != nullptr; cell = cell->GetNextCell()) {
+        ++size;
+    }
+    std::vector<std::shared_ptr<Object>> ans;
+    ans.reserve(size);
+    const Cell* last = obj.get();
+    ans.emplace_back(last->GetFirst());
+    for (Cell* cell = last->GetNextCell(); cell != nullptr; cell = cell->GetNextCell()) {
+        ans.emplace_back(cell->GetFirst());
+        last = cell;
     }
-    ans.emplace_back(ptr);
+    ans.emplace_back(last->GetSecond());
     return ans;
 }
 
 std::shared_ptr<Cell> VectorToCell(std::vector<std::shared_ptr<Object>> vec) {
-    if (vec == std::vector<std::shared_ptr<Object>>{nullptr}) {
+    if (vec.size() < 2) {
         return nullptr;
     }
-    auto root = std::make_shared<Cell>();
-    auto cur_vertex = root;
-    cur_vertex->SetFirst(vec[0]);
-    for (size_t i = 1; i + 1 < vec.size(); ++i) {
-        cur_vertex->SetSecond(std::make_shared<Cell>(vec[i], nullptr));
-        cur_vertex = As<Cell>(cur_vertex->GetSecond());
+    return CellChunk::MakeList(std::span(vec).first(vec.size() - 1), vec.back());
+}
+
+RecordType::RecordType(std::string name, std::vector<std::string> fields)
+    : name_(std::move(name)), fields_(std::move(fields)) {
+}
+
+const std::string& RecordType::GetName() const {
+    return name_;
+}
+
+const std::vector<std::string>& RecordType::GetFields() const {
+    return fields_;
+}
+
+Record::Record(std::shared_ptr<const RecordType> type, std::vector<std::shared_ptr<Object>> slots)
+    : type_(std::move(type)), slots_(std::move(slots)) {
+}
+
+const RecordType* Record::GetType() const {
+    return type_.get();
+}
+
+const std::shared_ptr<Object>& Record::Get(size_t index) const {
+    return slots_[index];
+}
+
+void Record::Set(size_t index, std::shared_ptr<Object> value) {
+    slots_[index] = std::move(value);
+}
+
+void Record::Freeze() {
+    frozen_ = true;
+}
+
+bool Record::IsFrozen() const {
+    return frozen_;
+}
+
+Promise::Promise(std::shared_ptr<Object> value) : value_(std::move(value)), forced_(true) {
+}
+
+Promise::Promise(std::shared_ptr<Object> expression, std::shared_ptr<Scope> scope)
+    : expression_(std::move(expression)), scope_(std::move(scope)), forced_(false) {
+}
+
+Promise::Promise(std::function<std::shared_ptr<Object>()> compute)
+    : compute_(std::move(compute)), forced_(false) {
+}
+
+Promise::~Promise() {
+    Cell::ReleaseChain(std::move(value_));
+}
+
+std::shared_ptr<Object> Promise::Force() {
+    if (forced_.load(std::memory_order_acquire)) {
+        return value_;
+    }
+    ExecutionContext& context = GetExecutionContext();
+    uint64_t evaluation = context.GetEvaluationId();
+    bool owner = false;
+    {
+        std::unique_lock lock(mutex_);
+        while (forcing_ != 0 && forcing_ != evaluation && !forced_.load()) {
+            // Another evaluation computes the value. It may be a task on this very thread, which
+            // only gets on when this one yields.
+            if (context.yield) {
+                lock.unlock();
+                context.Pause();
+                lock.lock();
+            } else {
+                computed_.wait_for(lock, std::chrono::milliseconds(1));
+                context.Pause();
+            }
+        }
+        if (forced_.load(std::memory_order_relaxed)) {
+            return value_;
+        }
+        if (forcing_ == 0) {
+            forcing_ = evaluation;
+            owner = true;
+        }
     }
-    cur_vertex->GetSecond() = vec.back();
-    return root;
+    std::shared_ptr<Object> value;
+    auto compute = std::move(compute_);
+    try {
+        value = compute ? compute() : Interpreter::Calculate(expression_, scope_);
+    } catch (...) {
+        std::lock_guard lock(mutex_);
+        if (owner) {
+            compute_ = std::move(compute);
+            forcing_ = 0;
+            computed_.notify_all();
+        }
+        throw;
+    }
+    if (frozen_.load() && !Interpreter::IsRaised(value)) {
+        // Every interpreter sharing the promise sees the value.
+        Freezer freezer;
+        freezer.Add(value.get());
+        freezer.Run();
+    }
+    std::lock_guard lock(mutex_);
+    if (forced_.load(std::memory_order_relaxed)) {
+        // The computation forced the promise itself, the value it got first wins.
+        return value_;
+    }
+    if (Interpreter::IsRaised(value)) {
+        if (owner) {
+            compute_ = std::move(compute);
+            forcing_ = 0;
+            computed_.notify_all();
+        }
+        return value;
+    }
+    value_ = std::move(value);
+    // Whatever the computation referenced, like the rest of a stream, can be freed now.
+    expression_ = nullptr;
+    scope_ = nullptr;
+    compute_ = nullptr;
+    forcing_ = 0;
+    forced_.store(true, std::memory_order_release);
+    computed_.notify_all();
+    return value_;
 }
 
-Lambda::Lambda(std::shared_ptr<Cell> args, std::shared_ptr<Cell> commands,
-               std::shared_ptr<Scope> scope)
-    : parent_(scope) {
-    auto args_list = CellToVector(args);
-    if (args_list.back() != nullptr) {
-        throw RuntimeError("Combination must be a proper list");
+ForeignBuffer::ForeignBuffer(std::span<const int64_t> data, std::shared_ptr<const void> owner)
+    : data_(data), owner_(std::move(owner)) {
+}
+
+ForeignBuffer::ForeignBuffer(std::span<const std::string> data,
+                             std::shared_ptr<const void> owner)
+    : data_(data), owner_(std::move(owner)) {
+}
+
+size_t ForeignBuffer::GetSize() const {
+    return std::visit([](const auto& data) { return data.size(); }, data_);
+}
+
+std::shared_ptr<Object> ForeignBuffer::Get(size_t index) const {
+    if (index >= GetSize()) {
+        return RaiseError(ErrorKind::RUNTIME, "Function is trying to access non-existent element");
+    }
+    if (auto* numbers = std::get_if<std::span<const int64_t>>(&data_)) {
+        return New<Number>((*numbers)[index]);
+    }
+    return New<String>(std::get<std::span<const std::string>>(data_)[index]);
+}
+
+ErrorObject::ErrorObject(ErrorKind kind, std::string message, std::shared_ptr<Object> irritants)
+    : kind_(kind), message_(std::move(message)), irritants_(std::move(irritants)) {
+}
+
+ErrorKind ErrorObject::GetKind() const {
+    return kind_;
+}
+
+const std::string& ErrorObject::GetMessage() const {
+    return message_;
+}
+
+std::shared_ptr<Object> ErrorObject::GetIrritants() const {
+    return irritants_;
+}
+
+void ErrorObject::Throw() const {
+    std::string message = message_;
+    for (const auto& irritant : CellToVector(As<Cell>(irritants_))) {
+        if (irritant != nullptr) {
+            message += " " + Interpreter::ToString(irritant);
+        }
+    }
+    switch (kind_) {
+        case ErrorKind::SYNTAX:
+            throw SyntaxError(message);
+        case ErrorKind::NAME:
+            throw NameError(message);
+        default:
+            throw RuntimeError(message);
     }
-    variables_.resize(args_list.size() - 1);
-    for (size_t i = 0; i + 1 < args_list.size(); ++i) {
-        if (!Is<Symbol>(args_list[i])) {
-            throw RuntimeError("Arguments list must only contains names");
+}
+
+std::shared_ptr<Object> RaiseError(ErrorKind kind, const std::string& message) {
+    return Interpreter::Raise(New<ErrorObject>(kind, message));
+}
+
+std::shared_ptr<Object> Function::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                        std::shared_ptr<Scope> scope) {
+    return Interpreter::Calculate(MakeApplication(shared_from_this(), values), scope);
+}
+
+std::shared_ptr<Cell> MakeApplication(std::shared_ptr<Function> function,
+                                      const std::vector<std::shared_ptr<Object>>& values) {
+    static const auto kQuote = std::make_shared<Quote>();
+    std::shared_ptr<Object> args = nullptr;
+    for (auto it = values.rbegin(); it != values.rend(); ++it) {
+        std::shared_ptr<Object> arg = *it;
+        if (arg == nullptr || Is<Symbol>(arg) || Is<Cell>(arg)) {
+            arg = New<Cell>(kQuote, New<Cell>(arg, nullptr));
         }
-        variables_[i] = As<Symbol>(args_list[i])->GetName();
+        args = New<Cell>(arg, args);
+    }
+    return New<Cell>(std::move(function), std::move(args));
+}
+
+namespace {
+
+// See LambdaCode::MayCapture. A body too large to scan cheaply counts as capturing.
+bool MayCaptureScope(const std::vector<std::shared_ptr<Object>>& forms) {
+    constexpr size_t kMaxScannedCells = 4096;
+    std::vector<const Object*> pending;
+    for (const auto& form : forms) {
+        pending.push_back(form.get());
     }
-    auto list = CellToVector(commands);
-    command_list_.resize(list.size() - 1);
-    for (size_t i = 0; i + 1 < list.size(); ++i) {
-        command_list_[i] = list[i];
+    size_t scanned = 0;
+    while (!pending.empty()) {
+        auto* cell = dynamic_cast<const Cell*>(pending.back());
+        pending.pop_back();
+        if (cell == nullptr) {
+            continue;
+        }
+        if (++scanned > kMaxScannedCells) {
+            return true;
+        }
+        if (auto* head = dynamic_cast<const Symbol*>(cell->GetFirst().get())) {
+            const std::string& name = head->GetName();
+            Cell* next = cell->GetNextCell();
+            if (name == "lambda" || name == "delay" || name == "cons-stream" ||
+                name == "stream-map" || name == "stream-filter") {
+                return true;
+            }
+            // (define (f ...) ...) and a named let make closures too.
+            if (next != nullptr && ((name == "define" && Is<Cell>(next->GetFirst())) ||
+                                    (name == "let" && Is<Symbol>(next->GetFirst())))) {
+                return true;
+            }
+        }
+        pending.push_back(cell->GetFirst().get());
+        pending.push_back(cell->PeekSecond());
     }
+    return false;
+}
+
+}  // namespace
+
+LambdaCode::LambdaCode(std::vector<std::string> variables, std::shared_ptr<Cell> commands)
+    : variables_(std::move(variables)), commands_(CellToVector(commands)) {
+    commands_.pop_back();
+    may_capture_ = MayCaptureScope(commands_);
+}
+
+namespace {
+
+// Code of the lambda forms evaluated so far, keyed by the address of the form. An entry only
+// holds a weak reference to its form: once that expires, the address may belong to another cell
+// and the entry is stale. Stale entries are swept whenever a shard has doubled in size. Forms
+// of prepared expressions may be evaluated on several threads at once, so the table is split
+// into shards with a lock each.
+class LambdaCodeTable {
+public:
+    std::shared_ptr<const LambdaCode> Find(const std::shared_ptr<Cell>& form) {
+        Shard& shard = GetShard(form.get());
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.entries.find(form.get());
+        if (it == shard.entries.end() || it->second.form.expired()) {
+            return nullptr;
+        }
+        return it->second.code;
+    }
+
+    // Returns the code stored first if another thread was faster.
+    std::shared_ptr<const LambdaCode> Insert(const std::shared_ptr<Cell>& form,
+                                             std::shared_ptr<const LambdaCode> code) {
+        Shard& shard = GetShard(form.get());
+        std::lock_guard lock(shard.mutex);
+        auto [it, inserted] = shard.entries.try_emplace(form.get());
+        if (!inserted && !it->second.form.expired()) {
+            return it->second.code;
+        }
+        it->second = {form, std::move(code)};
+        if (shard.entries.size() >= shard.sweep_size) {
+            std::erase_if(shard.entries, [](const auto& entry) {
+                return entry.second.form.expired();
+            });
+            shard.sweep_size = std::max<size_t>(kMinSweepSize, 2 * shard.entries.size());
+        }
+        return it->second.code;
+    }
+
+private:
+    static constexpr size_t kShards = 16;
+    static constexpr size_t kMinSweepSize = 64;
+
+    struct Entry {
+        std::weak_ptr<Cell> form;
+        std::shared_ptr<const LambdaCode> code;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<const Cell*, Entry> entries;
+        size_t sweep_size = kMinSweepSize;
+    };
+
+    Shard& GetShard(const Cell* form) {
+        return shards_[std::hash<const Cell*>{}(form) / alignof(Cell) % kShards];
+    }
+
+    Shard shards_[kShards];
+};
+
+LambdaCodeTable& GetLambdaCodeTable() {
+    static LambdaCodeTable table;
+    return table;
+}
+
+}  // namespace
+
+std::shared_ptr<const LambdaCode> LambdaCode::Get(
+    const std::shared_ptr<Cell>& form, const std::function<std::optional<LambdaCode>()>& build) {
+    LambdaCodeTable& table = GetLambdaCodeTable();
+    if (auto code = table.Find(form)) {
+        return code;
+    }
+    auto result = build();
+    if (!result) {
+        return nullptr;
+    }
+    return table.Insert(form, std::make_shared<const LambdaCode>(std::move(*result)));
+}
+
+const std::vector<std::string>& LambdaCode::GetVariables() const {
+    return variables_;
+}
+
+const std::vector<std::shared_ptr<Object>>& LambdaCode::GetCommands() const {
+    return commands_;
+}
+
+bool LambdaCode::MayCapture() const {
+    return may_capture_;
+}
+
+Lambda::Lambda(std::shared_ptr<const LambdaCode> code, std::shared_ptr<Scope> scope)
+    : code_(std::move(code)), parent_(std::move(scope)) {
 }
 
 std::shared_ptr<Object> Lambda::Invoke(std::shared_ptr<Cell> args, std::shared_ptr<Scope> scope) {
+    const auto& variables = code_->GetVariables();
+    const auto& commands = code_->GetCommands();
     auto args_list = CellToVector(args);
     if (args_list.back() != nullptr) {
-        throw RuntimeError("Combination must be a proper list");
+        return RaiseError(ErrorKind::RUNTIME, "Combination must be a proper list");
     }
-    if (args_list.size() - 2 != variables_.size()) {
-        throw RuntimeError("The amount of given arguments doesn't much the amount of requiring");
+    if (args_list.size() - 2 != variables.size()) {
+        return RaiseError(ErrorKind::RUNTIME,
+                          "The amount of given arguments doesn't much the amount of requiring");
     }
-    std::shared_ptr<Scope> lambda_scope(std::make_shared<Scope>(parent_));
+    auto lambda_scope = code_->MayCapture() ? NewFrame(parent_) : NewReusableFrame(parent_);
     for (size_t i = 1; i + 1 < args_list.size(); ++i) {
-        lambda_scope->Define(variables_[i - 1], Interpreter::Calculate(args_list[i], scope));
+        auto value = Interpreter::Calculate(args_list[i], scope);
+        if (Interpreter::IsRaised(value)) {
+            return value;
+        }
+        lambda_scope->Define(variables[i - 1], std::move(value));
+    }
+    for (size_t i = 0; i + 1 < commands.size(); ++i) {
+        auto value = Interpreter::Calculate(commands[i], lambda_scope);
+        if (Interpreter::IsRaised(value)) {
+            return value;
+        }
     }
-    std::shared_ptr<Object> result = nullptr;
-    for (size_t i = 0; i < command_list_.size(); ++i) {
-        result = Interpreter::Calculate(command_list_[i], lambda_scope);
+    return Interpreter::TailCall(commands.back(), lambda_scope);
+}
+
+std::shared_ptr<Object> Lambda::Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                      std::shared_ptr<Scope>) {
+    const auto& variables = code_->GetVariables();
+    const auto& commands = code_->GetCommands();
+    if (values.size() != variables.size()) {
+        return RaiseError(ErrorKind::RUNTIME,
+                          "The amount of given arguments doesn't much the amount of requiring");
+    }
+    auto lambda_scope = code_->MayCapture() ? NewFrame(parent_) : NewReusableFrame(parent_);
+    for (size_t i = 0; i < values.size(); ++i) {
+        lambda_scope->Define(variables[i], values[i]);
+    }
+    for (size_t i = 0; i + 1 < commands.size(); ++i) {
+        auto value = Interpreter::Calculate(commands[i], lambda_scope);
+        if (Interpreter::IsRaised(value)) {
+            return value;
+        }
     }
-    return result;
+    return Interpreter::Calculate(commands.back(), lambda_scope);
 }
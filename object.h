@@ -1,15 +1,28 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <type_traits>
+#include <variant>
 #include <vector>
 
+#include "context.h"
+#include "heap_stats.h"
 #include "scheme.h"
+#include "slab_allocator.h"
 #include "tokenizer.h"
 
 class Scope;
+class CellChunk;
+class LambdaCode;
 
-class Object : public std::enable_shared_from_this<Object> {
+class Object {
 public:
     virtual ~Object() = default;
 };
@@ -41,44 +54,237 @@ private:
     std::string name_;
 };
 
+class String : public Object {
+public:
+    explicit String(std::string value);
+    const std::string& GetValue() const;
+
+private:
+    std::string value_;
+};
+
 class Cell : public Object {
 public:
     Cell() = default;
     Cell(std::shared_ptr<Object> first, std::shared_ptr<Object> second);
+    Cell(const Cell&) = delete;
+    Cell& operator=(const Cell&) = delete;
+    ~Cell();
+
+    // Releases a uniquely owned chain of cdrs and forced promise values and the lists nested in
+    // its cars in a loop, so freeing a long or deeply nested list or a stream doesn't recurse.
+    static void ReleaseChain(std::shared_ptr<Object> next);
 
     void SetFirst(std::shared_ptr<Object> shd_ptr);
     void SetSecond(std::shared_ptr<Object> shd_ptr);
 
     std::shared_ptr<Object> GetFirst() const;
     std::shared_ptr<Object> GetSecond() const;
+    // The cdr without taking a reference to it. Only valid while the list isn't changed.
+    Object* PeekSecond() const;
+    // The cdr if it is a cell, without taking a reference to it. Only valid while the list
+    // isn't changed.
+    Cell* GetNextCell() const;
+
+    // A frozen cell is shared by interpreters (see Interpreter::Fork), set-car! and set-cdr!
+    // refuse to change it.
+    void Freeze();
+    bool IsFrozen() const;
 
 private:
+    friend class CellChunk;
+
+    // Whether the cdr is the next cell of the chunk.
+    bool IsChunked() const;
+    CellChunk* GetChunk() const;
+    // The pointer second_ holds without the frozen bit.
+    Object* GetStoredSecond() const;
+    std::shared_ptr<Object> TakeSecond();
+
     std::shared_ptr<Object> first_ = nullptr;
+    // The cdr, or while the cdr is the next cell of the chunk, the chunk without an owner. Every
+    // other non-null cdr has one, which tells the two apart. The lowest bit of the pointer, which
+    // alignment leaves clear otherwise, is set once the cell is frozen.
     std::shared_ptr<Object> second_ = nullptr;
 };
 
+// Consecutive cells of a list stored in one array (CDR-coding). The cdr of every cell but the
+// last one is implicit, and any cell of the chunk keeps the whole chunk alive.
+class CellChunk : public std::enable_shared_from_this<CellChunk> {
+public:
+    explicit CellChunk(size_t size);
+    ~CellChunk();
+
+    // Builds a list of the elements followed by the tail.
+    static std::shared_ptr<Cell> MakeList(std::span<const std::shared_ptr<Object>> elements,
+                                          std::shared_ptr<Object> tail);
+
+private:
+    std::vector<Cell> cells_;
+    bool tracked_ = false;
+};
+
 std::vector<std::shared_ptr<Object>> CellToVector(std::shared_ptr<Cell> obj);
 std::shared_ptr<Cell> VectorToCell(std::vector<std::shared_ptr<Object>> vec);
 
-class Function : public Object {
+// Read-only view of contiguous host memory. A borrowed buffer has no owner and the caller
+// must keep the data alive while scripts may reach it; otherwise the owner is kept alive by
+// the buffer. Elements are converted to objects only when they are accessed.
+class ForeignBuffer : public Object {
+public:
+    explicit ForeignBuffer(std::span<const int64_t> data,
+                           std::shared_ptr<const void> owner = nullptr);
+    explicit ForeignBuffer(std::span<const std::string> data,
+                           std::shared_ptr<const void> owner = nullptr);
+
+    size_t GetSize() const;
+    // Numbers for integer buffers and strings for string buffers. Returns the raised error if the
+    // index is out of range.
+    std::shared_ptr<Object> Get(size_t index) const;
+
+private:
+    std::variant<std::span<const int64_t>, std::span<const std::string>> data_;
+    std::shared_ptr<const void> owner_;
+};
+
+// A value computed on the first force and remembered: an expression evaluated in its scope, or a
+// native computation used by the stream builtins.
+class Promise : public Object {
+public:
+    explicit Promise(std::shared_ptr<Object> value);
+    Promise(std::shared_ptr<Object> expression, std::shared_ptr<Scope> scope);
+    explicit Promise(std::function<std::shared_ptr<Object>()> compute);
+    ~Promise();
+
+    // Returns the raised error if computing the value raises, the promise stays unforced then.
+    // One evaluation at a time computes the value, others forcing the promise meanwhile wait
+    // for it as long as they aren't cancelled or out of steps. The computation may force the
+    // promise again itself.
+    std::shared_ptr<Object> Force();
+
+private:
+    friend class Cell;
+    friend class Freezer;
+
+    std::shared_ptr<Object> value_;
+    std::shared_ptr<Object> expression_;
+    std::shared_ptr<Scope> scope_;
+    std::function<std::shared_ptr<Object>()> compute_;
+    std::mutex mutex_;
+    std::condition_variable computed_;
+    // Id of the evaluation computing the value, zero when none is.
+    uint64_t forcing_ = 0;
+    // Set once value_ is final, after which value_ is read without the lock.
+    std::atomic<bool> forced_;
+    // Whether the value gets frozen once computed.
+    std::atomic<bool> frozen_ = false;
+};
+
+// Descriptor of a type made by define-record-type.
+class RecordType : public Object {
+public:
+    RecordType(std::string name, std::vector<std::string> fields);
+
+    const std::string& GetName() const;
+    const std::vector<std::string>& GetFields() const;
+
+private:
+    std::string name_;
+    std::vector<std::string> fields_;
+};
+
+// An instance of a record type, with one slot per field in the order of the type's fields.
+class Record : public Object {
+public:
+    Record(std::shared_ptr<const RecordType> type, std::vector<std::shared_ptr<Object>> slots);
+
+    const RecordType* GetType() const;
+    const std::shared_ptr<Object>& Get(size_t index) const;
+    void Set(size_t index, std::shared_ptr<Object> value);
+
+    // Like a frozen cell, a frozen record is shared and its modifiers refuse to change it.
+    void Freeze();
+    bool IsFrozen() const;
+
+private:
+    std::shared_ptr<const RecordType> type_;
+    std::vector<std::shared_ptr<Object>> slots_;
+    bool frozen_ = false;
+};
+
+enum class ErrorKind { SYNTAX, RUNTIME, NAME };
+
+class ErrorObject : public Object {
+public:
+    ErrorObject(ErrorKind kind, std::string message, std::shared_ptr<Object> irritants = nullptr);
+
+    ErrorKind GetKind() const;
+    const std::string& GetMessage() const;
+    std::shared_ptr<Object> GetIrritants() const;
+
+    // Throws the exception of the matching kind.
+    [[noreturn]] void Throw() const;
+
+private:
+    ErrorKind kind_;
+    std::string message_;
+    std::shared_ptr<Object> irritants_;
+};
+
+// Raises an error object through Interpreter::Raise.
+std::shared_ptr<Object> RaiseError(ErrorKind kind, const std::string& message);
+
+class Function : public Object, public std::enable_shared_from_this<Function> {
 public:
     virtual ~Function() = default;
     virtual std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                            std::shared_ptr<Scope> scope) = 0;
+    // Calls the function with already evaluated arguments.
+    virtual std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                          std::shared_ptr<Scope> scope);
+};
+
+// The form calling function with the values, each quoted unless it evaluates to itself.
+std::shared_ptr<Cell> MakeApplication(std::shared_ptr<Function> function,
+                                      const std::vector<std::shared_ptr<Object>>& values);
+
+// The parameters and body of a lambda, shared by all closures created from the same form.
+class LambdaCode {
+public:
+    LambdaCode(std::vector<std::string> variables, std::shared_ptr<Cell> commands);
+
+    // The code cached for form, built by build on the first call. Changes of the form made after
+    // that don't affect the code. Returns null, caching nothing, if build returns nothing.
+    static std::shared_ptr<const LambdaCode> Get(
+        const std::shared_ptr<Cell>& form, const std::function<std::optional<LambdaCode>()>& build);
+
+    const std::vector<std::string>& GetVariables() const;
+    const std::vector<std::shared_ptr<Object>>& GetCommands() const;
+    // Whether the body may keep the scope of a call alive through a closure, a promise or a
+    // stream made in it. Decided from the names the body mentions, so it errs towards true, and
+    // misses only an alias of a form that makes one.
+    bool MayCapture() const;
+
+private:
+    std::vector<std::string> variables_;
+    std::vector<std::shared_ptr<Object>> commands_;
+    bool may_capture_;
 };
 
 class Lambda : public Function {
 public:
-    Lambda(std::shared_ptr<Cell> args, std::shared_ptr<Cell> commands,
-           std::shared_ptr<Scope> scope);
+    Lambda(std::shared_ptr<const LambdaCode> code, std::shared_ptr<Scope> scope);
 
     std::shared_ptr<Object> Invoke(std::shared_ptr<Cell> args,
                                    std::shared_ptr<Scope> scope) override;
+    std::shared_ptr<Object> Apply(const std::vector<std::shared_ptr<Object>>& values,
+                                  std::shared_ptr<Scope> scope) override;
 
 private:
+    friend class Freezer;
+
+    std::shared_ptr<const LambdaCode> code_;
     std::shared_ptr<Scope> parent_;
-    std::vector<std::string> variables_;
-    std::vector<std::shared_ptr<Object>> command_list_;
 };
 
 template <class T>
@@ -89,4 +295,54 @@ std::shared_ptr<T> As(const std::shared_ptr<Object>& obj) {
 template <class T>
 bool Is(const std::shared_ptr<Object>& obj) {
     return std::dynamic_pointer_cast<T>(obj) != nullptr;
-}
\ No newline at end of file
+}
+
+// Everything but #f counts as true.
+inline bool IsTrue(const std::shared_ptr<Object>& obj) {
+    auto* boolean = dynamic_cast<Boolean*>(obj.get());
+    return boolean == nullptr || boolean->GetValue();
+}
+
+template <class T>
+inline constexpr ObjectType kObjectTypeOf = ObjectType::OTHER;
+template <>
+inline constexpr ObjectType kObjectTypeOf<Number> = ObjectType::NUMBER;
+template <>
+inline constexpr ObjectType kObjectTypeOf<Boolean> = ObjectType::BOOLEAN;
+template <>
+inline constexpr ObjectType kObjectTypeOf<Symbol> = ObjectType::SYMBOL;
+template <>
+inline constexpr ObjectType kObjectTypeOf<Cell> = ObjectType::CELL;
+template <>
+inline constexpr ObjectType kObjectTypeOf<Lambda> = ObjectType::LAMBDA;
+template <>
+inline constexpr ObjectType kObjectTypeOf<Scope> = ObjectType::SCOPE;
+
+// #t, #f and the numbers from kMinSharedNumber to kMaxSharedNumber are canonical objects shared
+// by all interpreters. New returns them instead of allocating.
+inline constexpr int64_t kMinSharedNumber = -256;
+inline constexpr int64_t kMaxSharedNumber = 1023;
+
+const std::shared_ptr<Boolean>& GetSharedBoolean(bool value);
+const std::shared_ptr<Number>& GetSharedNumber(int64_t value);
+
+template <class T, class... Args>
+std::shared_ptr<T> New(Args&&... args) {
+    if constexpr (std::is_same_v<T, Boolean>) {
+        const bool value(args...);
+        return GetSharedBoolean(value);
+    } else {
+        if constexpr (std::is_same_v<T, Number>) {
+            const int64_t value(args...);
+            if (value >= kMinSharedNumber && value <= kMaxSharedNumber) {
+                return GetSharedNumber(value);
+            }
+        }
+        GetExecutionContext().ChargeAllocation(sizeof(T));
+        if (IsHeapStatsEnabled()) [[unlikely]] {
+            return std::allocate_shared<T>(TrackingAllocator<T>(kObjectTypeOf<T>),
+                                           std::forward<Args>(args)...);
+        }
+        return std::allocate_shared<T>(SlabAllocator<T>(), std::forward<Args>(args)...);
+    }
+}
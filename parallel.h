@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <thread>
+
+size_t GetDefaultThreadCount();
+
+// Calls body(0), ..., body(count - 1) on up to thread_count threads, handing out indices
+// dynamically. Rethrows the first exception raised by body after all threads have joined.
+void ParallelFor(size_t count, size_t thread_count, const std::function<void(size_t)>& body);
@@ -1,75 +1,275 @@
 #include "error.h"
+#include "parallel.h"
 #include "parser.h"
 
+#include <algorithm>
+#include <exception>
 #include <iostream>
+#include <streambuf>
 
-std::shared_ptr<Object> ReadList(Tokenizer* tokenizer) {
-    Token cur_token = tokenizer->GetToken();
-    if (cur_token == Token{BracketToken::CLOSE}) {
-        tokenizer->Next();
-        return nullptr;
-    }
-    std::shared_ptr<Cell> root(new Cell);
-    std::shared_ptr<Cell> cur_vertex = root;
-    while (!tokenizer->IsEnd()) {
-        cur_vertex->SetFirst(Read(tokenizer));
-        cur_token = tokenizer->GetToken();
-        if (cur_token == Token{BracketToken::CLOSE}) {
-            break;
-        } else if (cur_token == Token{DotToken{}}) {
-            break;
-        }
-        cur_vertex->SetSecond(std::make_shared<Cell>());
-        cur_vertex = As<Cell>(cur_vertex->GetSecond());
+namespace {
+
+bool IsAtom(const Token& token) {
+    return std::holds_alternative<ConstantToken>(token) ||
+           std::holds_alternative<SymbolToken>(token) || std::holds_alternative<StringToken>(token);
+}
+
+std::shared_ptr<Object> MakeAtom(const Token& token) {
+    if (std::holds_alternative<ConstantToken>(token)) {
+        return New<Number>(std::get<ConstantToken>(token).value);
+    }
+    if (std::holds_alternative<StringToken>(token)) {
+        return New<String>(std::get<StringToken>(token).value);
+    }
+    const auto& name = std::get<SymbolToken>(token).name;
+    if (name == "#t") {
+        return New<Boolean>(true);
     }
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("Bracket sequence is not correct");
+    if (name == "#f") {
+        return New<Boolean>(false);
     }
-    if (cur_token == Token{DotToken{}}) {
+    return New<Symbol>(name);
+}
+
+std::shared_ptr<Object> MakeQuote(std::shared_ptr<Object> datum) {
+    return New<Cell>(New<Symbol>("quote"), New<Cell>(std::move(datum), nullptr));
+}
+
+}  // namespace
+
+std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
+    TokenParser parser;
+    std::shared_ptr<Object> datum;
+    while (true) {
+        if (tokenizer->IsEnd()) {
+            if (parser.IsInside()) {
+                parser.ThrowUnfinished();
+            }
+            throw SyntaxError("Unexpected end");
+        }
+        Token token = tokenizer->GetToken();
         tokenizer->Next();
-        cur_vertex->SetSecond(Read(tokenizer));
-        cur_token = tokenizer->GetToken();
-        if (tokenizer->IsEnd() || cur_token != Token{BracketToken::CLOSE}) {
-            throw SyntaxError("Scheme pair can only be used at the end of the list");
+        if (parser.Push(token, &datum)) {
+            return datum;
         }
     }
-    if (cur_token != Token{BracketToken::CLOSE}) {
-        throw SyntaxError("Bracket sequence is not correct");
+}
+
+bool TokenParser::Push(const Token& token, std::shared_ptr<Object>* datum) {
+    try {
+        if (IsAtom(token)) {
+            return Complete(MakeAtom(token), datum);
+        }
+        if (std::holds_alternative<QuoteToken>(token)) {
+            frames_.emplace_back().quote = true;
+            return false;
+        }
+        if (token == Token{BracketToken::OPEN}) {
+            frames_.emplace_back();
+            return false;
+        }
+        Frame* frame = frames_.empty() || frames_.back().quote ? nullptr : &frames_.back();
+        if (std::holds_alternative<DotToken>(token)) {
+            if (frame != nullptr && frame->state == ListState::AFTER_TAIL) {
+                throw SyntaxError("Scheme pair can only be used at the end of the list");
+            }
+            if (frame == nullptr || frame->elements.empty() ||
+                frame->state == ListState::AFTER_DOT) {
+                throw SyntaxError("Unexpected dot");
+            }
+            frame->state = ListState::AFTER_DOT;
+            return false;
+        }
+        if (frame == nullptr || frame->state == ListState::AFTER_DOT) {
+            throw SyntaxError("Bracket sequence is not correct");
+        }
+        auto list = frame->elements.empty()
+                        ? nullptr
+                        : CellChunk::MakeList(frame->elements, std::move(frame->tail));
+        frames_.pop_back();
+        return Complete(std::move(list), datum);
+    } catch (...) {
+        frames_.clear();
+        throw;
     }
-    tokenizer->Next();
-    return root;
 }
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
-    if (tokenizer->IsEnd()) {
-        throw SyntaxError("Unexpected end");
+bool TokenParser::Complete(std::shared_ptr<Object> datum, std::shared_ptr<Object>* result) {
+    while (!frames_.empty() && frames_.back().quote) {
+        frames_.pop_back();
+        datum = MakeQuote(std::move(datum));
+    }
+    if (frames_.empty()) {
+        *result = std::move(datum);
+        return true;
+    }
+    Frame& frame = frames_.back();
+    if (frame.state == ListState::ELEMENTS) {
+        frame.elements.push_back(std::move(datum));
+    } else if (frame.state == ListState::AFTER_DOT) {
+        frame.tail = std::move(datum);
+        frame.state = ListState::AFTER_TAIL;
+    } else {
+        throw SyntaxError("Scheme pair can only be used at the end of the list");
     }
-    Token cur_token = tokenizer->GetToken();
-    tokenizer->Next();
-    if (cur_token == Token{BracketToken::OPEN}) {
-        return ReadList(tokenizer);
+    return false;
+}
+
+bool TokenParser::IsInside() const {
+    return !frames_.empty();
+}
+
+void TokenParser::ThrowUnfinished() {
+    bool in_list = std::any_of(frames_.begin(), frames_.end(),
+                               [](const Frame& frame) { return !frame.quote; });
+    frames_.clear();
+    throw SyntaxError(in_list ? "Bracket sequence is not correct" : "Unexpected end");
+}
+
+namespace {
+
+class ViewBuffer : public std::streambuf {
+public:
+    explicit ViewBuffer(std::string_view view) {
+        char* begin = const_cast<char*>(view.data());
+        setg(begin, begin, begin + view.size());
     }
-    if (std::holds_alternative<ConstantToken>(cur_token)) {
-        return std::make_shared<Number>(std::get<ConstantToken>(cur_token).value);
+};
+
+bool IsBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\n';
+}
+
+// Splits the input at blanks between top-level data, aiming for pieces of about the given size.
+std::vector<std::string_view> SplitTopLevel(std::string_view input, size_t piece_size) {
+    std::vector<std::string_view> pieces;
+    size_t begin = 0;
+    int64_t depth = 0;
+    bool after_quote = false;
+    bool in_string = false;
+    for (size_t i = 0; i < input.size(); ++i) {
+        char c = input[i];
+        if (in_string) {
+            if (c == '\\') {
+                ++i;
+            } else if (c == '"') {
+                in_string = false;
+            }
+            continue;
+        }
+        if (c == '"') {
+            in_string = true;
+        } else if (c == '(') {
+            ++depth;
+        } else if (c == ')') {
+            --depth;
+        } else if (IsBlank(c)) {
+            if (depth == 0 && !after_quote && i - begin >= piece_size) {
+                pieces.emplace_back(input.substr(begin, i - begin));
+                begin = i;
+            }
+            continue;
+        }
+        after_quote = c == '\'';
     }
-    if (std::holds_alternative<SymbolToken>(cur_token)) {
-        if (std::get<SymbolToken>(cur_token).name == "#t") {
-            return std::make_shared<Boolean>(true);
+    pieces.emplace_back(input.substr(begin));
+    return pieces;
+}
+
+}  // namespace
+
+std::vector<std::shared_ptr<Object>> ReadAll(std::string_view input, size_t thread_count) {
+    constexpr size_t kPiecesPerThread = 4;
+    constexpr size_t kMinPieceSize = 64 << 10;
+    thread_count = std::max<size_t>(thread_count, 1);
+    size_t piece_size = std::max(kMinPieceSize, input.size() / (thread_count * kPiecesPerThread));
+    auto pieces = SplitTopLevel(input, piece_size);
+
+    std::vector<std::vector<std::shared_ptr<Object>>> results(pieces.size());
+    std::vector<std::exception_ptr> errors(pieces.size());
+    ParallelFor(pieces.size(), thread_count, [&](size_t i) {
+        try {
+            ViewBuffer buffer(pieces[i]);
+            std::istream stream(&buffer);
+            Tokenizer tokenizer(&stream);
+            while (!tokenizer.IsEnd()) {
+                results[i].emplace_back(Read(&tokenizer));
+            }
+        } catch (...) {
+            errors[i] = std::current_exception();
         }
-        if (std::get<SymbolToken>(cur_token).name == "#f") {
-            return std::make_shared<Boolean>(false);
+    });
+
+    std::vector<std::shared_ptr<Object>> data;
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        if (errors[i]) {
+            std::rethrow_exception(errors[i]);
         }
-        return std::make_shared<Symbol>(std::get<SymbolToken>(cur_token).name);
+        data.insert(data.end(), std::make_move_iterator(results[i].begin()),
+                    std::make_move_iterator(results[i].end()));
     }
-    if (std::holds_alternative<QuoteToken>(cur_token)) {
-        return std::make_shared<Cell>(std::make_shared<Symbol>("quote"),
-                                      std::make_shared<Cell>(Read(tokenizer), nullptr));
+    return data;
+}
+
+void PushParser::Feed(std::span<const char> data) {
+    size_t parsed = pending_.size();
+    pending_.append(data.begin(), data.end());
+    // Everything pending before is a single unfinished token, so only the new bytes can end it.
+    // A token ends after a byte that can't continue it, or after the quote closing a string.
+    size_t end = parsed;
+    for (size_t i = parsed; i < pending_.size(); ++i) {
+        char c = pending_[i];
+        if (string_state_ == StringState::ESCAPE) {
+            string_state_ = StringState::INSIDE;
+        } else if (string_state_ == StringState::INSIDE) {
+            if (c == '\\') {
+                string_state_ = StringState::ESCAPE;
+            } else if (c == '"') {
+                string_state_ = StringState::OUTSIDE;
+                end = i + 1;
+            }
+        } else if (c == '"') {
+            string_state_ = StringState::INSIDE;
+        } else if (!IsSymbolChar(c) && c != '+') {
+            end = i + 1;
+        }
     }
-    if (std::holds_alternative<DotToken>(cur_token)) {
-        throw SyntaxError("Unexpected dot");
+    if (end > parsed) {
+        Parse(end);
     }
-    if (cur_token == Token{BracketToken::CLOSE}) {
-        throw SyntaxError("Bracket sequence is not correct");
+}
+
+void PushParser::Finish() {
+    Parse(pending_.size());
+    if (parser_.IsInside()) {
+        parser_.ThrowUnfinished();
     }
-    throw SyntaxError("Unknown token");
-}
\ No newline at end of file
+}
+
+bool PushParser::Poll(std::shared_ptr<Object>* datum) {
+    if (data_.empty()) {
+        return false;
+    }
+    *datum = std::move(data_.front());
+    data_.pop_front();
+    return true;
+}
+
+// Parses the first size pending bytes, which end at a token boundary.
+void PushParser::Parse(size_t size) {
+    try {
+        ViewBuffer buffer(std::string_view(pending_).substr(0, size));
+        std::istream stream(&buffer);
+        std::shared_ptr<Object> datum;
+        for (Tokenizer tokenizer(&stream); !tokenizer.IsEnd(); tokenizer.Next()) {
+            if (parser_.Push(tokenizer.GetToken(), &datum)) {
+                data_.push_back(std::move(datum));
+            }
+        }
+    } catch (...) {
+        pending_.clear();
+        string_state_ = StringState::OUTSIDE;
+        throw;
+    }
+    pending_.erase(0, size);
+}
@@ -1,8 +1,71 @@
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "object.h"
 #include "tokenizer.h"
 
-std::shared_ptr<Object> Read(Tokenizer* tokenizer);
\ No newline at end of file
+// Reads the next datum. Nesting is only bounded by memory.
+std::shared_ptr<Object> Read(Tokenizer* tokenizer);
+
+// Reads every top-level datum of the input, parsing independent ranges of it in parallel.
+std::vector<std::shared_ptr<Object>> ReadAll(std::string_view input, size_t thread_count);
+
+// Builds data from tokens fed one at a time. The unfinished lists and quotes are kept on a stack
+// instead of the native one.
+class TokenParser {
+public:
+    // Returns true and stores the datum once the token completes one. Throws SyntaxError on a
+    // malformed datum, which is dropped then.
+    bool Push(const Token& token, std::shared_ptr<Object>* datum);
+    // Whether a datum is unfinished.
+    bool IsInside() const;
+    // Drops the unfinished datum and throws the SyntaxError for input ending inside it.
+    [[noreturn]] void ThrowUnfinished();
+
+private:
+    enum class ListState { ELEMENTS, AFTER_DOT, AFTER_TAIL };
+
+    // An open list, or a quote waiting for its datum.
+    struct Frame {
+        bool quote = false;
+        ListState state = ListState::ELEMENTS;
+        std::vector<std::shared_ptr<Object>> elements;
+        std::shared_ptr<Object> tail;
+    };
+
+    bool Complete(std::shared_ptr<Object> datum, std::shared_ptr<Object>* result);
+
+    std::vector<Frame> frames_;
+};
+
+// Parses input that arrives in chunks of any size. Unfinished tokens, lists and quotes are kept
+// between the chunks, and every top-level datum can be taken as soon as its last byte is fed.
+class PushParser {
+public:
+    // Throws SyntaxError on malformed input. Data completed before the error can still be taken,
+    // the unfinished one is dropped and parsing starts over with the next chunk.
+    void Feed(std::span<const char> data);
+    // Ends the input. Throws SyntaxError if a datum is unfinished.
+    void Finish();
+
+    // Takes the next complete datum, returns false if there is none yet.
+    bool Poll(std::shared_ptr<Object>* datum);
+
+private:
+    enum class StringState { OUTSIDE, INSIDE, ESCAPE };
+
+    void Parse(size_t size);
+
+    // Input not parsed yet, the bytes of a token that may continue in the next chunk.
+    std::string pending_;
+    // Whether the end of pending_ is inside a string literal.
+    StringState string_state_ = StringState::OUTSIDE;
+    TokenParser parser_;
+    std::deque<std::shared_ptr<Object>> data_;
+};
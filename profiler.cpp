@@ -0,0 +1,228 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+
+#include <unistd.h>
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace {
+
+// Multi-producer ring of samples: signal handlers on any thread claim slots, the drainer
+// empties whatever is ready. A sample is dropped when its slot hasn't been drained yet.
+struct SampleRing {
+    static constexpr size_t kSlots = 1024;
+    static constexpr size_t kSampleSize = 2048;
+
+    enum State : uint32_t { EMPTY, WRITING, READY };
+
+    struct Slot {
+        std::atomic<uint32_t> state = EMPTY;
+        uint32_t size = 0;
+        char data[kSampleSize] = {};
+    };
+
+    Slot slots[kSlots];
+    std::atomic<uint64_t> next = 0;
+    std::atomic<uint64_t> dropped = 0;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+// Constant-initialized, so the signal handler never races with a lazy initialization.
+constinit SampleRing sample_ring;
+struct sigaction previous_action;
+
+// Timers of the threads that evaluated while the profiler runs. Each one counts the CPU time of
+// its thread and sends SIGPROF to that thread, so a sample always shows the stack that used the
+// time. A thread creates its timer when it pushes its first frame in a generation, and the
+// generation changes whenever the profiler starts or stops.
+struct ThreadTimers {
+    std::mutex mutex;
+    bool running = false;
+    std::atomic<uint64_t> generation = 0;
+    std::chrono::microseconds interval{};
+    std::vector<timer_t> timers;
+};
+
+constinit ThreadTimers thread_timers;
+
+void ArmThreadTimer() {
+    static constinit thread_local uint64_t armed_generation = 0;
+    ThreadTimers& timers = thread_timers;
+    if (armed_generation == timers.generation.load(std::memory_order_acquire)) [[likely]] {
+        return;
+    }
+    std::lock_guard lock(timers.mutex);
+    armed_generation = timers.generation.load(std::memory_order_relaxed);
+    if (!timers.running) {
+        return;
+    }
+    sigevent event{};
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = gettid();
+    timer_t timer;
+    // The thread just goes unsampled if it can't have a timer.
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &timer) < 0) {
+        return;
+    }
+    itimerspec spec{};
+    spec.it_interval.tv_sec = timers.interval.count() / 1000000;
+    spec.it_interval.tv_nsec = timers.interval.count() % 1000000 * 1000;
+    spec.it_value = spec.it_interval;
+    timer_settime(timer, 0, &spec, nullptr);
+    timers.timers.push_back(timer);
+}
+
+void HandleSample(int) {
+    // Signals of deleted timers may still arrive after the profiler stopped.
+    if (!IsProfilerActive()) {
+        return;
+    }
+    ShadowStack& stack = GetShadowStack();
+    uint32_t depth = stack.depth.load(std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_acquire);
+    if (depth == 0) {
+        return;
+    }
+    depth = std::min(depth, ShadowStack::kCapacity);
+
+    SampleRing& ring = sample_ring;
+    auto& slot = ring.slots[ring.next.fetch_add(1, std::memory_order_relaxed) % SampleRing::kSlots];
+    uint32_t expected = SampleRing::EMPTY;
+    if (!slot.state.compare_exchange_strong(expected, SampleRing::WRITING,
+                                            std::memory_order_acquire)) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    size_t size = 0;
+    for (uint32_t i = 0; i < depth; ++i) {
+        std::string_view frame = stack.frames[i];
+        if (size + frame.size() + 1 > SampleRing::kSampleSize) {
+            break;
+        }
+        if (i != 0) {
+            slot.data[size++] = ';';
+        }
+        std::memcpy(slot.data + size, frame.data(), frame.size());
+        size += frame.size();
+    }
+    slot.size = size;
+    slot.state.store(SampleRing::READY, std::memory_order_release);
+}
+
+}  // namespace
+
+void ProfilerFrameGuard::Push(std::string_view name) {
+    ArmThreadTimer();
+    ShadowStack& stack = GetShadowStack();
+    uint32_t depth = stack.depth.load(std::memory_order_relaxed);
+    if (depth < ShadowStack::kCapacity) {
+        stack.frames[depth] = name;
+    }
+    std::atomic_signal_fence(std::memory_order_release);
+    stack.depth.store(depth + 1, std::memory_order_relaxed);
+    pushed_ = true;
+}
+
+void ProfilerFrameGuard::Pop() {
+    ShadowStack& stack = GetShadowStack();
+    stack.depth.store(stack.depth.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    pushed_ = false;
+}
+
+Profiler::Profiler(std::chrono::microseconds interval) : interval_(interval) {
+}
+
+Profiler::~Profiler() {
+    Stop();
+}
+
+void Profiler::Start() {
+    if (running_) {
+        return;
+    }
+    if (GetProfilerFlag().exchange(true)) {
+        throw std::runtime_error("Another profiler is already running");
+    }
+    struct sigaction action {};
+    action.sa_handler = &HandleSample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, &previous_action);
+    {
+        std::lock_guard lock(thread_timers.mutex);
+        thread_timers.running = true;
+        thread_timers.interval = interval_;
+        thread_timers.generation.fetch_add(1, std::memory_order_release);
+    }
+    running_ = true;
+
+    stop_draining_ = false;
+    drainer_ = std::thread([this] {
+        while (!stop_draining_.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            Drain();
+        }
+    });
+}
+
+void Profiler::Stop() {
+    if (!running_) {
+        return;
+    }
+    {
+        std::lock_guard lock(thread_timers.mutex);
+        thread_timers.running = false;
+        thread_timers.generation.fetch_add(1, std::memory_order_release);
+        for (timer_t timer : thread_timers.timers) {
+            timer_delete(timer);
+        }
+        thread_timers.timers.clear();
+    }
+    GetProfilerFlag().store(false);
+    // A signal of a deleted timer can still be pending on some thread, and the default action
+    // would kill the process, so it is ignored from now on instead.
+    struct sigaction action = previous_action;
+    if (!(action.sa_flags & SA_SIGINFO) && action.sa_handler == SIG_DFL) {
+        action.sa_handler = SIG_IGN;
+    }
+    sigaction(SIGPROF, &action, nullptr);
+    running_ = false;
+    stop_draining_ = true;
+    drainer_.join();
+    Drain();
+}
+
+void Profiler::Drain() {
+    SampleRing& ring = sample_ring;
+    std::lock_guard lock(mutex_);
+    for (auto& slot : ring.slots) {
+        if (slot.state.load(std::memory_order_acquire) != SampleRing::READY) {
+            continue;
+        }
+        ++folded_[std::string(slot.data, slot.size)];
+        slot.state.store(SampleRing::EMPTY, std::memory_order_release);
+    }
+}
+
+void Profiler::WriteFolded(std::ostream& out) {
+    Drain();
+    std::lock_guard lock(mutex_);
+    for (const auto& [stack, count] : folded_) {
+        out << stack << " " << count << "\n";
+    }
+}
+
+uint64_t Profiler::GetDroppedSamples() const {
+    return sample_ring.dropped.load(std::memory_order_relaxed);
+}
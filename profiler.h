@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Frames currently being evaluated on a thread. Entries are written before the depth is
+// published, so the SIGPROF handler running on the same thread always sees a consistent
+// prefix. Frame names point into symbols kept alive by the expression being evaluated.
+struct ShadowStack {
+    static constexpr uint32_t kCapacity = 256;
+
+    std::string_view frames[kCapacity];
+    std::atomic<uint32_t> depth = 0;
+};
+
+// The stack a task running on a fiber installs while it runs, null if the thread uses its own.
+inline ShadowStack*& GetInstalledShadowStack() {
+    static constinit thread_local ShadowStack* stack = nullptr;
+    return stack;
+}
+
+inline ShadowStack& GetShadowStack() {
+    static constinit thread_local ShadowStack stack;
+    ShadowStack* installed = GetInstalledShadowStack();
+    return installed != nullptr ? *installed : stack;
+}
+
+inline std::atomic<bool>& GetProfilerFlag() {
+    static std::atomic<bool> active = false;
+    return active;
+}
+
+inline bool IsProfilerActive() {
+    return GetProfilerFlag().load(std::memory_order_relaxed);
+}
+
+// Pushes a frame only while a profiler is running, and pops exactly what it pushed.
+class ProfilerFrameGuard {
+public:
+    ProfilerFrameGuard() = default;
+
+    // The name is only computed while profiling.
+    template <class GetName>
+    explicit ProfilerFrameGuard(GetName get_name) {
+        if (IsProfilerActive()) [[unlikely]] {
+            Push(get_name());
+        }
+    }
+    ProfilerFrameGuard(const ProfilerFrameGuard&) = delete;
+    ProfilerFrameGuard& operator=(const ProfilerFrameGuard&) = delete;
+    ~ProfilerFrameGuard() {
+        if (pushed_) [[unlikely]] {
+            Pop();
+        }
+    }
+
+    // Must only be called while the guarded frame is on top of the stack.
+    void Replace(std::string_view name) {
+        if (pushed_) {
+            Pop();
+        }
+        if (IsProfilerActive()) {
+            Push(name);
+        }
+    }
+
+private:
+    void Push(std::string_view name);
+    void Pop();
+
+    bool pushed_ = false;
+};
+
+// Samples the shadow stacks of running evaluations on SIGPROF, driven by a timer per evaluating
+// thread that counts the CPU time of that thread, and aggregates them into the folded format of
+// flamegraph.pl. Only one profiler can run at a time. Stopping restores the previous SIGPROF
+// handler, but ignores the signal if the previous action was the default one.
+class Profiler {
+public:
+    explicit Profiler(std::chrono::microseconds interval = std::chrono::milliseconds(1));
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    ~Profiler();
+
+    void Start();
+    void Stop();
+
+    // Every line is "outer;...;inner count".
+    void WriteFolded(std::ostream& out);
+    uint64_t GetDroppedSamples() const;
+
+private:
+    void Drain();
+
+    std::chrono::microseconds interval_;
+    bool running_ = false;
+    std::atomic<bool> stop_draining_ = false;
+    std::thread drainer_;
+    std::mutex mutex_;
+    std::map<std::string, uint64_t> folded_;
+};
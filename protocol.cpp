@@ -0,0 +1,114 @@
+#include "protocol.h"
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+bool ReadExactly(int fd, char* data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t got = read(fd, data + done, size - done);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0) {
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (got == 0) {
+            if (done == 0) {
+                return false;
+            }
+            throw std::runtime_error("Connection closed in the middle of a frame");
+        }
+        done += got;
+    }
+    return true;
+}
+
+void WriteExactly(int fd, const char* data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t written = send(fd, data + done, size - done, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0) {
+            throw std::system_error(errno, std::generic_category(), "send");
+        }
+        done += written;
+    }
+}
+
+}  // namespace
+
+bool ReadFrame(int fd, std::string* payload) {
+    uint32_t size;
+    if (!ReadFrameHeader(fd, &size)) {
+        return false;
+    }
+    payload->resize(size);
+    if (size != 0 && !ReadExactly(fd, payload->data(), size)) {
+        throw std::runtime_error("Connection closed in the middle of a frame");
+    }
+    return true;
+}
+
+bool ReadFrameHeader(int fd, uint32_t* size) {
+    unsigned char header[4];
+    if (!ReadExactly(fd, reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+    *size = (uint32_t{header[0]} << 24) | (uint32_t{header[1]} << 16) |
+            (uint32_t{header[2]} << 8) | uint32_t{header[3]};
+    if (*size > kMaxFrameSize) {
+        throw std::runtime_error("Frame is too large");
+    }
+    return true;
+}
+
+size_t ReadPayload(int fd, char* data, size_t size) {
+    while (true) {
+        ssize_t got = read(fd, data, size);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got < 0) {
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (got == 0) {
+            throw std::runtime_error("Connection closed in the middle of a frame");
+        }
+        return got;
+    }
+}
+
+void WriteFrame(int fd, const std::string& payload) {
+    if (payload.size() > kMaxFrameSize) {
+        throw std::runtime_error("Frame is too large");
+    }
+    uint32_t size = payload.size();
+    std::string frame(4, '\0');
+    frame[0] = static_cast<char>(size >> 24);
+    frame[1] = static_cast<char>(size >> 16);
+    frame[2] = static_cast<char>(size >> 8);
+    frame[3] = static_cast<char>(size);
+    frame += payload;
+    WriteExactly(fd, frame.data(), frame.size());
+}
+
+std::string EncodeResponse(const Response& response) {
+    return static_cast<char>(response.status) + response.text;
+}
+
+Response DecodeResponse(const std::string& payload) {
+    if (payload.empty() ||
+        static_cast<uint8_t>(payload[0]) > static_cast<uint8_t>(ResponseStatus::INTERNAL_ERROR)) {
+        throw std::runtime_error("Malformed response");
+    }
+    return {static_cast<ResponseStatus>(payload[0]), payload.substr(1)};
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+enum class ResponseStatus : uint8_t {
+    OK,
+    SYNTAX_ERROR,
+    RUNTIME_ERROR,
+    NAME_ERROR,
+    LIMIT_ERROR,
+    INTERNAL_ERROR
+};
+
+struct Response {
+    ResponseStatus status;
+    std::string text;
+};
+
+// Every message is a 4-byte big-endian payload length followed by the payload itself.
+// A request payload is the script text, a response payload is the status byte and the result.
+constexpr uint32_t kMaxFrameSize = 64 << 20;
+
+bool ReadFrame(int fd, std::string* payload);
+// Reads only the header of a frame, returns false if the connection is closed before it. The
+// caller reads the payload with ReadPayload then.
+bool ReadFrameHeader(int fd, uint32_t* size);
+// Reads the part of a payload that has arrived, at least one and at most size bytes.
+size_t ReadPayload(int fd, char* data, size_t size);
+void WriteFrame(int fd, const std::string& payload);
+
+std::string EncodeResponse(const Response& response);
+Response DecodeResponse(const std::string& payload);
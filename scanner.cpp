@@ -0,0 +1,166 @@
+#include "scanner.h"
+
+#include <bit>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Every class is a union of (high nibble set) x (low nibble set) products, each product has its
+// own bit, and a byte belongs to a product iff both nibble lookups have the bit set.
+//   0x01 tab, newline     0x02 space            0x04 ! # * - /      0x08 digits
+//   0x10 < = > ?          0x20 A-O, a-o         0x40 P-Z, p-z
+constexpr uint8_t kBlankClasses = 0x03;
+constexpr uint8_t kDigitClasses = 0x08;
+constexpr uint8_t kSymbolClasses = 0x7c;
+
+alignas(16) constexpr uint8_t kLowNibble[16] = {0x4a, 0x6c, 0x68, 0x6c, 0x68, 0x68, 0x68, 0x68,
+                                                0x68, 0x69, 0x65, 0x20, 0x30, 0x34, 0x30, 0x34};
+alignas(16) constexpr uint8_t kHighNibble[16] = {0x01, 0x00, 0x06, 0x18, 0x20, 0x40, 0x20, 0x40,
+                                                 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+void ClassifyScalar(const char* data, size_t block_count, BlockMasks* masks) {
+    for (size_t block = 0; block < block_count; ++block, data += kScanBlockSize) {
+        BlockMasks result{};
+        for (size_t i = 0; i < kScanBlockSize; ++i) {
+            auto c = static_cast<uint8_t>(data[i]);
+            uint8_t classes = kLowNibble[c & 0xf] & kHighNibble[c >> 4];
+            result.blank |= uint64_t{(classes & kBlankClasses) != 0} << i;
+            result.digit |= uint64_t{(classes & kDigitClasses) != 0} << i;
+            result.symbol |= uint64_t{(classes & kSymbolClasses) != 0} << i;
+        }
+        masks[block] = result;
+    }
+}
+
+#if defined(__x86_64__)
+
+// The bits of the bytes whose classes intersect the given ones.
+__attribute__((target("sse4.2"))) uint64_t Select(__m128i classes, uint8_t bits) {
+    __m128i selected = _mm_and_si128(classes, _mm_set1_epi8(bits));
+    return static_cast<uint64_t>(~_mm_movemask_epi8(_mm_cmpeq_epi8(selected, _mm_setzero_si128())) &
+                                 0xffff);
+}
+
+__attribute__((target("avx2"))) uint64_t Select(__m256i classes, uint8_t bits) {
+    __m256i selected = _mm256_and_si256(classes, _mm256_set1_epi8(bits));
+    __m256i outside = _mm256_cmpeq_epi8(selected, _mm256_setzero_si256());
+    return static_cast<uint64_t>(~static_cast<uint32_t>(_mm256_movemask_epi8(outside)));
+}
+
+__attribute__((target("sse4.2"))) void ClassifySse42(const char* data, size_t block_count,
+                                                     BlockMasks* masks) {
+    const __m128i low_table = _mm_load_si128(reinterpret_cast<const __m128i*>(kLowNibble));
+    const __m128i high_table = _mm_load_si128(reinterpret_cast<const __m128i*>(kHighNibble));
+    const __m128i nibble = _mm_set1_epi8(0xf);
+    for (size_t block = 0; block < block_count; ++block, data += kScanBlockSize) {
+        BlockMasks result{};
+        for (size_t i = 0; i < kScanBlockSize; i += 16) {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i low = _mm_shuffle_epi8(low_table, _mm_and_si128(chars, nibble));
+            __m128i high =
+                _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(chars, 4), nibble));
+            __m128i classes = _mm_and_si128(low, high);
+            result.blank |= Select(classes, kBlankClasses) << i;
+            result.digit |= Select(classes, kDigitClasses) << i;
+            result.symbol |= Select(classes, kSymbolClasses) << i;
+        }
+        masks[block] = result;
+    }
+}
+
+__attribute__((target("avx2"))) void ClassifyAvx2(const char* data, size_t block_count,
+                                                  BlockMasks* masks) {
+    const __m256i low_table = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(kLowNibble)));
+    const __m256i high_table = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(kHighNibble)));
+    const __m256i nibble = _mm256_set1_epi8(0xf);
+    for (size_t block = 0; block < block_count; ++block, data += kScanBlockSize) {
+        BlockMasks result{};
+        for (size_t i = 0; i < kScanBlockSize; i += 32) {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(chars, nibble));
+            __m256i high = _mm256_shuffle_epi8(
+                high_table, _mm256_and_si256(_mm256_srli_epi16(chars, 4), nibble));
+            __m256i classes = _mm256_and_si256(low, high);
+            result.blank |= Select(classes, kBlankClasses) << i;
+            result.digit |= Select(classes, kDigitClasses) << i;
+            result.symbol |= Select(classes, kSymbolClasses) << i;
+        }
+        masks[block] = result;
+    }
+}
+
+#endif
+
+using Classifier = void (*)(const char*, size_t, BlockMasks*);
+
+Classifier GetClassifier(ScanPath path) {
+#if defined(__x86_64__)
+    if (path == ScanPath::AVX2) {
+        return ClassifyAvx2;
+    }
+    if (path == ScanPath::SSE42) {
+        return ClassifySse42;
+    }
+#endif
+    return ClassifyScalar;
+}
+
+Classifier ChooseClassifier() {
+    for (ScanPath path : {ScanPath::AVX2, ScanPath::SSE42}) {
+        if (IsScanPathSupported(path)) {
+            return GetClassifier(path);
+        }
+    }
+    return ClassifyScalar;
+}
+
+}  // namespace
+
+void ClassifyBlocks(const char* data, size_t block_count, BlockMasks* masks) {
+    static const Classifier classifier = ChooseClassifier();
+    classifier(data, block_count, masks);
+}
+
+bool IsScanPathSupported(ScanPath path) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (path == ScanPath::AVX2) {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (path == ScanPath::SSE42) {
+        return __builtin_cpu_supports("sse4.2");
+    }
+#endif
+    return path == ScanPath::SCALAR;
+}
+
+void ClassifyBlocks(const char* data, size_t block_count, BlockMasks* masks, ScanPath path) {
+    GetClassifier(path)(data, block_count, masks);
+}
+
+bool IsSymbolChar(char c) {
+    auto byte = static_cast<uint8_t>(c);
+    return (kLowNibble[byte & 0xf] & kHighNibble[byte >> 4] & kSymbolClasses) != 0;
+}
+
+uint32_t ParseEightDigits(const char* data) {
+    if constexpr (std::endian::native == std::endian::little) {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        value = (value & 0x0f0f0f0f0f0f0f0f) * 2561 >> 8;
+        value = (value & 0x00ff00ff00ff00ff) * 6553601 >> 16;
+        return static_cast<uint32_t>((value & 0x0000ffff0000ffff) * 42949672960001 >> 32);
+    }
+    uint32_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value = value * 10 + (data[i] - '0');
+    }
+    return value;
+}
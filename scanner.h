@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Character classes of 64 consecutive bytes, bit i describing byte i.
+struct BlockMasks {
+    uint64_t blank;
+    uint64_t digit;
+    // Characters that may continue a symbol, digits included.
+    uint64_t symbol;
+};
+
+inline constexpr size_t kScanBlockSize = 64;
+
+// Classifies block_count * kScanBlockSize bytes of data into masks[0], ..., masks[block_count - 1]
+// using the widest vector instructions the CPU supports.
+void ClassifyBlocks(const char* data, size_t block_count, BlockMasks* masks);
+
+// The implementations ClassifyBlocks chooses from, all giving the same masks.
+enum class ScanPath { SCALAR, SSE42, AVX2 };
+
+bool IsScanPathSupported(ScanPath path);
+// Like ClassifyBlocks, with the given implementation, which has to be supported.
+void ClassifyBlocks(const char* data, size_t block_count, BlockMasks* masks, ScanPath path);
+
+// Whether c may continue a symbol, the classification of a single byte by BlockMasks::symbol.
+bool IsSymbolChar(char c);
+
+// The value of the 8 decimal digits at data.
+uint32_t ParseEightDigits(const char* data);
@@ -1,11 +1,133 @@
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <dlfcn.h>
 
 #include "builtin_functions.h"
+#include "compiler.h"
 #include "error.h"
+#include "evaluation_stack.h"
+#include "slab_allocator.h"
 #include "parser.h"
+#include "profiler.h"
 #include "scheme.h"
 #include "tokenizer.h"
 
+namespace {
+
+class RunHeapStatsGuard {
+public:
+    explicit RunHeapStatsGuard(HeapStats* result) : result_(result) {
+        if (IsHeapStatsEnabled()) {
+            before_ = GetHeapStats();
+        }
+    }
+    RunHeapStatsGuard(const RunHeapStatsGuard&) = delete;
+    RunHeapStatsGuard& operator=(const RunHeapStatsGuard&) = delete;
+    ~RunHeapStatsGuard() {
+        *result_ = IsHeapStatsEnabled() ? GetHeapStats() - before_ : HeapStats{};
+    }
+
+private:
+    HeapStats* result_;
+    HeapStats before_;
+};
+
+class TailCallMarker : public Object {};
+
+const std::shared_ptr<Object>& GetTailCallMarker() {
+    static const std::shared_ptr<Object> marker = std::make_shared<TailCallMarker>();
+    return marker;
+}
+
+class RaisedMarker : public Object {};
+
+const std::shared_ptr<Object>& GetRaisedMarker() {
+    static const std::shared_ptr<Object> marker = std::make_shared<RaisedMarker>();
+    return marker;
+}
+
+std::string_view GetFrameName(const std::shared_ptr<Object>& head) {
+    if (Is<Symbol>(head)) {
+        return As<Symbol>(head)->GetName();
+    }
+    return "<anonymous>";
+}
+
+// Ends a list or record in ToString, taking the objects it put on the path off again.
+struct CloseCompound {
+    const char* text;
+    size_t path_size;
+};
+
+// Prints anything but lists and records.
+std::string AtomToString(const std::shared_ptr<Object>& obj) {
+    if (obj == nullptr) {
+        return "()";
+    }
+    if (Is<Number>(obj)) {
+        return std::to_string(As<Number>(obj)->GetValue());
+    }
+    if (Is<Boolean>(obj)) {
+        return As<Boolean>(obj)->GetValue() ? "#t" : "#f";
+    }
+    if (Is<Symbol>(obj)) {
+        return As<Symbol>(obj)->GetName();
+    }
+    if (Is<String>(obj)) {
+        std::string ans = "\"";
+        for (char c : As<String>(obj)->GetValue()) {
+            if (c == '\n') {
+                ans += "\\n";
+            } else if (c == '\t') {
+                ans += "\\t";
+            } else {
+                if (c == '"' || c == '\\') {
+                    ans += '\\';
+                }
+                ans += c;
+            }
+        }
+        return ans + "\"";
+    }
+    if (Is<ForeignBuffer>(obj)) {
+        return "#<buffer>";
+    }
+    if (Is<Promise>(obj)) {
+        return "#<promise>";
+    }
+    if (Is<RecordType>(obj)) {
+        return "#<record-type " + As<RecordType>(obj)->GetName() + ">";
+    }
+    if (Is<ErrorObject>(obj)) {
+        return "#<error " + As<ErrorObject>(obj)->GetMessage() + ">";
+    }
+    throw RuntimeError("Function doesn't return any value by themselves");
+}
+
+}  // namespace
+
+PendingState& GetPendingState() {
+    static thread_local PendingState state;
+    return state;
+}
+
+std::shared_ptr<Object> ThrowIfRaised(std::shared_ptr<Object> result) {
+    if (!Interpreter::IsRaised(result)) {
+        return result;
+    }
+    auto error = Interpreter::TakeRaised();
+    if (Is<ErrorObject>(error)) {
+        As<ErrorObject>(error)->Throw();
+    }
+    throw RuntimeError("Uncaught exception : " + Interpreter::ToString(error));
+}
+
 Scope::Scope(std::initializer_list<std::pair<std::string, std::shared_ptr<Object>>> list) {
     for (const auto& [name, obj] : list) {
         Define(name, obj);
@@ -16,30 +138,333 @@ Scope::Scope(std::shared_ptr<Scope> scope) : parent_(scope) {
 }
 
 std::shared_ptr<Object> Scope::Get(const std::string& name) {
-    auto it = defined_objects_.find(name);
-    if (it == defined_objects_.end()) {
-        if (parent_ == nullptr) {
-            throw NameError("Unknown variable : " + name);
+    std::shared_ptr<Object> obj;
+    if (!Lookup(name, &obj)) {
+        return RaiseError(ErrorKind::NAME, "Unknown variable : " + name);
+    }
+    return obj;
+}
+
+bool Scope::Lookup(const std::string& name, std::shared_ptr<Object>* obj) const {
+    const ScopeOverlay* overlay = GetExecutionContext().overlay;
+    for (const Scope* scope = this; scope != nullptr; scope = scope->parent_.get()) {
+        if (auto found = scope->Find(name)) {
+            if (scope->frozen_ && overlay != nullptr) {
+                if (auto assigned = overlay->Find(scope, name)) {
+                    found = assigned;
+                }
+            }
+            *obj = *found;
+            return true;
         }
-        return parent_->Get(name);
     }
-    return it->second;
+    return overlay != nullptr && overlay->top != nullptr && overlay->top != this &&
+           overlay->top->Lookup(name, obj);
 }
 
-void Scope::Define(const std::string& name, std::shared_ptr<Object> obj) {
-    defined_objects_[name] = obj;
+std::shared_ptr<Object> Scope::Define(const std::string& name, std::shared_ptr<Object> obj) {
+    if (frozen_) {
+        return RaiseError(ErrorKind::RUNTIME, "Can't define " + name + " in a frozen scope");
+    }
+    ScopeOverlay* overlay = GetExecutionContext().overlay;
+    if (overlay != nullptr && overlay->top == this && Find(name) == nullptr) {
+        // The top-level scope stands in for the frozen ones below it, so a definition replaces
+        // their binding for the closures made in them too.
+        for (Scope* scope = parent_.get(); scope != nullptr; scope = scope->parent_.get()) {
+            if (scope->Find(name) == nullptr) {
+                continue;
+            }
+            if (scope->frozen_) {
+                overlay->bindings[scope][name] = std::move(obj);
+                return nullptr;
+            }
+            break;
+        }
+    }
+    Bind(name, std::move(obj));
+    return nullptr;
 }
 
-void Scope::Set(const std::string& name, std::shared_ptr<Object> obj) {
+std::shared_ptr<Object> Scope::Set(const std::string& name, std::shared_ptr<Object> obj) {
+    ScopeOverlay* overlay = GetExecutionContext().overlay;
+    Scope* shadow = nullptr;
+    for (Scope* scope = this; scope != nullptr; scope = scope->parent_.get()) {
+        auto found = scope->Find(name);
+        if (found == nullptr) {
+            if (!scope->frozen_) {
+                shadow = scope;
+            }
+            continue;
+        }
+        if (!scope->frozen_) {
+            *found = std::move(obj);
+        } else if (overlay != nullptr) {
+            overlay->bindings[scope][name] = std::move(obj);
+        } else if (shadow != nullptr) {
+            shadow->Bind(name, std::move(obj));
+        } else {
+            return RaiseError(ErrorKind::RUNTIME, "Can't set " + name + " in a frozen scope");
+        }
+        return nullptr;
+    }
+    if (overlay != nullptr && overlay->top != nullptr && overlay->top != this) {
+        return overlay->top->Set(name, std::move(obj));
+    }
+    return RaiseError(ErrorKind::NAME, "Unknown variable : " + name);
+}
+
+void Scope::Reset(std::shared_ptr<Scope> parent) {
+    for (size_t i = 0; i < inline_size_; ++i) {
+        inline_[i].second = nullptr;
+    }
+    inline_size_ = 0;
+    defined_objects_.clear();
+    parent_ = std::move(parent);
+    frozen_ = false;
+}
+
+void Scope::Freeze() {
+    frozen_ = true;
+}
+
+bool Scope::IsFrozen() const {
+    return frozen_;
+}
+
+bool Scope::IsEmpty() const {
+    return inline_size_ == 0;
+}
+
+std::shared_ptr<Scope> Scope::GetParent() const {
+    return parent_;
+}
+
+std::shared_ptr<Object>* Scope::Find(const std::string& name) {
+    return const_cast<std::shared_ptr<Object>*>(std::as_const(*this).Find(name));
+}
+
+const std::shared_ptr<Object>* Scope::Find(const std::string& name) const {
+    for (size_t i = 0; i < inline_size_; ++i) {
+        if (inline_[i].first == name) {
+            return &inline_[i].second;
+        }
+    }
+    if (defined_objects_.empty()) {
+        return nullptr;
+    }
     auto it = defined_objects_.find(name);
-    if (it == defined_objects_.end()) {
-        if (parent_ == nullptr) {
-            throw NameError("Unknown variable : " + name);
+    return it == defined_objects_.end() ? nullptr : &it->second;
+}
+
+void Scope::Bind(const std::string& name, std::shared_ptr<Object> obj) {
+    if (auto found = Find(name)) {
+        *found = std::move(obj);
+    } else if (inline_size_ < kInlineBindings) {
+        // Assigned in place, a reused frame keeps the storage of its names.
+        inline_[inline_size_].first = name;
+        inline_[inline_size_++].second = std::move(obj);
+    } else {
+        defined_objects_.emplace(name, std::move(obj));
+    }
+}
+
+const std::shared_ptr<Object>* ScopeOverlay::Find(const Scope* scope,
+                                                  const std::string& name) const {
+    auto find = [&](const ScopeBindings& assigned) -> const std::shared_ptr<Object>* {
+        auto of_scope = assigned.find(scope);
+        if (of_scope == assigned.end()) {
+            return nullptr;
+        }
+        auto it = of_scope->second.find(name);
+        return it == of_scope->second.end() ? nullptr : &it->second;
+    };
+    if (!bindings.empty()) {
+        if (auto found = find(bindings)) {
+            return found;
         }
-        parent_->Set(name, obj);
+    }
+    for (const Layer* layer = layers.get(); layer != nullptr; layer = layer->below.get()) {
+        if (auto found = find(layer->bindings)) {
+            return found;
+        }
+    }
+    return nullptr;
+}
+
+void ScopeOverlay::Share() {
+    if (bindings.empty()) {
         return;
     }
-    it->second = obj;
+    auto layer = std::make_shared<Layer>();
+    layer->bindings = std::move(bindings);
+    bindings.clear();
+    for (const auto& [scope, assigned] : layer->bindings) {
+        layer->size += assigned.size();
+    }
+    for (; layers != nullptr && layers->size <= layer->size; layers = layers->below) {
+        for (const auto& [scope, assigned] : layers->bindings) {
+            auto& merged = layer->bindings[scope];
+            size_t size = merged.size();
+            merged.insert(assigned.begin(), assigned.end());
+            layer->size += merged.size() - size;
+        }
+    }
+    layer->below = std::move(layers);
+    layers = std::move(layer);
+}
+
+void Freezer::Add(Scope* scope) {
+    scopes_.push_back(scope);
+}
+
+void Freezer::Add(Object* obj) {
+    objects_.push_back(obj);
+}
+
+void Freezer::Run() {
+    while (!scopes_.empty() || !objects_.empty()) {
+        if (!scopes_.empty()) {
+            Scope* scope = scopes_.back();
+            scopes_.pop_back();
+            if (scope == nullptr || scope->frozen_) {
+                continue;
+            }
+            scope->frozen_ = true;
+            for (size_t i = 0; i < scope->inline_size_; ++i) {
+                Add(scope->inline_[i].second.get());
+            }
+            for (const auto& [name, value] : scope->defined_objects_) {
+                Add(value.get());
+            }
+            Add(scope->parent_.get());
+            continue;
+        }
+        Object* obj = objects_.back();
+        objects_.pop_back();
+        if (auto cell = dynamic_cast<Cell*>(obj)) {
+            if (!cell->IsFrozen()) {
+                cell->Freeze();
+                Add(cell->GetFirst().get());
+                Add(cell->PeekSecond());
+            }
+        } else if (auto record = dynamic_cast<Record*>(obj)) {
+            if (!record->IsFrozen()) {
+                record->Freeze();
+                for (size_t i = 0; i < record->GetType()->GetFields().size(); ++i) {
+                    Add(record->Get(i).get());
+                }
+            }
+        } else if (auto lambda = dynamic_cast<Lambda*>(obj)) {
+            Add(lambda->parent_.get());
+            for (const auto& command : lambda->code_->GetCommands()) {
+                Add(command.get());
+            }
+        } else if (auto promise = dynamic_cast<Promise*>(obj)) {
+            std::lock_guard lock(promise->mutex_);
+            if (!promise->frozen_.exchange(true)) {
+                Add(promise->value_.get());
+                Add(promise->expression_.get());
+                Add(promise->scope_.get());
+            }
+        }
+    }
+}
+
+std::shared_ptr<Scope> NewFrame(std::shared_ptr<Scope> parent) {
+    if (IsHeapStatsEnabled()) [[unlikely]] {
+        return New<Scope>(std::move(parent));
+    }
+    GetExecutionContext().ChargeAllocation(sizeof(Scope));
+    return std::allocate_shared<Scope>(SlabAllocator<Scope, SlabArena::FRAMES>(),
+                                       std::move(parent));
+}
+
+namespace {
+
+using FrameAllocator = SlabAllocator<Scope, SlabArena::FRAMES>;
+
+void DestroyFrame(Scope* scope) {
+    std::destroy_at(scope);
+    FrameAllocator().deallocate(scope, 1);
+}
+
+enum class PoolState { NONE, ALIVE, DESTROYED };
+
+thread_local PoolState frame_pool_state = PoolState::NONE;
+
+// Emptied scopes of finished calls, handed to the next calls on the thread.
+class FramePool {
+public:
+    static constexpr size_t kMaxFrames = 256;
+
+    FramePool() {
+        frame_pool_state = PoolState::ALIVE;
+    }
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+    ~FramePool() {
+        frame_pool_state = PoolState::DESTROYED;
+        for (Scope* scope : frames_) {
+            DestroyFrame(scope);
+        }
+    }
+
+    Scope* Take(std::shared_ptr<Scope> parent) {
+        if (frames_.empty()) {
+            Scope* scope = FrameAllocator().allocate(1);
+            return std::construct_at(scope, std::move(parent));
+        }
+        Scope* scope = frames_.back();
+        frames_.pop_back();
+        scope->Reset(std::move(parent));
+        return scope;
+    }
+
+    void Give(Scope* scope) {
+        // Frees the bindings now, which may give back more frames.
+        scope->Reset(nullptr);
+        if (frames_.size() < kMaxFrames) {
+            frames_.push_back(scope);
+        } else {
+            DestroyFrame(scope);
+        }
+    }
+
+private:
+    std::vector<Scope*> frames_;
+};
+
+// Null once the pool of the thread is destroyed, frames freed by later thread-exit destructors
+// are destroyed then.
+FramePool* GetFramePool() {
+    if (frame_pool_state == PoolState::DESTROYED) {
+        return nullptr;
+    }
+    thread_local FramePool pool;
+    return &pool;
+}
+
+// Runs when the last reference to a reusable frame is dropped, on whatever thread that is.
+struct ReturnFrame {
+    void operator()(Scope* scope) const {
+        if (auto pool = GetFramePool()) {
+            pool->Give(scope);
+        } else {
+            DestroyFrame(scope);
+        }
+    }
+};
+
+}  // namespace
+
+std::shared_ptr<Scope> NewReusableFrame(std::shared_ptr<Scope> parent) {
+    FramePool* pool = GetFramePool();
+    if (IsHeapStatsEnabled() || pool == nullptr) [[unlikely]] {
+        return NewFrame(std::move(parent));
+    }
+    GetExecutionContext().ChargeAllocation(sizeof(Scope));
+    return std::shared_ptr<Scope>(pool->Take(std::move(parent)), ReturnFrame{},
+                                  FrameAllocator());
 }
 
 std::shared_ptr<Scope> GetGlobalScope() {
@@ -68,6 +493,33 @@ std::shared_ptr<Scope> GetGlobalScope() {
             {"list", std::make_shared<MakeList>()},
             {"list-ref", std::make_shared<GetListElement>()},
             {"list-tail", std::make_shared<GetListTail>()},
+            {"length", std::make_shared<Length>()},
+            {"append", std::make_shared<Append>()},
+            {"reverse", std::make_shared<Reverse>()},
+            {"map", std::make_shared<Map>()},
+            {"filter", std::make_shared<Filter>()},
+            {"fold-left", std::make_shared<FoldLeft>()},
+            {"fold-right", std::make_shared<FoldRight>()},
+            {"for-each", std::make_shared<ForEach>()},
+            {"member", std::make_shared<Member>()},
+            {"assoc", std::make_shared<Assoc>()},
+            {"sort", std::make_shared<Sort>()},
+            {"delay", std::make_shared<Delay>()},
+            {"make-promise", std::make_shared<MakePromise>()},
+            {"force", std::make_shared<Force>()},
+            {"promise?", std::make_shared<IsPromise>()},
+            {"cons-stream", std::make_shared<ConsStream>()},
+            {"stream-car", std::make_shared<StreamCar>()},
+            {"stream-cdr", std::make_shared<StreamCdr>()},
+            {"stream-pair?", std::make_shared<IsStreamPair>()},
+            {"stream-null?", std::make_shared<IsStreamNull>()},
+            {"stream-map", std::make_shared<StreamMap>()},
+            {"stream-filter", std::make_shared<StreamFilter>()},
+            {"stream-take", std::make_shared<StreamTake>()},
+            {"stream-fold", std::make_shared<StreamFold>()},
+            {"stream->list", std::make_shared<StreamToList>()},
+            {"read-stream", std::make_shared<ReadStream>()},
+            {"define-record-type", std::make_shared<DefineRecordType>()},
             {"boolean?", std::make_shared<IsBoolean>()},
             {"not", std::make_shared<LogicalNot>()},
             {"and", std::make_shared<LogicalAnd>()},
@@ -75,69 +527,371 @@ std::shared_ptr<Scope> GetGlobalScope() {
             {"if", std::make_shared<If>()},
             {"define", std::make_shared<Define>()},
             {"set!", std::make_shared<Set>()},
+            {"let", std::make_shared<Let>()},
+            {"let*", std::make_shared<LetStar>()},
+            {"letrec", std::make_shared<LetRec>()},
+            {"do", std::make_shared<Do>()},
+            {"cond", std::make_shared<Cond>()},
+            {"begin", std::make_shared<Begin>()},
             {"set-car!", std::make_shared<SetFront>()},
             {"set-cdr!", std::make_shared<SetTail>()},
             {"lambda", std::make_shared<MakeLambda>()},
-            {"symbol?", std::make_shared<IsSymbol>()}});
+            {"symbol?", std::make_shared<IsSymbol>()},
+            {"write-binary", std::make_shared<WriteBinaryFile>()},
+            {"read-binary", std::make_shared<ReadBinaryFile>()},
+            {"heap-stats", std::make_shared<HeapStatistics>()},
+            {"slab-stats", std::make_shared<SlabStatistics>()},
+            {"buffer?", std::make_shared<IsBuffer>()},
+            {"buffer-length", std::make_shared<BufferLength>()},
+            {"buffer-ref", std::make_shared<BufferRef>()},
+            {"buffer->list", std::make_shared<BufferToList>()},
+            {"buffer-for-each", std::make_shared<BufferForEach>()},
+            {"guard", std::make_shared<Guard>()},
+            {"with-exception-handler", std::make_shared<WithExceptionHandler>()},
+            {"raise", std::make_shared<RaiseObject>()},
+            {"raise-continuable", std::make_shared<RaiseContinuable>()},
+            {"error", std::make_shared<MakeError>()},
+            {"error-object?", std::make_shared<IsErrorObject>()},
+            {"error-object-message", std::make_shared<ErrorObjectMessage>()},
+            {"error-object-irritants", std::make_shared<ErrorObjectIrritants>()}});
+    [[maybe_unused]] static const bool frozen = (global_scope->Freeze(), true);
     return global_scope;
 }
 
+PreparedExpression::PreparedExpression(std::vector<std::shared_ptr<Object>> forms)
+    : forms_(std::move(forms)) {
+}
+
+const std::vector<std::shared_ptr<Object>>& PreparedExpression::GetForms() const {
+    return forms_;
+}
+
+Interpreter::Interpreter() : Interpreter(GetGlobalScope()) {
+}
+
+Interpreter::Interpreter(std::shared_ptr<Scope> parent) : scope_(std::make_shared<Scope>(parent)) {
+    overlay_.top = scope_.get();
+}
+
 std::string Interpreter::Run(const std::string& str) {
+    ExecutionContextGuard guard(limits_, cancellation_.get(), &overlay_);
+    RunHeapStatsGuard heap_stats_guard(&last_run_heap_stats_);
     std::stringstream ss{str};
     Tokenizer tokenizer{&ss};
     std::shared_ptr<Object> result = Read(&tokenizer);
     if (!tokenizer.IsEnd()) {
         throw SyntaxError("Input isn't one whole object");
     }
-    return ToString(Calculate(result, scope_));
+    std::string output;
+    RunOnEvaluationStack(limits_.max_stack_bytes,
+                         [&] { output = ToString(ThrowIfRaised(Calculate(result, scope_))); });
+    return output;
 }
 
-std::shared_ptr<Object> Interpreter::Calculate(std::shared_ptr<Object> obj,
-                                               std::shared_ptr<Scope> scope) {
-    if (obj == nullptr) {
-        throw RuntimeError("List doesn't return any value");
-    }
-    if (Is<Number>(obj) || Is<Boolean>(obj)) {
-        return obj;
+std::string Interpreter::RunScript(const std::string& source) {
+    ExecutionContextGuard guard(limits_, cancellation_.get(), &overlay_);
+    RunHeapStatsGuard heap_stats_guard(&last_run_heap_stats_);
+    std::stringstream ss{source};
+    Tokenizer tokenizer{&ss};
+    std::string output;
+    RunOnEvaluationStack(limits_.max_stack_bytes, [&] {
+        std::shared_ptr<Object> result = nullptr;
+        while (!tokenizer.IsEnd()) {
+            result = ThrowIfRaised(Calculate(Read(&tokenizer), scope_));
+        }
+        output = ToString(result);
+    });
+    return output;
+}
+
+std::string Interpreter::RunStream(const std::function<bool(std::string*)>& next_chunk) {
+    ExecutionContextGuard guard(limits_, cancellation_.get(), &overlay_);
+    RunHeapStatsGuard heap_stats_guard(&last_run_heap_stats_);
+    PushParser parser;
+    std::string output;
+    RunOnEvaluationStack(limits_.max_stack_bytes, [&] {
+        std::shared_ptr<Object> result = nullptr;
+        std::string chunk;
+        for (bool more = true; more;) {
+            more = next_chunk(&chunk);
+            if (more) {
+                parser.Feed(chunk);
+            } else {
+                parser.Finish();
+            }
+            std::shared_ptr<Object> form;
+            while (parser.Poll(&form)) {
+                result = ThrowIfRaised(Calculate(std::move(form), scope_));
+            }
+        }
+        output = ToString(result);
+    });
+    return output;
+}
+
+std::shared_ptr<Scope> Interpreter::GetScope() const {
+    return scope_;
+}
+
+void Interpreter::LoadModule(const std::string& path) {
+    // Never closed, the functions of the module may be referenced from any scope.
+    void* library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (library == nullptr) {
+        throw RuntimeError("Can't load module " + path + " : " + dlerror());
     }
-    if (Is<Symbol>(obj)) {
-        return scope->Get(As<Symbol>(obj)->GetName());
+    auto init = reinterpret_cast<ModuleInit>(dlsym(library, kModuleInitName));
+    if (init == nullptr) {
+        throw RuntimeError(path + " isn't a compiled module");
     }
-    if (Is<Cell>(obj)) {
-        auto func = Calculate(As<Cell>(obj)->GetFirst(), scope);
-        if (!Is<Function>(func)) {
-            throw RuntimeError("List doesn't return any value");
+    ExecutionContextGuard guard(limits_, cancellation_.get(), &overlay_);
+    RunHeapStatsGuard heap_stats_guard(&last_run_heap_stats_);
+    RunOnEvaluationStack(limits_.max_stack_bytes, [&] { init(scope_); });
+}
+
+Interpreter Interpreter::Fork() {
+    Freezer freezer;
+    for (const auto& [scope, assigned] : overlay_.bindings) {
+        for (const auto& [name, value] : assigned) {
+            freezer.Add(value.get());
         }
-        return As<Function>(func)->Invoke(As<Cell>(obj), scope);
     }
-    throw RuntimeError("Unknown object");
+    std::shared_ptr<Scope> shared;
+    if (scope_->IsEmpty() && scope_->GetParent() != nullptr && scope_->GetParent()->IsFrozen()) {
+        shared = scope_->GetParent();
+    } else {
+        freezer.Add(scope_.get());
+        shared = std::exchange(scope_, std::make_shared<Scope>(scope_));
+        overlay_.top = scope_.get();
+    }
+    freezer.Run();
+    overlay_.Share();
+    Interpreter child(std::move(shared));
+    child.overlay_.layers = overlay_.layers;
+    child.limits_ = limits_;
+    return child;
 }
 
-std::string Interpreter::ToString(std::shared_ptr<Object> obj) {
-    if (obj == nullptr) {
-        return "()";
+std::shared_ptr<const PreparedExpression> Interpreter::Prepare(const std::string& source) {
+    std::stringstream ss{source};
+    Tokenizer tokenizer{&ss};
+    std::vector<std::shared_ptr<Object>> forms;
+    Freezer freezer;
+    while (!tokenizer.IsEnd()) {
+        forms.emplace_back(Read(&tokenizer));
+        PrepareForm(forms.back());
+        freezer.Add(forms.back().get());
     }
-    if (Is<Number>(obj)) {
-        return std::to_string(As<Number>(obj)->GetValue());
+    freezer.Run();
+    return std::make_shared<PreparedExpression>(std::move(forms));
+}
+
+std::shared_ptr<Object> Interpreter::Execute(const PreparedExpression& expression,
+                                             const Bindings& bindings) {
+    ExecutionContextGuard guard(limits_, cancellation_.get(), &overlay_);
+    RunHeapStatsGuard heap_stats_guard(&last_run_heap_stats_);
+    auto scope = std::make_shared<Scope>(scope_);
+    for (const auto& [name, value] : bindings) {
+        scope->Define(name, value);
     }
-    if (Is<Boolean>(obj)) {
-        return As<Boolean>(obj)->GetValue() ? "#t" : "#f";
+    std::shared_ptr<Object> result = nullptr;
+    RunOnEvaluationStack(limits_.max_stack_bytes, [&] {
+        for (const auto& form : expression.GetForms()) {
+            result = ThrowIfRaised(Calculate(form, scope));
+        }
+    });
+    return result;
+}
+
+void Interpreter::SetLimits(const Limits& limits) {
+    limits_ = limits;
+}
+
+std::shared_ptr<CancellationHandle> Interpreter::GetCancellationHandle() const {
+    return cancellation_;
+}
+
+const HeapStats& Interpreter::GetLastRunHeapStats() const {
+    return last_run_heap_stats_;
+}
+
+std::shared_ptr<Object> Interpreter::Calculate(std::shared_ptr<Object> obj,
+                                               std::shared_ptr<Scope> scope) {
+    ExecutionContext& context = GetExecutionContext();
+    const char* frame = static_cast<const char*>(__builtin_frame_address(0));
+    if (!context.HasStackFor(frame)) {
+        return RaiseError(ErrorKind::RUNTIME, "Evaluation stack overflow");
     }
-    if (Is<Symbol>(obj)) {
-        return As<Symbol>(obj)->GetName();
+    DepthGuard depth_guard(context);
+    // A lambda reached through a tail call keeps a frame for the rest of the loop,
+    // so its body shows up under its name.
+    ProfilerFrameGuard lambda_frame;
+    std::shared_ptr<Object> lambda_name;
+    while (true) {
+        if (obj == nullptr) {
+            return RaiseError(ErrorKind::RUNTIME, "List doesn't return any value");
+        }
+        context.ConsumeStep();
+        if (Is<Symbol>(obj)) {
+            const std::string& name = As<Symbol>(obj)->GetName();
+            std::shared_ptr<Object> value;
+            if (!scope->Lookup(name, &value)) {
+                return RaiseError(ErrorKind::NAME, "Unknown variable : " + name);
+            }
+            return value;
+        }
+        if (!Is<Cell>(obj)) {
+            return obj;
+        }
+        auto head = As<Cell>(obj)->GetFirst();
+        std::shared_ptr<Object> func;
+        std::shared_ptr<Object> result;
+        {
+            ProfilerFrameGuard frame([&head] { return GetFrameName(head); });
+            func = Calculate(head, scope);
+            if (IsRaised(func)) {
+                return func;
+            }
+            if (!Is<Function>(func)) {
+                return RaiseError(ErrorKind::RUNTIME, "List doesn't return any value");
+            }
+            result = As<Function>(func)->Invoke(As<Cell>(obj), scope);
+        }
+        if (result != GetTailCallMarker()) {
+            return result;
+        }
+        if (IsProfilerActive() && Is<Lambda>(func)) [[unlikely]] {
+            lambda_name = head;
+            lambda_frame.Replace(GetFrameName(lambda_name));
+        }
+        PendingState& pending = GetPendingState();
+        obj = std::move(pending.tail_call);
+        scope = std::move(pending.tail_call_scope);
     }
-    if (Is<Cell>(obj)) {
-        std::vector<std::shared_ptr<Object>> list{CellToVector(As<Cell>(obj))};
-        std::string ans = "(";
-        for (size_t i = 0; i + 1 != list.size(); ++i) {
-            ans += ToString(list[i]) + " ";
+}
+
+std::shared_ptr<Object> Interpreter::Raise(std::shared_ptr<Object> obj) {
+    GetPendingState().error = std::move(obj);
+    return GetRaisedMarker();
+}
+
+bool Interpreter::IsRaised(const std::shared_ptr<Object>& obj) {
+    return obj == GetRaisedMarker();
+}
+
+std::shared_ptr<Object> Interpreter::TakeRaised() {
+    return std::move(GetPendingState().error);
+}
+
+std::shared_ptr<Object> Interpreter::TailCall(std::shared_ptr<Object> obj,
+                                              std::shared_ptr<Scope> scope) {
+    PendingState& pending = GetPendingState();
+    pending.tail_call = std::move(obj);
+    pending.tail_call_scope = std::move(scope);
+    return GetTailCallMarker();
+}
+
+std::string Interpreter::ToString(std::shared_ptr<Object> obj) {
+    std::string ans;
+    // What is left to print, last first: objects and the separators and closing brackets of the
+    // lists and records around them. Nesting is only bounded by memory.
+    std::vector<std::variant<std::shared_ptr<Object>, const char*, CloseCompound>> pending;
+    // The cells and records being printed. One met again refers back to itself and is printed as
+    // #<cycle> instead.
+    std::vector<const Object*> path;
+    std::unordered_set<const Object*> on_path;
+    pending.emplace_back(std::move(obj));
+    while (!pending.empty()) {
+        auto next = std::move(pending.back());
+        pending.pop_back();
+        if (auto text = std::get_if<const char*>(&next)) {
+            ans += *text;
+            continue;
+        }
+        if (auto close = std::get_if<CloseCompound>(&next)) {
+            ans += close->text;
+            for (; path.size() > close->path_size; path.pop_back()) {
+                on_path.erase(path.back());
+            }
+            continue;
         }
-        if (list.back() == nullptr) {
-            ans.back() = ')';
+        obj = std::get<std::shared_ptr<Object>>(std::move(next));
+        if (!on_path.empty() && on_path.contains(obj.get())) {
+            ans += "#<cycle>";
+        } else if (Is<Cell>(obj)) {
+            ans += '(';
+            pending.emplace_back(CloseCompound{")", path.size()});
+            Cell* head = As<Cell>(obj).get();
+            std::vector<std::shared_ptr<Object>> elements;
+            const char* tail_text = nullptr;
+            std::shared_ptr<Object> tail;
+            bool has_compound = false;
+            bool is_circular = false;
+            // A cdr chain that runs into itself is found by a second pointer at half the speed.
+            Cell* slow = head;
+            bool move_slow = false;
+            for (Cell* cell = head;; cell = cell->GetNextCell()) {
+                elements.push_back(cell->GetFirst());
+                has_compound = has_compound || Is<Cell>(elements.back()) ||
+                               Is<Record>(elements.back());
+                Cell* next_cell = cell->GetNextCell();
+                if (next_cell == nullptr) {
+                    tail = cell->GetSecond();
+                    tail_text = tail == nullptr ? nullptr : " . ";
+                    break;
+                }
+                if (!on_path.empty() && on_path.contains(next_cell)) {
+                    tail_text = " . #<cycle>";
+                    break;
+                }
+                slow = move_slow ? slow->GetNextCell() : slow;
+                move_slow = !move_slow;
+                if (next_cell == slow) {
+                    is_circular = true;
+                    break;
+                }
+            }
+            // Only a list with lists or records in it, or one running into itself, can be met
+            // again while it is printed, so only their cells go on the path.
+            if (has_compound || is_circular) {
+                if (is_circular) {
+                    elements.clear();
+                    tail_text = " . #<cycle>";
+                }
+                Cell* cell = head;
+                for (size_t i = 0; i < elements.size(); ++i, cell = cell->GetNextCell()) {
+                    path.push_back(cell);
+                    on_path.insert(cell);
+                }
+                for (; is_circular && !on_path.contains(cell); cell = cell->GetNextCell()) {
+                    path.push_back(cell);
+                    on_path.insert(cell);
+                    elements.push_back(cell->GetFirst());
+                }
+            }
+            if (tail_text != nullptr) {
+                if (tail != nullptr) {
+                    pending.emplace_back(std::move(tail));
+                }
+                pending.emplace_back(tail_text);
+            }
+            for (size_t i = elements.size(); i-- > 0;) {
+                pending.emplace_back(std::move(elements[i]));
+                if (i != 0) {
+                    pending.emplace_back(" ");
+                }
+            }
+        } else if (auto record = As<Record>(obj)) {
+            ans += "#<record " + record->GetType()->GetName();
+            pending.emplace_back(CloseCompound{">", path.size()});
+            path.push_back(record.get());
+            on_path.insert(record.get());
+            for (size_t i = record->GetType()->GetFields().size(); i-- > 0;) {
+                pending.emplace_back(record->Get(i));
+                pending.emplace_back(" ");
+            }
         } else {
-            ans += ". " + ToString(list.back()) + ")";
+            ans += AtomToString(obj);
         }
-        return ans;
     }
-    throw RuntimeError("Function doesn't return any value by themselves");
+    return ans;
 }
\ No newline at end of file
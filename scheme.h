@@ -1,9 +1,13 @@
 #pragma once
 
+#include <array>
+#include <functional>
 #include <initializer_list>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "context.h"
 #include "object.h"
 
 class Object;
@@ -13,26 +17,189 @@ public:
     Scope(std::initializer_list<std::pair<std::string, std::shared_ptr<Object>>> list);
     explicit Scope(std::shared_ptr<Scope> scope);
 
+    // Get, Define and Set return the raised error if they fail, Define and Set null otherwise.
     std::shared_ptr<Object> Get(const std::string& name);
+    bool Lookup(const std::string& name, std::shared_ptr<Object>* obj) const;
 
-    void Define(const std::string& name, std::shared_ptr<Object> obj);
-    void Set(const std::string& name, std::shared_ptr<Object> obj);
+    std::shared_ptr<Object> Define(const std::string& name, std::shared_ptr<Object> obj);
+    // Assigning a binding of a frozen scope shadows it in the outermost mutable scope below it
+    // instead, so scopes shared between threads are never written.
+    std::shared_ptr<Object> Set(const std::string& name, std::shared_ptr<Object> obj);
+
+    // Drops every binding and makes the scope a child of parent, as if it were new.
+    void Reset(std::shared_ptr<Scope> parent);
+    void Freeze();
+    bool IsFrozen() const;
+    bool IsEmpty() const;
+    std::shared_ptr<Scope> GetParent() const;
 
 private:
+    friend class Freezer;
+
+    // Call frames bind a few names, so the first bindings are kept inline and searched
+    // linearly, and only larger scopes spill into the map.
+    static constexpr size_t kInlineBindings = 4;
+
+    std::shared_ptr<Object>* Find(const std::string& name);
+    const std::shared_ptr<Object>* Find(const std::string& name) const;
+    void Bind(const std::string& name, std::shared_ptr<Object> obj);
+
+    std::array<std::pair<std::string, std::shared_ptr<Object>>, kInlineBindings> inline_;
+    size_t inline_size_ = 0;
     std::unordered_map<std::string, std::shared_ptr<Object>> defined_objects_;
     std::shared_ptr<Scope> parent_ = nullptr;
+    bool frozen_ = false;
 };
 
+// Scope of a call, taken from the frame arena, which keeps the mostly short-lived call scopes
+// apart from other objects. A closure may still keep it alive after the call returns.
+std::shared_ptr<Scope> NewFrame(std::shared_ptr<Scope> parent);
+// Scope of a call whose code can't capture it (see LambdaCode::MayCapture). Once the last
+// reference to it is dropped, it is emptied and kept for the next such call on the thread. A
+// frame that escapes anyway, through an alias of lambda for instance, is only reused once
+// whatever kept it is gone.
+std::shared_ptr<Scope> NewReusableFrame(std::shared_ptr<Scope> parent);
+
+// Frozen, so any number of threads may run interpreters on top of it.
 std::shared_ptr<Scope> GetGlobalScope();
 
+// Freezes the scopes, pairs, records and promises reachable from what it is given, through
+// closures too, so interpreters sharing them can't change them (see Interpreter::Fork). Whatever
+// is frozen already is skipped along with everything it reaches. A frozen promise freezes its
+// value once it is computed.
+class Freezer {
+public:
+    void Add(Scope* scope);
+    void Add(Object* obj);
+    void Run();
+
+private:
+    std::vector<Scope*> scopes_;
+    std::vector<Object*> objects_;
+};
+
+// Parsed top-level forms of a source that can be executed many times, by several interpreters at
+// once too. The code of the procedures they make is built already, and the forms are frozen, so
+// an execution can't change the literals the next one sees.
+class PreparedExpression {
+public:
+    explicit PreparedExpression(std::vector<std::shared_ptr<Object>> forms);
+
+    const std::vector<std::shared_ptr<Object>>& GetForms() const;
+
+private:
+    std::vector<std::shared_ptr<Object>> forms_;
+};
+
+using Bindings = std::unordered_map<std::string, std::shared_ptr<Object>>;
+
+// Bindings of frozen scopes that an interpreter has assigned or redefined, consulted by every
+// lookup that finds a binding in a frozen scope while the interpreter runs. This way forks share
+// frozen scopes, closures made in them included, and copy a binding only when it changes.
+struct ScopeOverlay {
+    using ScopeBindings = std::unordered_map<const Scope*, Bindings>;
+
+    // Bindings assigned before a fork, shared by the parent and its forks and never changed.
+    // Each layer has the older ones below it.
+    struct Layer {
+        ScopeBindings bindings;
+        size_t size = 0;
+        std::shared_ptr<const Layer> below;
+    };
+
+    // The top-level scope of the interpreter. Names a closure made before a fork can't find in
+    // its own scopes are looked up here, as they would be had the scopes not been forked.
+    Scope* top = nullptr;
+    // Assigned since the last fork, these win over the layers.
+    ScopeBindings bindings;
+    std::shared_ptr<const Layer> layers;
+
+    const std::shared_ptr<Object>* Find(const Scope* scope, const std::string& name) const;
+    // Moves bindings into a new layer, so a fork can share them. A layer at least as large as the
+    // one below it absorbs it, which keeps the number of layers logarithmic in the number of
+    // bindings and copies every binding a logarithmic number of times.
+    void Share();
+};
+
+// Values evaluation frames hand to their callers besides the result: the tail call the caller
+// evaluates next and the raised error, both per thread. A task switching between evaluations on
+// one thread swaps it along with the ExecutionContext.
+struct PendingState {
+    std::shared_ptr<Object> tail_call;
+    std::shared_ptr<Scope> tail_call_scope;
+    std::shared_ptr<Object> error;
+};
+
+PendingState& GetPendingState();
+
 class Interpreter {
 public:
+    Interpreter();
+    explicit Interpreter(std::shared_ptr<Scope> parent);
+
     std::string Run(const std::string&);
+    std::string RunScript(const std::string& source);
+    // Like RunScript, with the source read in chunks from next_chunk until it returns false.
+    // Every form is evaluated as soon as it has arrived.
+    std::string RunStream(const std::function<bool(std::string*)>& next_chunk);
+
+    std::shared_ptr<Scope> GetScope() const;
+
+    // A child with the same environment: the top-level scope is frozen and shared, and both
+    // interpreters go on in new scopes on top of it, so definitions and assignments made by one
+    // of them, set! of an inherited binding included, are never seen by the other. The pairs,
+    // records and promises reachable from what is shared are frozen too, set-car!, set-cdr! and
+    // record modifiers raise an error on them in either interpreter. Forking doesn't copy any
+    // binding, and forking an interpreter with nothing defined since its last fork doesn't
+    // change it. The child gets the limits and a new cancellation handle.
+    Interpreter Fork();
+
+    // Loads a shared library built from the output of CompileModule (compiler.h) and runs the
+    // top-level forms of its source in the scope of this interpreter. The library stays loaded
+    // until the process exits.
+    void LoadModule(const std::string& path);
+
+    // Binds a C++ callable taking and returning int64_t, bool, std::string (as a symbol) or
+    // std::shared_ptr<Object>. Defined in native.h.
+    template <class F>
+    void Register(const std::string& name, F func);
+
+    std::shared_ptr<const PreparedExpression> Prepare(const std::string& source);
+    // Evaluates the forms in a fresh scope holding the bindings and returns the value of the
+    // last one. Definitions made by the forms are dropped afterwards.
+    std::shared_ptr<Object> Execute(const PreparedExpression& expression,
+                                    const Bindings& bindings = {});
+
+    void SetLimits(const Limits& limits);
+    std::shared_ptr<CancellationHandle> GetCancellationHandle() const;
+
+    // Heap counters accumulated during the latest run, including allocations made concurrently
+    // by other threads. Empty unless heap statistics are enabled.
+    const HeapStats& GetLastRunHeapStats() const;
 
     static std::shared_ptr<Object> Calculate(std::shared_ptr<Object> obj,
                                              std::shared_ptr<Scope> scope);
+    // Stores obj as the pending error and returns a marker that is passed up unchanged by every
+    // caller of Calculate, so errors don't unwind the C++ stack. Run, RunScript, RunStream and
+    // Execute throw the exception matching an error that is still pending when they finish.
+    static std::shared_ptr<Object> Raise(std::shared_ptr<Object> obj);
+    static bool IsRaised(const std::shared_ptr<Object>& obj);
+    // Returns and clears the pending error.
+    static std::shared_ptr<Object> TakeRaised();
+    // Returned from Function::Invoke instead of the value of an expression in tail position.
+    // Calculate then evaluates the expression itself, so tail calls don't grow the stack.
+    static std::shared_ptr<Object> TailCall(std::shared_ptr<Object> obj,
+                                            std::shared_ptr<Scope> scope);
     static std::string ToString(std::shared_ptr<Object> obj);
 
 private:
-    std::shared_ptr<Scope> scope_ = std::make_shared<Scope>(GetGlobalScope());
+    std::shared_ptr<Scope> scope_;
+    ScopeOverlay overlay_;
+    Limits limits_;
+    std::shared_ptr<CancellationHandle> cancellation_ = std::make_shared<CancellationHandle>();
+    HeapStats last_run_heap_stats_;
 };
+
+// Errors stay values inside the evaluator and become exceptions only at the API boundary: throws
+// the exception matching an error raised instead of result, otherwise returns result.
+std::shared_ptr<Object> ThrowIfRaised(std::shared_ptr<Object> result);
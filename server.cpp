@@ -0,0 +1,266 @@
+#include "server.h"
+
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "error.h"
+
+namespace {
+
+void ThrowSystemError(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+int Listen(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long");
+    }
+    std::strcpy(address.sun_path, path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ThrowSystemError("socket");
+    }
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        ThrowSystemError("bind");
+    }
+    return fd;
+}
+
+// Reads and writes of a stalled client fail with EAGAIN after the timeout.
+void SetTimeouts(int fd, std::chrono::milliseconds timeout) {
+    timeval value{};
+    value.tv_sec = timeout.count() / 1000;
+    value.tv_usec = timeout.count() % 1000 * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value));
+}
+
+template <class F>
+Response Respond(F run) {
+    try {
+        return {ResponseStatus::OK, run()};
+    } catch (const SyntaxError& error) {
+        return {ResponseStatus::SYNTAX_ERROR, error.what()};
+    } catch (const RuntimeError& error) {
+        return {ResponseStatus::RUNTIME_ERROR, error.what()};
+    } catch (const NameError& error) {
+        return {ResponseStatus::NAME_ERROR, error.what()};
+    } catch (const LimitError& error) {
+        return {ResponseStatus::LIMIT_ERROR, error.what()};
+    } catch (const std::exception& error) {
+        return {ResponseStatus::INTERNAL_ERROR, error.what()};
+    }
+}
+
+}  // namespace
+
+InterpreterPool::InterpreterPool(size_t size, const std::string& prelude) {
+    for (size_t i = 0; i < size; ++i) {
+        auto interpreter = std::make_unique<Interpreter>();
+        interpreter->RunScript(prelude);
+        idle_.emplace_back(std::move(interpreter));
+    }
+}
+
+std::unique_ptr<Interpreter> InterpreterPool::Acquire() {
+    std::unique_lock lock(mutex_);
+    has_idle_.wait(lock, [this] { return !idle_.empty(); });
+    auto interpreter = std::move(idle_.back());
+    idle_.pop_back();
+    return interpreter;
+}
+
+void InterpreterPool::Release(std::unique_ptr<Interpreter> interpreter) {
+    {
+        std::lock_guard lock(mutex_);
+        idle_.emplace_back(std::move(interpreter));
+    }
+    has_idle_.notify_one();
+}
+
+Response Evaluate(Interpreter* interpreter, const std::string& source, const Limits& limits) {
+    Interpreter request = interpreter->Fork();
+    request.SetLimits(limits);
+    return Respond([&] { return request.RunScript(source); });
+}
+
+Response Evaluate(Interpreter* interpreter, const std::function<bool(std::string*)>& next_chunk,
+                  const Limits& limits) {
+    Interpreter request = interpreter->Fork();
+    request.SetLimits(limits);
+    return Respond([&] { return request.RunStream(next_chunk); });
+}
+
+Server::Server(ServerOptions options)
+    : options_(std::move(options)),
+      pool_(options_.interpreter_count ? options_.interpreter_count : options_.worker_count,
+            options_.prelude) {
+    listen_fd_ = Listen(options_.socket_path);
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd_ < 0 || stop_fd_ < 0) {
+        ThrowSystemError("epoll");
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event);
+    event.data.fd = stop_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, &event);
+}
+
+Server::~Server() {
+    Stop();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    for (int fd : connections_) {
+        close(fd);
+    }
+    close(stop_fd_);
+    close(epoll_fd_);
+    close(listen_fd_);
+    unlink(options_.socket_path.c_str());
+}
+
+void Server::Serve() {
+    for (size_t i = 0; i < options_.worker_count; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+    }
+    epoll_event events[64];
+    while (!stopped_) {
+        int count = epoll_wait(epoll_fd_, events, std::size(events), -1);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            ThrowSystemError("epoll_wait");
+        }
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == stop_fd_) {
+                continue;
+            }
+            if (fd == listen_fd_) {
+                int client = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+                if (client < 0) {
+                    continue;
+                }
+                SetTimeouts(client, options_.io_timeout);
+                {
+                    std::lock_guard lock(connections_mutex_);
+                    connections_.insert(client);
+                }
+                epoll_event event{};
+                event.events = EPOLLIN | EPOLLONESHOT;
+                event.data.fd = client;
+                epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client, &event);
+                continue;
+            }
+            {
+                std::lock_guard lock(queue_mutex_);
+                ready_connections_.push_back(fd);
+            }
+            queue_not_empty_.notify_one();
+        }
+    }
+}
+
+void Server::Stop() {
+    if (stopped_.exchange(true)) {
+        return;
+    }
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = write(stop_fd_, &one, sizeof(one));
+    queue_not_empty_.notify_all();
+}
+
+void Server::WorkerLoop() {
+    while (true) {
+        int fd;
+        {
+            std::unique_lock lock(queue_mutex_);
+            queue_not_empty_.wait(lock, [this] { return stopped_ || !ready_connections_.empty(); });
+            if (stopped_) {
+                return;
+            }
+            fd = ready_connections_.front();
+            ready_connections_.pop_front();
+        }
+        HandleConnection(fd);
+    }
+}
+
+void Server::HandleConnection(int fd) {
+    constexpr uint32_t kChunkSize = 64 << 10;
+    try {
+        uint32_t left;
+        if (!ReadFrameHeader(fd, &left)) {
+            CloseConnection(fd);
+            return;
+        }
+        // The script is parsed and evaluated while the rest of it is still arriving.
+        bool disconnected = false;
+        auto next_chunk = [&](std::string* chunk) {
+            if (left == 0) {
+                return false;
+            }
+            chunk->resize(std::min(left, kChunkSize));
+            try {
+                chunk->resize(ReadPayload(fd, chunk->data(), chunk->size()));
+            } catch (...) {
+                disconnected = true;
+                throw;
+            }
+            left -= chunk->size();
+            return true;
+        };
+        auto interpreter = pool_.Acquire();
+        Response response = Evaluate(interpreter.get(), next_chunk, options_.limits);
+        pool_.Release(std::move(interpreter));
+        if (disconnected) {
+            CloseConnection(fd);
+            return;
+        }
+        // A failed script leaves the rest of its frame unread.
+        for (std::string chunk; next_chunk(&chunk);) {
+        }
+        WriteFrame(fd, EncodeResponse(response));
+    } catch (const std::exception&) {
+        CloseConnection(fd);
+        return;
+    }
+    Rearm(fd);
+}
+
+void Server::Rearm(int fd) {
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) < 0) {
+        CloseConnection(fd);
+    }
+}
+
+void Server::CloseConnection(int fd) {
+    {
+        std::lock_guard lock(connections_mutex_);
+        connections_.erase(fd);
+    }
+    close(fd);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "protocol.h"
+#include "scheme.h"
+
+struct ServerOptions {
+    std::string socket_path;
+    size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
+    size_t interpreter_count = 0;
+    std::string prelude;
+    // Evaluation runs on a stack of its own, so recursion is bounded by its size rather than by
+    // the worker stacks. A smaller one than the default bounds the memory a runaway request can
+    // commit on each worker.
+    Limits limits = {.max_stack_bytes = 64 << 20};
+    // A client that stalls in the middle of a request or doesn't take the response for this long
+    // is disconnected, so it can't hold a worker.
+    std::chrono::milliseconds io_timeout{10000};
+};
+
+// Interpreters that each ran the prelude themselves. The requests of one interpreter run one at a
+// time in forks of it, which see the lists and records made by the prelude frozen.
+class InterpreterPool {
+public:
+    InterpreterPool(size_t size, const std::string& prelude);
+
+    std::unique_ptr<Interpreter> Acquire();
+    void Release(std::unique_ptr<Interpreter> interpreter);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable has_idle_;
+    std::vector<std::unique_ptr<Interpreter>> idle_;
+};
+
+// Runs the source in a fork of the interpreter, so nothing it defines or assigns outlives it.
+Response Evaluate(Interpreter* interpreter, const std::string& source, const Limits& limits = {});
+// Evaluates a source arriving in chunks, see Interpreter::RunStream.
+Response Evaluate(Interpreter* interpreter, const std::function<bool(std::string*)>& next_chunk,
+                  const Limits& limits = {});
+
+class Server {
+public:
+    explicit Server(ServerOptions options);
+    ~Server();
+
+    void Serve();
+    void Stop();
+
+private:
+    void WorkerLoop();
+    void HandleConnection(int fd);
+    void Rearm(int fd);
+    void CloseConnection(int fd);
+
+    ServerOptions options_;
+    InterpreterPool pool_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int stop_fd_ = -1;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_not_empty_;
+    std::deque<int> ready_connections_;
+    // Every accepted connection that isn't closed yet, closed by the destructor.
+    std::mutex connections_mutex_;
+    std::unordered_set<int> connections_;
+    std::atomic<bool> stopped_ = false;
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,198 @@
+#include "slab_allocator.h"
+
+#include <mutex>
+#include <new>
+
+namespace {
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+constexpr size_t kArenaCount = static_cast<size_t>(SlabArena::COUNT);
+constexpr size_t kChunkSize = 64 << 10;
+constexpr size_t kBatchBlocks = 64;
+constexpr size_t kMaxCachedBlocks = 1024;
+
+size_t GetBlockSize(size_t size_class) {
+    return (size_class + 1) * kSlabGranularity;
+}
+
+// Blocks of one size class not cached by any thread, and the chunks new blocks are carved from.
+class SharedBlocks {
+public:
+    // Returns a list of up to limit blocks and its length.
+    FreeBlock* Take(size_t size_class, size_t limit, size_t* count) {
+        std::lock_guard lock(mutex_);
+        if (free_ == nullptr) {
+            size_t block_size = GetBlockSize(size_class);
+            size_t blocks = kChunkSize / block_size;
+            auto chunk = static_cast<char*>(::operator new(blocks * block_size));
+            for (size_t i = blocks; i > 0; --i) {
+                free_ = new (chunk + (i - 1) * block_size) FreeBlock{free_};
+            }
+            reserved_ += blocks;
+            free_count_ += blocks;
+        }
+        FreeBlock* head = free_;
+        FreeBlock* last = head;
+        *count = 1;
+        while (*count < limit && last->next != nullptr) {
+            last = last->next;
+            ++*count;
+        }
+        free_ = last->next;
+        last->next = nullptr;
+        free_count_ -= *count;
+        ++refills_;
+        return head;
+    }
+
+    void Give(FreeBlock* head, FreeBlock* last, size_t count) {
+        std::lock_guard lock(mutex_);
+        last->next = free_;
+        free_ = head;
+        free_count_ += count;
+        ++releases_;
+    }
+
+    void GetStats(SlabStats* stats) {
+        std::lock_guard lock(mutex_);
+        stats->reserved_blocks = reserved_;
+        stats->shared_free_blocks = free_count_;
+        stats->refills = refills_;
+        stats->releases = releases_;
+    }
+
+private:
+    std::mutex mutex_;
+    FreeBlock* free_ = nullptr;
+    int64_t free_count_ = 0;
+    int64_t reserved_ = 0;
+    int64_t refills_ = 0;
+    int64_t releases_ = 0;
+};
+
+// Never destroyed, objects may be freed by destructors running at exit.
+SharedBlocks& GetSharedBlocks(SlabArena arena, size_t size_class) {
+    static auto shared = new SharedBlocks[kArenaCount][kSlabClassCount];
+    return shared[static_cast<size_t>(arena)][size_class];
+}
+
+enum class CacheState { NONE, ALIVE, DESTROYED };
+
+thread_local CacheState cache_state = CacheState::NONE;
+
+class BlockCache {
+public:
+    BlockCache() {
+        cache_state = CacheState::ALIVE;
+    }
+
+    ~BlockCache() {
+        cache_state = CacheState::DESTROYED;
+        for (size_t arena = 0; arena < kArenaCount; ++arena) {
+            for (size_t size_class = 0; size_class < kSlabClassCount; ++size_class) {
+                auto& list = lists_[arena][size_class];
+                if (list.free != nullptr) {
+                    Release(static_cast<SlabArena>(arena), size_class, list.count);
+                }
+            }
+        }
+    }
+
+    void* Allocate(SlabArena arena, size_t size_class) {
+        auto& list = lists_[static_cast<size_t>(arena)][size_class];
+        if (list.free == nullptr) {
+            list.free = GetSharedBlocks(arena, size_class).Take(size_class, kBatchBlocks,
+                                                                &list.count);
+        }
+        FreeBlock* block = list.free;
+        list.free = block->next;
+        --list.count;
+        return block;
+    }
+
+    void Free(SlabArena arena, size_t size_class, void* ptr) {
+        auto& list = lists_[static_cast<size_t>(arena)][size_class];
+        list.free = new (ptr) FreeBlock{list.free};
+        // Objects made on one thread and dropped on another would pile up here otherwise.
+        if (++list.count > kMaxCachedBlocks) {
+            Release(arena, size_class, kMaxCachedBlocks / 2);
+        }
+    }
+
+private:
+    struct List {
+        FreeBlock* free = nullptr;
+        size_t count = 0;
+    };
+
+    void Release(SlabArena arena, size_t size_class, size_t count) {
+        auto& list = lists_[static_cast<size_t>(arena)][size_class];
+        FreeBlock* head = list.free;
+        FreeBlock* last = head;
+        for (size_t i = 1; i < count; ++i) {
+            last = last->next;
+        }
+        list.free = last->next;
+        list.count -= count;
+        GetSharedBlocks(arena, size_class).Give(head, last, count);
+    }
+
+    List lists_[kArenaCount][kSlabClassCount];
+};
+
+// Null once the cache of the thread is destroyed, blocks freed by later thread-exit
+// destructors go to the shared lists then.
+BlockCache* GetBlockCache() {
+    if (cache_state == CacheState::DESTROYED) {
+        return nullptr;
+    }
+    thread_local BlockCache cache;
+    return &cache;
+}
+
+}  // namespace
+
+void* AllocateSlabBlock(SlabArena arena, size_t size_class) {
+    if (auto cache = GetBlockCache()) {
+        return cache->Allocate(arena, size_class);
+    }
+    size_t count;
+    return GetSharedBlocks(arena, size_class).Take(size_class, 1, &count);
+}
+
+void FreeSlabBlock(SlabArena arena, size_t size_class, void* block) {
+    if (auto cache = GetBlockCache()) {
+        cache->Free(arena, size_class, block);
+        return;
+    }
+    auto freed = new (block) FreeBlock{nullptr};
+    GetSharedBlocks(arena, size_class).Give(freed, freed, 1);
+}
+
+const char* GetSlabArenaName(SlabArena arena) {
+    switch (arena) {
+        case SlabArena::OBJECTS:
+            return "objects";
+        case SlabArena::FRAMES:
+            return "frames";
+        default:
+            return "other";
+    }
+}
+
+std::vector<SlabStats> GetSlabStats() {
+    std::vector<SlabStats> result;
+    for (size_t arena = 0; arena < kArenaCount; ++arena) {
+        for (size_t size_class = 0; size_class < kSlabClassCount; ++size_class) {
+            SlabStats stats{static_cast<SlabArena>(arena), GetBlockSize(size_class)};
+            GetSharedBlocks(stats.arena, size_class).GetStats(&stats);
+            if (stats.reserved_blocks != 0) {
+                result.push_back(stats);
+            }
+        }
+    }
+    return result;
+}
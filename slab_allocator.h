@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Objects are carved from slabs of fixed-size blocks, one size class per multiple of
+// kSlabGranularity. Freed blocks are cached by the freeing thread and handed to the next
+// objects of the class. A block may be freed on any thread, and blocks are never returned to
+// the system.
+inline constexpr size_t kSlabGranularity = 16;
+inline constexpr size_t kMaxSlabBlockSize = 512;
+inline constexpr size_t kSlabClassCount = kMaxSlabBlockSize / kSlabGranularity;
+
+// Frames of calls are short-lived, so they are kept apart from the other objects and their
+// blocks are reused while still in cache.
+enum class SlabArena { OBJECTS, FRAMES, COUNT };
+
+void* AllocateSlabBlock(SlabArena arena, size_t size_class);
+void FreeSlabBlock(SlabArena arena, size_t size_class, void* block);
+
+struct SlabStats {
+    SlabArena arena;
+    size_t block_size;
+    // Blocks carved so far, and the ones of them waiting in the shared list. The rest are
+    // in use or cached by threads.
+    int64_t reserved_blocks = 0;
+    int64_t shared_free_blocks = 0;
+    // Batches of blocks moved between the thread caches and the shared list.
+    int64_t refills = 0;
+    int64_t releases = 0;
+};
+
+const char* GetSlabArenaName(SlabArena arena);
+// Size classes of which a block was ever carved.
+std::vector<SlabStats> GetSlabStats();
+
+template <class T, SlabArena Arena = SlabArena::OBJECTS>
+class SlabAllocator {
+public:
+    using value_type = T;
+
+    template <class U>
+    struct rebind {
+        using other = SlabAllocator<U, Arena>;
+    };
+
+    SlabAllocator() = default;
+
+    template <class U>
+    SlabAllocator(const SlabAllocator<U, Arena>&) {
+    }
+
+    T* allocate(size_t n) {
+        if (sizeof(T) > kMaxSlabBlockSize || n != 1) {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T*>(AllocateSlabBlock(Arena, kSizeClass));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        if (sizeof(T) > kMaxSlabBlockSize || n != 1) {
+            std::allocator<T>().deallocate(ptr, n);
+            return;
+        }
+        FreeSlabBlock(Arena, kSizeClass, ptr);
+    }
+
+    template <class U>
+    bool operator==(const SlabAllocator<U, Arena>&) const {
+        return true;
+    }
+
+private:
+    static_assert(alignof(T) <= kSlabGranularity);
+    static constexpr size_t kSizeClass = (sizeof(T) - 1) / kSlabGranularity;
+};
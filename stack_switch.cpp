@@ -0,0 +1,122 @@
+#include "stack_switch.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SCHEME_SANITIZE_ADDRESS
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define SCHEME_SANITIZE_ADDRESS
+#endif
+
+// AddressSanitizer only follows stack switches made by swapcontext.
+#if defined(__x86_64__) && !defined(SCHEME_SANITIZE_ADDRESS)
+
+// The frame of a suspended stack is mxcsr and the x87 control word, r15, r14, r13, r12, rbx, rbp
+// and the return address. A prepared stack returns to StackEntry with the entry in r13 and its
+// argument in r12, and StackEntry marks the outermost frame for the unwinder.
+asm(R"(
+    .pushsection .text
+    .globl SwitchStack
+    .hidden SwitchStack
+    .type SwitchStack, @function
+SwitchStack:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size SwitchStack, .-SwitchStack
+
+    .type SchemeStackEntry, @function
+SchemeStackEntry:
+    .cfi_startproc
+    .cfi_undefined rip
+    movq %r12, %rdi
+    callq *%r13
+    ud2
+    .cfi_endproc
+    .size SchemeStackEntry, .-SchemeStackEntry
+    .popsection
+)");
+
+extern "C" char SchemeStackEntry[];
+
+void* PrepareStack(char* bottom, size_t size, void (*entry)(void*), void* argument) {
+    constexpr uint64_t kDefaultMxcsr = 0x1f80;
+    constexpr uint64_t kDefaultControlWord = 0x037f;
+    auto aligned = reinterpret_cast<uintptr_t>(bottom + size) & ~uintptr_t{15};
+    auto* frame = reinterpret_cast<uint64_t*>(aligned) - 8;
+    frame[0] = kDefaultMxcsr | kDefaultControlWord << 32;
+    frame[1] = frame[2] = 0;
+    frame[3] = reinterpret_cast<uint64_t>(entry);
+    frame[4] = reinterpret_cast<uint64_t>(argument);
+    frame[5] = frame[6] = 0;
+    frame[7] = reinterpret_cast<uint64_t>(SchemeStackEntry);
+    return frame;
+}
+
+#else
+
+#include <ucontext.h>
+
+namespace {
+
+// The context of a suspended stack lives in the frame of its SwitchStack call, the context of a
+// prepared stack at its top.
+struct PreparedStack {
+    ucontext_t context;
+    void (*entry)(void*);
+    void* argument;
+};
+
+void StackEntry(unsigned int high, unsigned int low) {
+    auto* prepared = reinterpret_cast<PreparedStack*>((static_cast<uintptr_t>(high) << 32) | low);
+    prepared->entry(prepared->argument);
+}
+
+}  // namespace
+
+extern "C" void SwitchStack(void** from, void* to) {
+    ucontext_t context;
+    *from = &context;
+    swapcontext(&context, static_cast<ucontext_t*>(to));
+}
+
+void* PrepareStack(char* bottom, size_t size, void (*entry)(void*), void* argument) {
+    auto aligned = reinterpret_cast<uintptr_t>(bottom + size - sizeof(PreparedStack)) &
+                   ~uintptr_t{alignof(std::max_align_t) - 1};
+    auto* prepared = new (reinterpret_cast<void*>(aligned)) PreparedStack{};
+    prepared->entry = entry;
+    prepared->argument = argument;
+    getcontext(&prepared->context);
+    prepared->context.uc_stack.ss_sp = bottom;
+    prepared->context.uc_stack.ss_size = reinterpret_cast<char*>(prepared) - bottom;
+    prepared->context.uc_link = nullptr;
+    auto self = reinterpret_cast<uintptr_t>(prepared);
+    makecontext(&prepared->context, reinterpret_cast<void (*)()>(&StackEntry), 2,
+                static_cast<unsigned int>(self >> 32), static_cast<unsigned int>(self));
+    return &prepared->context;
+}
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+// Switches between stacks of the calling thread saving only the registers a call preserves, so
+// unlike swapcontext a switch stays in user space instead of saving the signal mask with a
+// system call. The saved state of a suspended stack is kept on the stack itself and identified
+// by its stack pointer.
+
+// Suspends the current stack, stores its stack pointer to *from and resumes the stack at to.
+// Returns once another switch resumes *from.
+extern "C" void SwitchStack(void** from, void* to);
+
+// Prepares the stack of size bytes at bottom so that the first switch to the returned stack
+// pointer calls entry(argument). The entry must never return, it has to switch away instead.
+void* PrepareStack(char* bottom, size_t size, void (*entry)(void*), void* argument);
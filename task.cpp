@@ -0,0 +1,82 @@
+#include "task.h"
+
+#include <algorithm>
+#include <utility>
+
+Task::Task(Interpreter* interpreter, std::string source, uint64_t steps_per_slice,
+           size_t stack_size)
+    : interpreter_(interpreter),
+      source_(std::move(source)),
+      fiber_(
+          [this] {
+              try {
+                  result_ = interpreter_->RunScript(source_);
+              } catch (...) {
+                  error_ = std::current_exception();
+              }
+          },
+          stack_size) {
+    context_.yield = &Task::YieldHook;
+    context_.yield_argument = this;
+    context_.fuel_chunk = std::max<uint64_t>(steps_per_slice, 1);
+    context_.stack_end = fiber_.GetStackBottom() + ExecutionContext::kStackReserve;
+    context_.stack_limit = context_.stack_end;
+}
+
+Task::~Task() {
+    SwapState();
+    fiber_.Cancel();
+    SwapState();
+}
+
+void Task::YieldHook(void* task) {
+    static_cast<Task*>(task)->fiber_.Yield();
+}
+
+void Task::SwapState() {
+    std::swap(GetExecutionContext(), context_);
+    std::swap(GetPendingState(), pending_);
+    std::swap(GetInstalledShadowStack(), installed_shadow_stack_);
+}
+
+bool Task::Resume() {
+    SwapState();
+    fiber_.Resume();
+    SwapState();
+    return fiber_.IsFinished();
+}
+
+bool Task::IsFinished() const {
+    return fiber_.IsFinished();
+}
+
+const std::string& Task::GetResult() const {
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    return result_;
+}
+
+void Scheduler::Add(std::shared_ptr<Task> task) {
+    pending_.emplace_back(std::move(task));
+}
+
+bool Scheduler::RunRound() {
+    for (size_t count = pending_.size(); count > 0; --count) {
+        auto task = std::move(pending_.front());
+        pending_.pop_front();
+        if (!task->Resume()) {
+            pending_.emplace_back(std::move(task));
+        }
+    }
+    return !pending_.empty();
+}
+
+void Scheduler::Run() {
+    while (RunRound()) {
+    }
+}
+
+size_t Scheduler::GetPendingCount() const {
+    return pending_.size();
+}
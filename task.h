@@ -0,0 +1,58 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "context.h"
+#include "fiber.h"
+#include "profiler.h"
+#include "scheme.h"
+
+// A script evaluation that gives control back after every slice of steps.
+class Task {
+public:
+    Task(Interpreter* interpreter, std::string source, uint64_t steps_per_slice = 1024,
+         size_t stack_size = Fiber::kDefaultStackSize);
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task();
+
+    // Runs the next slice. Returns true once the evaluation has finished.
+    bool Resume();
+    bool IsFinished() const;
+
+    // Rethrows the error the script finished with.
+    const std::string& GetResult() const;
+
+private:
+    static void YieldHook(void* task);
+    // Exchanges the per-thread evaluation state with the one of the task.
+    void SwapState();
+
+    Interpreter* interpreter_;
+    std::string source_;
+    std::string result_;
+    std::exception_ptr error_;
+    ExecutionContext context_;
+    PendingState pending_;
+    ShadowStack shadow_stack_;
+    // The installed shadow stack while the task runs, its own one otherwise.
+    ShadowStack* installed_shadow_stack_ = &shadow_stack_;
+    Fiber fiber_;
+};
+
+class Scheduler {
+public:
+    void Add(std::shared_ptr<Task> task);
+
+    // Gives one slice to every pending task in round-robin order.
+    // Returns false when no pending tasks are left.
+    bool RunRound();
+    void Run();
+
+    size_t GetPendingCount() const;
+
+private:
+    std::deque<std::shared_ptr<Task>> pending_;
+};
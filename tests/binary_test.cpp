@@ -0,0 +1,118 @@
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "binary.h"
+#include "check.h"
+#include "error.h"
+#include "parser.h"
+
+namespace {
+
+std::shared_ptr<Object> ReadDatum(const std::string& source) {
+    std::stringstream stream(source);
+    Tokenizer tokenizer(&stream);
+    return Read(&tokenizer);
+}
+
+void CheckRoundTrip(const std::string& source) {
+    auto data = SerializeBinary(ReadDatum(source));
+    auto result = Interpreter::ToString(DeserializeBinary(data));
+    Check(result == Interpreter::ToString(ReadDatum(source)), "round trip of " + source, result);
+}
+
+void TestRoundTrip() {
+    CheckRoundTrip("()");
+    CheckRoundTrip("42");
+    CheckRoundTrip("-42");
+    CheckRoundTrip("#t");
+    CheckRoundTrip("#f");
+    CheckRoundTrip("symbol");
+    CheckRoundTrip("(1 (2 (3 . 4)) a a b (a) #t #f ())");
+    CheckRoundTrip("(1 . 2)");
+    auto limits = VectorToCell({New<Number>(std::numeric_limits<int64_t>::min()),
+                                New<Number>(std::numeric_limits<int64_t>::max()), nullptr});
+    auto result = Interpreter::ToString(DeserializeBinary(SerializeBinary(limits)));
+    Check(result == Interpreter::ToString(limits), "extreme integers", result);
+    // A repeated symbol is referenced, every further element takes three bytes.
+    auto once = SerializeBinary(ReadDatum("(long-name)"));
+    auto repeated = SerializeBinary(ReadDatum("(long-name long-name long-name)"));
+    Check(repeated.size() == once.size() + 6, "size of repeated symbols",
+          std::to_string(repeated.size()));
+}
+
+void TestDeepData() {
+    std::shared_ptr<Object> nested;
+    std::shared_ptr<Object> list;
+    for (int i = 0; i < 1000000; ++i) {
+        nested = New<Cell>(nested, nullptr);
+        list = New<Cell>(New<Number>(i), list);
+    }
+    auto data = SerializeBinary(New<Cell>(nested, list));
+    auto result = As<Cell>(DeserializeBinary(data));
+    size_t depth = 0;
+    for (auto cell = As<Cell>(result->GetFirst()); cell; cell = As<Cell>(cell->GetFirst())) {
+        ++depth;
+    }
+    Check(depth == 1000000, "depth of nested data", std::to_string(depth));
+    Check(CellToVector(As<Cell>(result->GetSecond())).size() == 1000001, "length of a long list");
+}
+
+void TestSharing() {
+    auto shared = ReadDatum("(1 2)");
+    auto data = SerializeBinary(VectorToCell({shared, shared, nullptr}));
+    auto result = CellToVector(As<Cell>(DeserializeBinary(data)));
+    Check(result[0] == result[1], "shared cell read once");
+
+    auto cycle = New<Cell>(New<Number>(1), nullptr);
+    cycle->SetSecond(cycle);
+    auto read = As<Cell>(DeserializeBinary(SerializeBinary(cycle)));
+    Check(read->GetSecond() == read, "cycle preserved");
+    cycle->SetSecond(nullptr);
+    read->SetSecond(nullptr);
+}
+
+void TestMalformed() {
+    auto data = SerializeBinary(ReadDatum("(1 2 (3 sym))"));
+    for (size_t size = 0; size < data.size(); ++size) {
+        try {
+            DeserializeBinary(std::string_view(data).substr(0, size));
+            Check(false, "truncated data read", std::to_string(size));
+        } catch (const SyntaxError&) {
+        }
+    }
+    auto corrupted = data;
+    corrupted[0] = 'X';
+    try {
+        DeserializeBinary(corrupted);
+        Check(false, "data with a wrong header read");
+    } catch (const SyntaxError&) {
+    }
+    try {
+        SerializeBinary(New<String>("text"));
+        Check(false, "string serialized");
+    } catch (const RuntimeError&) {
+    }
+}
+
+void TestFiles() {
+    auto path = "/tmp/scheme_binary_test_" + std::to_string(getpid());
+    CheckRun("(write-binary '(1 (2 x) x . #t) \"" + path + "\") (read-binary \"" + path + "\")",
+             "(1 (2 x) x . #t)");
+    unlink(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+    TestRoundTrip();
+    TestDeepData();
+    TestSharing();
+    TestMalformed();
+    TestFiles();
+    return FinishChecks();
+}
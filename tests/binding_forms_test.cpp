@@ -0,0 +1,66 @@
+#include "check.h"
+#include "error.h"
+
+namespace {
+
+void TestLet() {
+    CheckRun("(let ((x 1) (y 2)) (+ x y))", "3");
+    CheckRun("(define x 10) (let ((x 1) (y x)) y)", "10");
+    CheckRun("(define x 10) (let ((x 1)) (define y 2) (+ x y)) x", "10");
+    CheckThrows<SyntaxError>("(let ((x)) x)");
+    CheckThrows<SyntaxError>("(let ((x 1)))");
+}
+
+void TestLetStar() {
+    CheckRun("(let* ((x 1) (y (+ x 1))) (* x y))", "2");
+    CheckRun("(let* ((x 1) (x (+ x 1))) x)", "2");
+    CheckRun("(let* () 5)", "5");
+    // A closure made by an init sees only the bindings before it.
+    CheckRun("(define x 10) (let* ((f (lambda () x)) (x 1)) (f))", "10");
+    CheckRun("(let* ((x 1) (f (lambda () x)) (x 2)) (f))", "1");
+    CheckRun("(define y 0) (let* () (define y 5) y) y", "0");
+}
+
+void TestLetRec() {
+    CheckRun("(letrec ((ev? (lambda (n) (if (= n 0) #t (od? (- n 1))))) "
+             "         (od? (lambda (n) (if (= n 0) #f (ev? (- n 1)))))) "
+             "  (ev? 100))",
+             "#t");
+}
+
+void TestNamedLet() {
+    CheckRun("(let loop ((i 0) (acc 0)) (if (= i 5) acc (loop (+ i 1) (+ acc i))))", "10");
+    CheckRun("(let loop ((i 0)) (if (< i 1000000) (loop (+ i 1)) i))", "1000000");
+}
+
+void TestDo() {
+    CheckRun("(do ((i 0 (+ i 1)) (acc '() (cons i acc))) ((= i 3) acc))", "(2 1 0)");
+    CheckRun("(define n 0) (do ((i 0 (+ i 1))) ((= i 4)) (set! n (+ n i))) n", "6");
+    CheckRun("(do ((i 0 (+ i 1)) (k 5)) ((= i 3) k) (set! k (+ k 1)))", "8");
+    // Closures made in the body keep the value of their own iteration.
+    CheckRun("(define fs '()) "
+             "(do ((i 0 (+ i 1))) ((= i 3)) (set! fs (cons (lambda () i) fs))) "
+             "(map (lambda (f) (f)) fs)",
+             "(2 1 0)");
+    CheckRun("(do ((i 0 (+ i 1))) ((= i 1000000) i))", "1000000");
+}
+
+void TestCondAndBegin() {
+    CheckRun("(cond ((= 1 2) 'a) ((= 1 1) 'b) (else 'c))", "b");
+    CheckRun("(cond ((= 1 2) 'a) (else 'c))", "c");
+    CheckRun("(cond ((+ 1 2)))", "3");
+    CheckRun("(begin 1 2 3)", "3");
+    CheckRun("(define x 0) (begin (set! x 5) x)", "5");
+}
+
+}  // namespace
+
+int main() {
+    TestLet();
+    TestLetStar();
+    TestLetRec();
+    TestNamedLet();
+    TestDo();
+    TestCondAndBegin();
+    return FinishChecks();
+}
@@ -0,0 +1,68 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "error.h"
+
+namespace {
+
+// Runs the source with the buffer bound to b and checks the printed result.
+void CheckWithBuffer(std::shared_ptr<ForeignBuffer> buffer, const std::string& source,
+                     const std::string& expected) {
+    Interpreter interpreter;
+    try {
+        auto prepared = interpreter.Prepare(source);
+        auto result = Interpreter::ToString(interpreter.Execute(*prepared, {{"b", buffer}}));
+        Check(result == expected, source, "got " + result + ", expected " + expected);
+    } catch (const std::exception& e) {
+        Check(false, source, std::string("threw ") + e.what());
+    }
+}
+
+void TestNumbers() {
+    std::vector<int64_t> numbers = {5, -3, 1LL << 40};
+    auto buffer = std::make_shared<ForeignBuffer>(std::span<const int64_t>(numbers));
+    CheckWithBuffer(buffer, "(buffer? b)", "#t");
+    CheckWithBuffer(buffer, "(buffer-length b)", "3");
+    CheckWithBuffer(buffer, "(buffer-ref b 1)", "-3");
+    CheckWithBuffer(buffer, "(buffer->list b)", "(5 -3 1099511627776)");
+    CheckWithBuffer(buffer, "(define s 0) (buffer-for-each (lambda (x) (set! s (+ s x))) b) s",
+                    "1099511627778");
+    CheckWithBuffer(buffer, "(guard (e (#t 'caught)) (buffer-ref b 3))", "caught");
+    CheckWithBuffer(buffer, "(guard (e (#t 'caught)) (buffer-ref b -1))", "caught");
+    CheckWithBuffer(buffer, "b", "#<buffer>");
+    CheckRun("(buffer? (list 1))", "#f");
+}
+
+// String elements are strings, whatever their text is.
+void TestStrings() {
+    std::vector<std::string> strings = {"a b", "42", "", "x"};
+    auto buffer = std::make_shared<ForeignBuffer>(std::span<const std::string>(strings));
+    CheckWithBuffer(buffer, "(buffer->list b)", "(\"a b\" \"42\" \"\" \"x\")");
+    CheckWithBuffer(buffer, "(symbol? (buffer-ref b 3))", "#f");
+    CheckWithBuffer(buffer, "(number? (buffer-ref b 1))", "#f");
+    CheckWithBuffer(buffer, "(member (buffer-ref b 1) (buffer->list b))", "(\"42\" \"\" \"x\")");
+}
+
+// An owned buffer keeps its data alive after the host drops it.
+void TestOwner() {
+    auto data = std::make_shared<std::vector<int64_t>>(std::vector<int64_t>{7, 8});
+    auto buffer = std::make_shared<ForeignBuffer>(std::span<const int64_t>(*data), data);
+    std::weak_ptr<std::vector<int64_t>> weak = data;
+    data.reset();
+    Check(!weak.expired(), "owned data kept alive");
+    CheckWithBuffer(buffer, "(buffer->list b)", "(7 8)");
+    buffer.reset();
+    Check(weak.expired(), "owned data released with the buffer");
+}
+
+}  // namespace
+
+int main() {
+    TestNumbers();
+    TestStrings();
+    TestOwner();
+    return FinishChecks();
+}
@@ -0,0 +1,111 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "object.h"
+
+namespace {
+
+std::shared_ptr<Cell> MakeNumbers(size_t count, std::shared_ptr<Object> tail = nullptr) {
+    std::vector<std::shared_ptr<Object>> elements;
+    for (size_t i = 0; i < count; ++i) {
+        elements.push_back(New<Number>(i));
+    }
+    return CellChunk::MakeList(elements, std::move(tail));
+}
+
+// A chunked cell holds its car and either its cdr or its chunk, nothing more.
+void TestSize() {
+    Check(sizeof(Cell) == sizeof(void*) + 2 * sizeof(std::shared_ptr<Object>), "size of a cell",
+          std::to_string(sizeof(Cell)));
+}
+
+void TestChunkedCdrs() {
+    auto list = MakeNumbers(3000, New<Number>(-1));
+    size_t count = 0;
+    Cell* last = nullptr;
+    for (Cell* cell = list.get(); cell != nullptr; cell = cell->GetNextCell()) {
+        auto second = cell->GetSecond();
+        Check(second.get() == cell->PeekSecond(), "borrowed cdr " + std::to_string(count));
+        Check(As<Number>(cell->GetFirst())->GetValue() == static_cast<int64_t>(count),
+              "car " + std::to_string(count));
+        last = cell;
+        ++count;
+    }
+    Check(count == 3000, "length of a chunked list", std::to_string(count));
+    Check(Is<Number>(last->GetSecond()), "dotted tail");
+
+    // A cell keeps its chunk and the rest of the list alive.
+    auto middle = As<Cell>(list->GetSecond());
+    for (int i = 0; i < 1500; ++i) {
+        middle = As<Cell>(middle->GetSecond());
+    }
+    list = nullptr;
+    Check(As<Number>(middle->GetFirst())->GetValue() == 1501, "cell outliving the head");
+    Check(CellToVector(middle).size() == 1500, "rest outliving the head");
+}
+
+void TestMutation() {
+    CheckRun("(define l (list 1 2 3 4)) (set-cdr! (cdr l) '(9)) l", "(1 2 9)");
+    CheckRun("(define l (list 1 2 3 4)) (set-car! (cdr (cdr l)) 9) l", "(1 2 9 4)");
+    CheckRun("(define l (list 1 2 3)) (define t (cdr l)) (set-cdr! l '()) (list l t)",
+             "((1) (2 3))");
+    CheckRun("(define l (list 1 2 3)) (set-cdr! (cdr (cdr l)) 5) l", "(1 2 3 . 5)");
+    CheckRun("(pair? (list 1 2))", "#t");
+    CheckRun("(list? (list 1 2 3))", "#t");
+    CheckRun("(define l (list 1 2 3)) (set-cdr! (cdr l) 4) (list? l)", "#f");
+}
+
+// Freezing a cell keeps its cdr, whether it is chunked, owned or null.
+void TestFreeze() {
+    auto list = MakeNumbers(3, New<Cell>(New<Number>(3), nullptr));
+    std::vector<Cell*> cells;
+    for (Cell* cell = list.get(); cell != nullptr; cell = cell->GetNextCell()) {
+        cells.push_back(cell);
+    }
+    for (Cell* cell : cells) {
+        Check(!cell->IsFrozen(), "cell frozen before Freeze");
+        cell->Freeze();
+        Check(cell->IsFrozen(), "cell not frozen");
+    }
+    Check(CellToVector(list).size() == 5, "length of a frozen list");
+    Check(cells[0]->GetNextCell() == cells[1] && cells[2]->GetNextCell() == cells[3],
+          "cdrs of frozen cells");
+    Check(cells[2]->GetSecond().get() == cells[3] && cells[3]->GetSecond() == nullptr,
+          "owned and null cdrs of frozen cells");
+    auto rest = As<Cell>(cells[2]->GetSecond());
+    list = nullptr;
+    Check(As<Number>(rest->GetFirst())->GetValue() == 3, "cdr outliving a frozen cell");
+}
+
+// Freeing a chain of chunks neither recurses per chunk nor per nested list.
+void TestRelease() {
+    std::shared_ptr<Object> chain;
+    for (int i = 0; i < 300000; ++i) {
+        chain = MakeNumbers(2, std::move(chain));
+    }
+    chain = nullptr;
+    std::shared_ptr<Object> nested;
+    for (int i = 0; i < 300000; ++i) {
+        nested = CellChunk::MakeList(std::vector<std::shared_ptr<Object>>{nested, nullptr},
+                                     nullptr);
+    }
+    nested = nullptr;
+    CheckRun("(define (range n acc) (if (= n 0) acc (range (- n 1) (cons n acc)))) "
+             "(define (nest n acc) (if (= n 0) acc (nest (- n 1) (list acc)))) "
+             "(define l (range 300000 '())) (define n (nest 300000 '())) "
+             "(set! l 0) (set! n 0) l",
+             "0");
+}
+
+}  // namespace
+
+int main() {
+    TestSize();
+    TestChunkedCdrs();
+    TestMutation();
+    TestFreeze();
+    TestRelease();
+    return FinishChecks();
+}
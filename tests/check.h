@@ -0,0 +1,65 @@
+#pragma once
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "scheme.h"
+
+// Checks shared by the test programs in this directory. Each of them is a standalone program
+// built with the sources of the interpreter, which reports the failed checks and returns
+// FinishChecks() from main.
+
+inline int failed_checks = 0;
+
+inline void Check(bool ok, const std::string& name, const std::string& details = "") {
+    if (!ok) {
+        std::cerr << "FAILED " << name << (details.empty() ? "" : ": " + details) << "\n";
+        ++failed_checks;
+    }
+}
+
+// Runs the script and checks the printed value of its last form.
+inline void CheckRun(Interpreter* interpreter, const std::string& source,
+                     const std::string& expected) {
+    try {
+        auto result = interpreter->RunScript(source);
+        Check(result == expected, source, "got " + result + ", expected " + expected);
+    } catch (const std::exception& e) {
+        Check(false, source, std::string("threw ") + e.what());
+    }
+}
+
+inline void CheckRun(const std::string& source, const std::string& expected) {
+    Interpreter interpreter;
+    CheckRun(&interpreter, source, expected);
+}
+
+// Runs the script and checks that it throws E, with the given message unless it is empty.
+template <class E>
+void CheckThrows(Interpreter* interpreter, const std::string& source,
+                 const std::string& message = "") {
+    try {
+        auto result = interpreter->RunScript(source);
+        Check(false, source, "returned " + result);
+    } catch (const E& e) {
+        Check(message.empty() || e.what() == message, source, std::string("threw ") + e.what());
+    } catch (const std::exception& e) {
+        Check(false, source, std::string("threw another error: ") + e.what());
+    }
+}
+
+template <class E>
+void CheckThrows(const std::string& source, const std::string& message = "") {
+    Interpreter interpreter;
+    CheckThrows<E>(&interpreter, source, message);
+}
+
+inline int FinishChecks() {
+    if (failed_checks != 0) {
+        std::cerr << failed_checks << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}
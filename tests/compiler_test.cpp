@@ -0,0 +1,70 @@
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "check.h"
+#include "compiler.h"
+#include "error.h"
+#include "parser.h"
+
+// Takes the repository directory to build the module against, the current one by default. The
+// module is built with c++, and the test has to be linked with -rdynamic.
+
+namespace {
+
+const std::string kModule =
+    "(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2))))) "
+    "(define (count n acc) (if (= n 0) acc (count (- n 1) (+ acc 1)))) "
+    "(define (even? n) (if (= n 0) #t (odd? (- n 1)))) "
+    "(define (odd? n) (if (= n 0) #f (even? (- n 1)))) "
+    "(define (first l) (car l)) "
+    "(define (twice f x) (f (f x))) "
+    "(define numbers (list 1 2 3)) "
+    "(define (sum-numbers) (fold-left + 0 numbers)) "
+    "(define (adder n) (lambda (x) (+ x n)))";
+
+const std::string kChecks =
+    "(list (fib 20) (count 1000000 0) (even? 100001) (odd? 7) (first '(5 6)) "
+    "      (twice (lambda (x) (* x 3)) 2) (sum-numbers) ((adder 2) 3) "
+    "      (guard (e (#t (error-object-message e))) (first '())))";
+
+// Builds the module and returns the path of the library, empty if the build failed.
+std::string BuildModule(const std::string& repository) {
+    auto base = "/tmp/scheme_compiler_test_" + std::to_string(getpid());
+    std::ofstream(base + ".cpp") << CompileModule(ReadAll(kModule, 1));
+    auto command = "c++ -std=c++20 -O1 -shared -fPIC -Wno-psabi -I" + repository + " " + base +
+                   ".cpp -o " + base + ".so";
+    bool built = std::system(command.c_str()) == 0;
+    unlink((base + ".cpp").c_str());
+    return built ? base + ".so" : "";
+}
+
+void TestSameAsInterpreted(const std::string& module) {
+    Interpreter interpreted;
+    interpreted.RunScript(kModule);
+    auto expected = interpreted.RunScript(kChecks);
+
+    Interpreter compiled;
+    compiled.LoadModule(module);
+    CheckRun(&compiled, kChecks, expected);
+    Check(Is<CompiledFunction>(compiled.GetScope()->Get("fib")), "fib compiled");
+    Check(Is<CompiledFunction>(compiled.GetScope()->Get("sum-numbers")), "sum-numbers compiled");
+    Check(!Is<CompiledFunction>(compiled.GetScope()->Get("adder")),
+          "function making a closure left to the interpreter");
+    CheckThrows<RuntimeError>(&compiled, "(fib 'x)");
+    CheckThrows<RuntimeError>(&compiled, "(fib 1 2)");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto module = BuildModule(argc > 1 ? argv[1] : ".");
+    Check(!module.empty(), "module built");
+    if (!module.empty()) {
+        TestSameAsInterpreted(module);
+        unlink(module.c_str());
+    }
+    return FinishChecks();
+}
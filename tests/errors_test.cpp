@@ -0,0 +1,61 @@
+#include "check.h"
+#include "error.h"
+
+namespace {
+
+void TestGuard() {
+    CheckRun("(guard (e (#t 'caught)) (car '()))", "caught");
+    CheckRun("(guard (e ((symbol? e) e)) (raise 'oops))", "oops");
+    CheckRun("(guard (e ((number? e) 'number) ((symbol? e) 'symbol)) (raise 'oops))", "symbol");
+    CheckRun("(guard (e (#t (error-object-message e))) (error 'bad-thing 1 2))", "bad-thing");
+    CheckRun("(guard (e (#t (error-object-irritants e))) (error 'bad-thing 1 2))", "(1 2)");
+    CheckRun("(guard (e (#t 'outer)) (guard (e ((number? e) 'inner)) (raise 'oops)))", "outer");
+    CheckRun("(guard (e (#t 'unused)) (+ 1 2))", "3");
+    CheckRun("(guard (e (#t 'caught)) (undefined-name))", "caught");
+}
+
+void TestGuardAndOr() {
+    CheckRun("(guard (e (#t 'caught)) (and (car '()) 1))", "caught");
+    CheckRun("(guard (e (#t 'caught)) (and 1 (car '()) 2))", "caught");
+    CheckRun("(guard (e (#t 'caught)) (or (car '()) 5))", "caught");
+    CheckRun("(guard (e (#t 'caught)) (or #f (raise 'oops)))", "caught");
+    CheckRun("(guard (e (#t 'caught)) (and #f (car '())))", "#f");
+    CheckRun("(guard (e (#t 'caught)) (or 1 (car '())))", "1");
+    CheckRun("(or #f 5 (car '()))", "5");
+    CheckRun("(and 1 2 3)", "3");
+    CheckThrows<RuntimeError>("(and (car '()) 1)");
+    CheckThrows<RuntimeError>("(or (car '()) 5)");
+}
+
+// An error must not stay pending after the evaluation that raised it.
+void TestNoPendingErrorAfterwards() {
+    Interpreter interpreter;
+    CheckThrows<RuntimeError>(&interpreter, "(and (car '()) 1)");
+    CheckRun(&interpreter, "(+ 1 2)", "3");
+    CheckRun(&interpreter, "(guard (e (#t 'caught)) (or (car '()) 5)) (list 1 2)", "(1 2)");
+}
+
+// The message of an error raised with the message of another one outlived its symbol.
+void TestErrorMessageOfCaughtError() {
+    CheckRun("(guard (e (#t (error-object-message e))) "
+             "  (guard (e (#t (error (error-object-message e) 1))) (error 'boom 1)))",
+             "boom");
+}
+
+void TestExceptionKinds() {
+    CheckThrows<NameError>("(undefined-name)", "Unknown variable : undefined-name");
+    CheckThrows<RuntimeError>("(car 1)");
+    CheckThrows<SyntaxError>("(if)");
+    CheckThrows<RuntimeError>("(raise 'oops)");
+}
+
+}  // namespace
+
+int main() {
+    TestGuard();
+    TestGuardAndOr();
+    TestNoPendingErrorAfterwards();
+    TestErrorMessageOfCaughtError();
+    TestExceptionKinds();
+    return FinishChecks();
+}
@@ -0,0 +1,106 @@
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "error.h"
+
+namespace {
+
+void TestBindingsAreIsolated() {
+    Interpreter parent;
+    parent.RunScript("(define x 1) (define (get-x) x)");
+    auto child = parent.Fork();
+    CheckRun(&child, "(set! x 2) (define y 3) (list x (get-x) y)", "(2 2 3)");
+    CheckRun(&parent, "(list x (get-x))", "(1 1)");
+    CheckThrows<NameError>(&parent, "y");
+    CheckRun(&parent, "(set! x 4) (get-x)", "4");
+    CheckRun(&child, "(get-x)", "2");
+    auto other = parent.Fork();
+    CheckRun(&other, "(get-x)", "4");
+}
+
+// Every fork gets the assignments its parent made before it, however many forks came between.
+void TestAssignmentsAcrossForks() {
+    Interpreter parent;
+    parent.RunScript("(define x 0) (define y 0) (define (get) (list x y))");
+    parent.Fork();
+    std::vector<Interpreter> children;
+    for (int i = 1; i <= 100; ++i) {
+        parent.RunScript("(set! x " + std::to_string(i) + ")");
+        if (i % 7 == 0) {
+            parent.RunScript("(set! y " + std::to_string(i) + ")");
+        }
+        children.push_back(parent.Fork());
+    }
+    for (int i = 1; i <= 100; ++i) {
+        auto expected = "(" + std::to_string(i) + " " + std::to_string(i / 7 * 7) + ")";
+        CheckRun(&children[i - 1], "(get)", expected);
+    }
+    auto grandchild = children[49].Fork();
+    CheckRun(&children[49], "(set! x 0) (get)", "(0 49)");
+    CheckRun(&grandchild, "(get)", "(50 49)");
+}
+
+// A closure's captured scope is frozen too, each interpreter counts on its own.
+void TestClosureState() {
+    Interpreter parent;
+    parent.RunScript("(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n)) "
+                     "(define counter (make-counter))");
+    auto first = parent.Fork();
+    auto second = parent.Fork();
+    CheckRun(&first, "(counter) (counter)", "2");
+    CheckRun(&second, "(counter)", "1");
+    CheckRun(&parent, "(counter)", "1");
+}
+
+void TestSharedDataIsFrozen() {
+    Interpreter parent;
+    parent.RunScript("(define l (list 1 2 3)) (define pair (cons 1 2)) "
+                     "(define nested (list (list 1) 2)) "
+                     "(define-record-type point (make-point x y) point? "
+                     "  (x point-x set-point-x!) (y point-y)) "
+                     "(define p (make-point 1 2)) "
+                     "(define get-l (let ((l (list 4 5))) (lambda () l))) "
+                     "(define q (delay (list 6 7)))");
+    auto child = parent.Fork();
+    CheckThrows<RuntimeError>(&child, "(set-car! l 9)",
+                              "set-car! can't change a frozen pair");
+    CheckThrows<RuntimeError>(&child, "(set-cdr! (cdr l) '())",
+                              "set-cdr! can't change a frozen pair");
+    CheckThrows<RuntimeError>(&child, "(set-cdr! pair 3)");
+    CheckThrows<RuntimeError>(&child, "(set-car! (car nested) 3)");
+    CheckThrows<RuntimeError>(&child, "(set-point-x! p 3)",
+                              "set-point-x! can't change a frozen record");
+    CheckThrows<RuntimeError>(&child, "(set-car! (get-l) 3)");
+    CheckThrows<RuntimeError>(&child, "(set-car! (force q) 3)");
+    CheckThrows<RuntimeError>(&parent, "(set-car! l 9)");
+    CheckRun(&parent, "(list l pair nested (point-x p) (get-l) (force q))",
+             "((1 2 3) (1 . 2) ((1) 2) 1 (4 5) (6 7))");
+    CheckRun(&child, "(list? l)", "#t");
+
+    // Data made after the fork is the interpreter's own.
+    CheckRun(&child, "(define m (list 1 2)) (set-car! m 3) (set-cdr! m '()) m", "(3)");
+    CheckRun(&parent, "(define m (cons l l)) (set-car! m 0) (set-point-x! (make-point 1 2) 3) m",
+             "(0 1 2 3)");
+    CheckRun(&child, "(define copy (cons 0 (cdr l))) (set-car! copy 9) copy", "(9 2 3)");
+}
+
+// A promise shared by forks freezes the value whichever of them computes it.
+void TestForcedLater() {
+    Interpreter parent;
+    parent.RunScript("(define q (delay (list 1 2)))");
+    auto child = parent.Fork();
+    CheckRun(&child, "(car (force q))", "1");
+    CheckThrows<RuntimeError>(&parent, "(set-car! (force q) 3)");
+}
+
+}  // namespace
+
+int main() {
+    TestBindingsAreIsolated();
+    TestAssignmentsAcrossForks();
+    TestClosureState();
+    TestSharedDataIsFrozen();
+    TestForcedLater();
+    return FinishChecks();
+}
@@ -0,0 +1,79 @@
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "check.h"
+#include "object.h"
+#include "parser.h"
+
+namespace {
+
+// Whether the body of (lambda (x) body...) may capture the scope of a call.
+bool MayCapture(const std::string& lambda) {
+    std::stringstream in(lambda);
+    Tokenizer tokenizer(&in);
+    auto form = As<Cell>(Read(&tokenizer));
+    auto body = As<Cell>(As<Cell>(form->GetSecond())->GetSecond());
+    return LambdaCode({"x"}, body).MayCapture();
+}
+
+void TestMayCapture() {
+    Check(!MayCapture("(lambda (x) (+ x 1))"), "arithmetic");
+    Check(!MayCapture("(lambda (x) (if (< x 2) x (+ (f (- x 1)) (f (- x 2)))))"), "recursion");
+    Check(!MayCapture("(lambda (x) (let ((y 1)) (set! x y) (list x y)))"), "let");
+    Check(MayCapture("(lambda (x) (lambda () x))"), "lambda");
+    Check(MayCapture("(lambda (x) (list (delay x)))"), "delay");
+    Check(MayCapture("(lambda (x) (cons-stream x x))"), "cons-stream");
+    Check(MayCapture("(lambda (x) (stream-map f x))"), "stream-map");
+    Check(MayCapture("(lambda (x) (define (g) x) g)"), "define of a procedure");
+    Check(!MayCapture("(lambda (x) (define g x) g)"), "define of a value");
+    Check(MayCapture("(lambda (x) (let loop ((i 0)) (loop i)))"), "named let");
+    Check(MayCapture("(lambda (x) (if x (begin (cond (else (lambda () 1))))))"), "nested");
+}
+
+void TestFramesAreReused() {
+    auto parent = std::make_shared<Scope>(nullptr);
+    auto frame = NewReusableFrame(parent);
+    frame->Define("a", New<Number>(1));
+    Scope* first = frame.get();
+    frame = nullptr;
+    frame = NewReusableFrame(parent);
+    Check(frame.get() == first, "frame reused");
+    Check(frame->IsEmpty() && frame->GetParent() == parent, "reused frame emptied");
+    std::shared_ptr<Object> value;
+    Check(!frame->Lookup("a", &value), "binding of the previous call gone");
+    // A frame something still refers to isn't handed out again.
+    auto kept = frame;
+    frame = nullptr;
+    frame = NewReusableFrame(parent);
+    Check(frame.get() != kept.get(), "kept frame not reused");
+}
+
+void TestCalls() {
+    CheckRun("(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2))))) (fib 20)", "6765");
+    CheckRun("(define (adder n) (lambda (x) (+ x n))) ((adder 2) 3)", "5");
+    CheckRun("(define (count n) (let loop ((i 0)) (if (< i n) (loop (+ i 1)) i))) (count 1000)",
+             "1000");
+    CheckRun("(define (f x) (define y (* x 2)) (+ x y)) (list (f 1) (f 2))", "(3 6)");
+    CheckRun("(define (loop i) (if (= i 0) 'done (loop (- i 1)))) (loop 1000000)", "done");
+}
+
+// A closure made through an alias of lambda isn't seen by the scan, but keeps its scope valid.
+void TestEscapeThroughAlias() {
+    CheckRun("(define mk lambda) (define (f x) (mk () x)) "
+             "(define a (f 1)) (define b (f 2)) (f 3) (list (a) (b))",
+             "(1 2)");
+    CheckRun("(define mk delay) (define (f x) (mk x)) "
+             "(define a (f 1)) (define b (f 2)) (list (force a) (force b))",
+             "(1 2)");
+}
+
+}  // namespace
+
+int main() {
+    TestMayCapture();
+    TestFramesAreReused();
+    TestCalls();
+    TestEscapeThroughAlias();
+    return FinishChecks();
+}
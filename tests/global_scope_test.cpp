@@ -0,0 +1,45 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "error.h"
+#include "parallel.h"
+
+namespace {
+
+void TestFrozen() {
+    Check(GetGlobalScope()->IsFrozen(), "global scope frozen");
+    CheckRun("(set! car cdr) (car '(1 2))", "(2)");
+    CheckRun("(car '(1 2))", "1");
+    CheckRun("(define (list a b) 'mine) (list 1 2)", "mine");
+    CheckRun("(list 1 2)", "(1 2)");
+}
+
+// Interpreters on many threads share the global scope, each script sees its own changes only.
+void TestManyThreads() {
+    std::vector<std::string> results(64);
+    ParallelFor(results.size(), 8, [&](size_t i) {
+        Interpreter interpreter;
+        std::string source = i % 2 ? "(set! + -) " : "";
+        source += "(define (sum n acc) (if (= n 0) acc (sum (- n 1) (+ acc " +
+                  std::to_string(i) + ")))) (sum 1000 0)";
+        try {
+            results[i] = interpreter.RunScript(source);
+        } catch (const std::exception& error) {
+            results[i] = error.what();
+        }
+    });
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto expected = std::to_string((i % 2 ? -1000 : 1000) * static_cast<int64_t>(i));
+        Check(results[i] == expected, "script " + std::to_string(i), results[i]);
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestFrozen();
+    TestManyThreads();
+    return FinishChecks();
+}
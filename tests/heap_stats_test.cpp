@@ -0,0 +1,78 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "check.h"
+#include "heap_stats.h"
+
+namespace {
+
+const std::string kRange =
+    "(define (range n acc) (if (= n 0) acc (range (- n 1) (cons n acc)))) ";
+
+void TestDisabled() {
+    SetHeapStatsEnabled(false);
+    auto before = GetHeapStats();
+    CheckRun(kRange + "(length (range 1000 '()))", "1000");
+    auto after = GetHeapStats();
+    Check(after[ObjectType::CELL].allocations == before[ObjectType::CELL].allocations,
+          "cells counted while disabled");
+}
+
+void TestLiveObjects() {
+    SetHeapStatsEnabled(true);
+    Interpreter interpreter;
+    interpreter.RunScript(kRange);
+    auto before = GetHeapStats();
+    interpreter.RunScript("(define l (range 1000 '()))");
+    auto run = interpreter.GetLastRunHeapStats();
+    Check(run[ObjectType::CELL].allocations >= 1000, "cells allocated by the run",
+          std::to_string(run[ObjectType::CELL].allocations));
+    auto held = GetHeapStats() - before;
+    Check(held[ObjectType::CELL].live_objects >= 1000, "live cells",
+          std::to_string(held[ObjectType::CELL].live_objects));
+    Check(held.peak_live_bytes >= GetHeapStats().live_bytes, "peak below the live bytes");
+    interpreter.RunScript("(set! l 0)");
+    auto freed = GetHeapStats() - before;
+    Check(freed[ObjectType::CELL].live_objects <= 0, "cells freed",
+          std::to_string(freed[ObjectType::CELL].live_objects));
+    SetHeapStatsEnabled(false);
+}
+
+void TestBuiltin() {
+    SetHeapStatsEnabled(true);
+    CheckRun("(map car (heap-stats))",
+             "(number boolean symbol cell lambda scope other live-bytes peak-live-bytes)");
+    // Live cells.
+    CheckRun("(define l (list 1 2 3)) (> (list-ref (list-ref (heap-stats) 3) 2) 0)", "#t");
+    SetHeapStatsEnabled(false);
+}
+
+void TestMetrics() {
+    SetHeapStatsEnabled(true);
+    std::stringstream metrics;
+    WriteHeapStatsMetrics(metrics, GetHeapStats());
+    Check(metrics.str().find("scheme_heap_live_objects{type=\"cell\"} ") != std::string::npos,
+          "live cells metric", metrics.str());
+    auto path = "/tmp/scheme_heap_stats_test_" + std::to_string(getpid()) + ".prom";
+    ExportHeapStats(path);
+    std::ifstream file(path);
+    std::string exported((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    Check(exported.find("scheme_heap_peak_live_bytes ") != std::string::npos &&
+              exported.find("scheme_slab_reserved_blocks") != std::string::npos,
+          "exported metrics", exported);
+    unlink(path.c_str());
+    SetHeapStatsEnabled(false);
+}
+
+}  // namespace
+
+int main() {
+    TestDisabled();
+    TestLiveObjects();
+    TestBuiltin();
+    TestMetrics();
+    return FinishChecks();
+}
@@ -0,0 +1,69 @@
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "object.h"
+
+namespace {
+
+std::shared_ptr<const LambdaCode> GetCode(const std::shared_ptr<Cell>& form, int* builds) {
+    return LambdaCode::Get(form, [&]() -> std::optional<LambdaCode> {
+        ++*builds;
+        return LambdaCode({"x"}, As<Cell>(form->GetSecond()));
+    });
+}
+
+void TestSharedByClosures() {
+    auto form = New<Cell>(New<Symbol>("x"), New<Cell>(New<Number>(1), nullptr));
+    int builds = 0;
+    auto first = GetCode(form, &builds);
+    auto second = GetCode(form, &builds);
+    Check(builds == 1, "code built once", std::to_string(builds));
+    Check(first == second, "closures share the code");
+    // Nothing is cached when the build fails.
+    auto other = New<Cell>(nullptr, nullptr);
+    Check(LambdaCode::Get(other, [] { return std::optional<LambdaCode>(); }) == nullptr,
+          "failed build");
+    Check(GetCode(other, &builds) != nullptr && builds == 2, "build after a failed one");
+}
+
+// A form freed and replaced by another cell at the same address mustn't get its code.
+void TestFormsAreNotConfused() {
+    int builds = 0;
+    std::vector<std::shared_ptr<const LambdaCode>> codes;
+    for (int i = 0; i < 1000; ++i) {
+        auto body = New<Cell>(New<Number>(i), nullptr);
+        auto code = GetCode(New<Cell>(nullptr, body), &builds);
+        Check(code->GetCommands().size() == 1 && code->GetCommands()[0] == body->GetFirst(),
+              "code of form " + std::to_string(i));
+        codes.push_back(std::move(code));
+    }
+    Check(builds == 1000, "code built for every form", std::to_string(builds));
+    // The code outlives its form.
+    Check(codes[0]->GetCommands()[0] != nullptr, "code of a freed form");
+}
+
+void TestClosures() {
+    CheckRun("(define (adder n) (lambda (x) (+ x n))) "
+             "(define add1 (adder 1)) (define add5 (adder 5)) "
+             "(list (add1 1) (add5 1) ((adder 10) 1))",
+             "(2 6 11)");
+    CheckRun("(define (make) (lambda (x) x)) "
+             "(define (loop i) (if (= i 0) ((make) 7) (begin ((make) i) (loop (- i 1))))) "
+             "(loop 100000)",
+             "7");
+    CheckRun("(define (count n) (let loop ((i 0)) (if (< i n) (loop (+ i 1)) i))) "
+             "(list (count 5) (count 10))",
+             "(5 10)");
+}
+
+}  // namespace
+
+int main() {
+    TestSharedByClosures();
+    TestFormsAreNotConfused();
+    TestClosures();
+    return FinishChecks();
+}
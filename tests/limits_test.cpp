@@ -0,0 +1,75 @@
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "check.h"
+#include "error.h"
+
+namespace {
+
+const std::string kLoop = "(let loop () (loop))";
+const std::string kDepth = "(define (depth n) (if (= n 0) 0 (+ 1 (depth (- n 1))))) ";
+
+void TestSteps() {
+    Interpreter interpreter;
+    interpreter.SetLimits({.max_steps = 10000});
+    CheckThrows<LimitError>(&interpreter, kLoop, "Evaluation step limit exceeded");
+    // Every run gets the whole budget.
+    for (int i = 0; i < 3; ++i) {
+        CheckRun(&interpreter, "(let loop ((i 0)) (if (< i 500) (loop (+ i 1)) i))", "500");
+    }
+    // Limits can't be caught by the script.
+    CheckThrows<LimitError>(&interpreter, "(guard (e (#t 'caught)) " + kLoop + ")",
+                            "Evaluation step limit exceeded");
+    CheckRun(&interpreter, "(+ 1 2)", "3");
+}
+
+void TestMemory() {
+    const std::string grow = "(let loop ((l '())) (loop (cons 1 l)))";
+    Interpreter bytes;
+    bytes.SetLimits({.max_allocated_bytes = 1 << 20});
+    CheckThrows<LimitError>(&bytes, grow, "Evaluation memory limit exceeded");
+    CheckRun(&bytes, "(length (list 1 2 3))", "3");
+    Interpreter objects;
+    objects.SetLimits({.max_allocated_objects = 10000});
+    CheckThrows<LimitError>(&objects, grow, "Evaluation memory limit exceeded");
+    CheckThrows<LimitError>(&objects,
+                            "(define (range n) (if (= n 0) '() (cons n (range (- n 1))))) "
+                            "(range 100000)",
+                            "Evaluation memory limit exceeded");
+}
+
+void TestDepth() {
+    Interpreter interpreter;
+    interpreter.SetLimits({.max_depth = 1000});
+    interpreter.RunScript(kDepth);
+    CheckRun(&interpreter, "(depth 100)", "100");
+    CheckThrows<LimitError>(&interpreter, "(depth 100000)",
+                            "Evaluation recursion depth limit exceeded");
+    // Tail calls don't count.
+    CheckRun(&interpreter, "(let loop ((i 0)) (if (< i 100000) (loop (+ i 1)) i))", "100000");
+}
+
+void TestCancellation() {
+    Interpreter interpreter;
+    auto handle = interpreter.GetCancellationHandle();
+    std::thread canceller([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        handle->Cancel();
+    });
+    CheckThrows<LimitError>(&interpreter, kLoop, "Evaluation was cancelled");
+    canceller.join();
+    CheckThrows<LimitError>(&interpreter, kLoop, "Evaluation was cancelled");
+    handle->Reset();
+    CheckRun(&interpreter, "(+ 1 2)", "3");
+}
+
+}  // namespace
+
+int main() {
+    TestSteps();
+    TestMemory();
+    TestDepth();
+    TestCancellation();
+    return FinishChecks();
+}
@@ -0,0 +1,85 @@
+#include <string>
+
+#include "check.h"
+#include "error.h"
+
+namespace {
+
+void TestAccess() {
+    CheckRun("(list-ref (list 1 2 3) 0)", "1");
+    CheckRun("(list-ref (list 1 2 3) 2)", "3");
+    CheckRun("(list-tail (list 1 2 3) 1)", "(2 3)");
+    CheckRun("(list-tail (list 1 2 3) 3)", "()");
+    CheckThrows<RuntimeError>("(list-ref (list 1 2 3) 3)",
+                              "Function is trying to access non-existent element");
+    CheckThrows<RuntimeError>("(list-ref (list 1 2 3) -1)",
+                              "Function is trying to access non-existent element");
+    CheckThrows<RuntimeError>("(list-tail (list 1 2 3) -1)",
+                              "Function is trying to access non-existent element");
+    CheckThrows<RuntimeError>("(list-tail (list 1 2 3) 4)",
+                              "Function is trying to access non-existent element");
+}
+
+void TestBuiltins() {
+    CheckRun("(length '())", "0");
+    CheckRun("(length (list 1 2 3))", "3");
+    CheckRun("(append (list 1 2) '() (list 3) (list 4 5))", "(1 2 3 4 5)");
+    CheckRun("(append)", "()");
+    CheckRun("(reverse (list 1 2 3))", "(3 2 1)");
+    CheckRun("(map (lambda (x) (* x x)) (list 1 2 3))", "(1 4 9)");
+    CheckRun("(map + (list 1 2) (list 10 20))", "(11 22)");
+    CheckRun("(filter (lambda (x) (> x 1)) (list 1 2 3))", "(2 3)");
+    CheckRun("(fold-left - 0 (list 1 2 3))", "-6");
+    CheckRun("(fold-right cons '() (list 1 2 3))", "(1 2 3)");
+    CheckRun("(define s 0) (for-each (lambda (x) (set! s (+ s x))) (list 1 2 3)) s", "6");
+    CheckRun("(member 2 (list 1 2 3))", "(2 3)");
+    CheckRun("(member 5 (list 1 2 3))", "#f");
+    CheckRun("(assoc 2 (list (cons 1 'a) (cons 2 'b)))", "(2 . b)");
+    CheckRun("(sort (list 3 1 2) <)", "(1 2 3)");
+    CheckRun("(sort (list 3 1 2) >)", "(3 2 1)");
+    CheckThrows<RuntimeError>("(map car (list 1 2))");
+    // Streams aren't proper lists, but stream-map takes them.
+    CheckRun("(define (from n) (cons-stream n (from (+ n 1)))) "
+             "(stream->list 3 (stream-map + (from 1) (from 10)))",
+             "(11 13 15)");
+}
+
+void TestCircularLists() {
+    const std::string circular = "(define l (list 1 2 3)) (set-cdr! (cdr (cdr l)) l) ";
+    for (std::string call : {"(length l)", "(reverse l)", "(append l (list 4))",
+                             "(list-ref l 5)", "(list-tail l 1)", "(filter number? l)",
+                             "(fold-left + 0 l)", "(sort l <)"}) {
+        CheckThrows<RuntimeError>(circular + call);
+    }
+    CheckThrows<RuntimeError>(circular + "(length l)", "Function requires a proper list");
+}
+
+void TestLongLists() {
+    CheckRun("(define (range n acc) (if (= n 0) acc (range (- n 1) (cons n acc)))) "
+             "(define l (range 200000 '())) "
+             "(list (length l) (fold-left + 0 l) (length (reverse (map (lambda (x) x) l))))",
+             "(200000 20000100000 200000)");
+}
+
+// Walking a list costs a step per element, so a step limit stops a long walk.
+void TestWalksAreCharged() {
+    Interpreter interpreter;
+    interpreter.RunScript(
+        "(define (range n acc) (if (= n 0) acc (range (- n 1) (cons n acc)))) "
+        "(define l (range 100000 '()))");
+    interpreter.SetLimits({.max_steps = 10000});
+    CheckThrows<LimitError>(&interpreter, "(length l)");
+    CheckThrows<LimitError>(&interpreter, "(reverse l)");
+    CheckRun(&interpreter, "(length (list 1 2 3))", "3");
+}
+
+}  // namespace
+
+int main() {
+    TestAccess();
+    TestBuiltins();
+    TestCircularLists();
+    TestLongLists();
+    TestWalksAreCharged();
+    return FinishChecks();
+}
@@ -0,0 +1,52 @@
+#include <memory>
+#include <string>
+
+#include "check.h"
+#include "error.h"
+#include "native.h"
+
+namespace {
+
+int64_t Add(int64_t a, int64_t b) {
+    return a + b;
+}
+
+void TestTypes() {
+    Interpreter interpreter;
+    interpreter.Register("add", Add);
+    interpreter.Register("negate", [](bool value) { return !value; });
+    interpreter.Register("greet", [](const std::string& name) { return "hello-" + name; });
+    interpreter.Register("first", [](std::shared_ptr<Object> list) {
+        return As<Cell>(list)->GetFirst();
+    });
+    int64_t total = 0;
+    interpreter.Register("accumulate", [&total](int64_t value) { total += value; });
+    CheckRun(&interpreter, "(add 2 (add 3 4))", "9");
+    CheckRun(&interpreter, "(negate (negate #f))", "#f");
+    CheckRun(&interpreter, "(greet 'world)", "hello-world");
+    CheckRun(&interpreter, "(first '(1 2))", "1");
+    CheckRun(&interpreter, "(accumulate 5) (accumulate 7) (map add '(1 2) '(10 20))", "(11 22)");
+    Check(total == 12, "void function called", std::to_string(total));
+}
+
+void TestErrors() {
+    Interpreter interpreter;
+    interpreter.Register("add", Add);
+    CheckThrows<RuntimeError>(&interpreter, "(add 1)");
+    CheckThrows<RuntimeError>(&interpreter, "(add 1 2 3)");
+    CheckThrows<RuntimeError>(&interpreter, "(add 1 'x)",
+                              "Function requires integer only arguments");
+    CheckThrows<RuntimeError>(&interpreter, "(add 1 (car '()))");
+    CheckRun(&interpreter, "(guard (e (#t 'caught)) (add 1 'x))", "caught");
+    CheckRun(&interpreter, "(guard (e (#t 'caught)) (add 1))", "caught");
+    CheckRun(&interpreter, "(guard (e (#t (error-object-message e))) (map add '(1) '(a)))",
+             "Function requires integer only arguments");
+}
+
+}  // namespace
+
+int main() {
+    TestTypes();
+    TestErrors();
+    return FinishChecks();
+}
@@ -0,0 +1,117 @@
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "error.h"
+
+namespace {
+
+int64_t ExecuteNumber(Interpreter* interpreter, const PreparedExpression& expression,
+                      const Bindings& bindings) {
+    return As<Number>(interpreter->Execute(expression, bindings))->GetValue();
+}
+
+void TestBindings() {
+    Interpreter interpreter;
+    interpreter.RunScript("(define scale 10)");
+    auto expression = interpreter.Prepare("(define y (* x scale)) (+ y 1)");
+    for (int64_t x = 0; x < 100; ++x) {
+        auto result = ExecuteNumber(&interpreter, *expression, {{"x", New<Number>(x)}});
+        Check(result == x * 10 + 1, "value for x = " + std::to_string(x), std::to_string(result));
+    }
+    CheckThrows<NameError>(&interpreter, "y");
+    auto list = interpreter.Execute(*interpreter.Prepare("(cons a b)"),
+                                    {{"a", New<Number>(1)}, {"b", nullptr}});
+    Check(Interpreter::ToString(list) == "(1)", "structured result");
+}
+
+// The code of the procedures is built by Prepare, not by the first execution.
+void TestCodeIsBuilt() {
+    Interpreter interpreter;
+    auto expression = interpreter.Prepare("(define (square x) (* x x)) "
+                                          "((lambda (y) (square y)) "
+                                          " (let loop ((i 0)) (if (< i n) (loop (+ i 1)) i)))");
+    int builds = 0;
+    auto count = [&] {
+        ++builds;
+        return std::optional<LambdaCode>();
+    };
+    const auto& forms = expression->GetForms();
+    auto lambda = As<Cell>(As<Cell>(forms[1])->GetFirst());
+    auto let = As<Cell>(As<Cell>(As<Cell>(forms[1])->GetSecond())->GetFirst());
+    for (const auto& form : {As<Cell>(forms[0]), lambda, let}) {
+        Check(LambdaCode::Get(form, count) != nullptr, "code of " + Interpreter::ToString(form));
+    }
+    Check(builds == 0, "code built at execution", std::to_string(builds));
+    Check(ExecuteNumber(&interpreter, *expression, {{"n", New<Number>(7)}}) == 49, "execution");
+}
+
+void TestMalformedForms() {
+    Interpreter interpreter;
+    auto lambda = interpreter.Prepare("(lambda (1) 1)");
+    auto let = interpreter.Prepare("(let loop (x) x)");
+    try {
+        interpreter.Execute(*lambda);
+        Check(false, "malformed lambda executed");
+    } catch (const RuntimeError&) {
+    }
+    try {
+        interpreter.Execute(*let);
+        Check(false, "malformed named let executed");
+    } catch (const SyntaxError&) {
+    }
+    CheckRun(&interpreter, "(+ 1 2)", "3");
+}
+
+// An execution can't change the literals of the next one.
+void TestLiteralsAreFrozen() {
+    Interpreter interpreter;
+    auto expression = interpreter.Prepare("(define l '(1 2)) (set-car! l n) l");
+    try {
+        interpreter.Execute(*expression, {{"n", New<Number>(5)}});
+        Check(false, "literal changed");
+    } catch (const RuntimeError& error) {
+        Check(std::string(error.what()) == "set-car! can't change a frozen pair",
+              "error changing a literal", error.what());
+    }
+    auto copy = interpreter.Prepare("(define l (list 1 2)) (set-car! l n) l");
+    auto result = interpreter.Execute(*copy, {{"n", New<Number>(5)}});
+    Check(Interpreter::ToString(result) == "(5 2)", "fresh list changed");
+}
+
+void TestSharedByThreads() {
+    Interpreter parent;
+    parent.RunScript("(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))");
+    auto expression = parent.Prepare("(define (twice x) (* 2 x)) (twice (fib n))");
+    std::vector<std::thread> threads;
+    std::vector<int64_t> results(4);
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&, i, child = parent.Fork()]() mutable {
+            for (int j = 0; j < 20; ++j) {
+                results[i] = ExecuteNumber(&child, *expression, {{"n", New<Number>(15 + i)}});
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const int64_t kFib[] = {610, 987, 1597, 2584};
+    for (size_t i = 0; i < results.size(); ++i) {
+        Check(results[i] == 2 * kFib[i], "result of thread " + std::to_string(i),
+              std::to_string(results[i]));
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestBindings();
+    TestCodeIsBuilt();
+    TestMalformedForms();
+    TestLiteralsAreFrozen();
+    TestSharedByThreads();
+    return FinishChecks();
+}
@@ -0,0 +1,67 @@
+#include <csignal>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "check.h"
+#include "profiler.h"
+
+namespace {
+
+const std::string kFib =
+    "(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2))))) ";
+
+void TestSamples() {
+    Profiler profiler(std::chrono::microseconds(200));
+    profiler.Start();
+    CheckRun(kFib + "(fib 22)", "17711");
+    profiler.Stop();
+    std::stringstream folded;
+    profiler.WriteFolded(folded);
+    std::string line;
+    bool found = false;
+    while (std::getline(folded, line)) {
+        found = found || line.find("fib;") != std::string::npos;
+    }
+    Check(found, "fib sampled", folded.str());
+}
+
+void TestOnlyOneRuns() {
+    Profiler first;
+    Profiler second;
+    first.Start();
+    try {
+        second.Start();
+        Check(false, "second profiler started");
+    } catch (const std::runtime_error&) {
+    }
+    first.Stop();
+    second.Start();
+    second.Stop();
+}
+
+// Timers fire until they are deleted, so a signal can still arrive after Stop. It must not
+// reach the default action, which would kill the process.
+void TestStopWhileBusy() {
+    Interpreter interpreter;
+    interpreter.RunScript(kFib);
+    for (int i = 0; i < 50; ++i) {
+        Profiler profiler(std::chrono::microseconds(50));
+        profiler.Start();
+        CheckRun(&interpreter, "(fib 12)", "144");
+        profiler.Stop();
+    }
+    struct sigaction action {};
+    sigaction(SIGPROF, nullptr, &action);
+    Check(action.sa_handler != SIG_DFL, "SIGPROF handled after Stop");
+    std::raise(SIGPROF);
+}
+
+}  // namespace
+
+int main() {
+    TestSamples();
+    TestOnlyOneRuns();
+    TestStopWhileBusy();
+    return FinishChecks();
+}
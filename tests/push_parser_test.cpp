@@ -0,0 +1,117 @@
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "error.h"
+#include "parser.h"
+
+namespace {
+
+const std::string kInput =
+    "(define (f x) (+ x 12345)) 'quoted -17 +5 + symbol-name #t #f "
+    "\"a string (with) \\\"escapes\\\"\" (1 . 2) ((nested (list)) ' x) ()\n(f 1)";
+
+std::vector<std::string> ReadSequentially(const std::string& input) {
+    std::stringstream stream(input);
+    Tokenizer tokenizer(&stream);
+    std::vector<std::string> data;
+    while (!tokenizer.IsEnd()) {
+        data.push_back(Interpreter::ToString(Read(&tokenizer)));
+    }
+    return data;
+}
+
+std::vector<std::string> Take(PushParser* parser) {
+    std::vector<std::string> data;
+    std::shared_ptr<Object> datum;
+    while (parser->Poll(&datum)) {
+        data.push_back(Interpreter::ToString(datum));
+    }
+    return data;
+}
+
+// Every chunk size gives the data the tokenizer reads from the whole input.
+void TestChunks() {
+    auto expected = ReadSequentially(kInput);
+    for (size_t size = 1; size <= kInput.size(); ++size) {
+        PushParser parser;
+        std::vector<std::string> data;
+        for (size_t begin = 0; begin < kInput.size(); begin += size) {
+            parser.Feed(std::string_view(kInput).substr(begin, size));
+            for (auto& datum : Take(&parser)) {
+                data.push_back(std::move(datum));
+            }
+        }
+        parser.Finish();
+        for (auto& datum : Take(&parser)) {
+            data.push_back(std::move(datum));
+        }
+        Check(data == expected, "chunks of " + std::to_string(size));
+    }
+}
+
+// A datum can be taken as soon as its last byte is fed, a token only once it can't continue.
+void TestEarlyData() {
+    PushParser parser;
+    parser.Feed(std::string_view("(a b) 12"));
+    Check(Take(&parser) == std::vector<std::string>{"(a b)"}, "list taken before the number");
+    parser.Feed(std::string_view("3 "));
+    Check(Take(&parser) == std::vector<std::string>{"123"}, "number taken once ended");
+    parser.Feed(std::string_view("sym"));
+    parser.Finish();
+    Check(Take(&parser) == std::vector<std::string>{"sym"}, "symbol taken at the end");
+}
+
+void TestErrors() {
+    PushParser parser;
+    try {
+        parser.Feed(std::string_view("(1 2) (3 . 4 5) (6"));
+        Check(false, "malformed datum parsed");
+    } catch (const SyntaxError&) {
+    }
+    Check(Take(&parser) == std::vector<std::string>{"(1 2)"}, "datum before the error");
+    parser.Feed(std::string_view("(7 8) "));
+    Check(Take(&parser) == std::vector<std::string>{"(7 8)"}, "datum after the error");
+    parser.Feed(std::string_view("(1 (2"));
+    try {
+        parser.Finish();
+        Check(false, "unfinished datum parsed");
+    } catch (const SyntaxError& error) {
+        Check(std::string(error.what()) == "Bracket sequence is not correct", "unfinished list",
+              error.what());
+    }
+}
+
+// Forms are evaluated as soon as they have arrived.
+void TestRunStream() {
+    Interpreter interpreter;
+    std::vector<std::string> chunks = {"(define (sq", "uare x) (* x x))", " (define n (square 1",
+                                       "2))", " (+ n 1)"};
+    size_t next = 0;
+    std::string defined_before_last;
+    auto result = interpreter.RunStream([&](std::string* chunk) {
+        if (next == chunks.size()) {
+            return false;
+        }
+        if (next + 1 == chunks.size()) {
+            defined_before_last = interpreter.RunScript("n");
+        }
+        *chunk = chunks[next++];
+        return true;
+    });
+    Check(result == "145", "result of a stream", result);
+    Check(defined_before_last == "144", "form evaluated on arrival", defined_before_last);
+    CheckThrows<SyntaxError>(&interpreter, "(+ 1");
+}
+
+}  // namespace
+
+int main() {
+    TestChunks();
+    TestEarlyData();
+    TestErrors();
+    TestRunStream();
+    return FinishChecks();
+}
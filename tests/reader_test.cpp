@@ -0,0 +1,94 @@
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "error.h"
+#include "parallel.h"
+#include "parser.h"
+
+namespace {
+
+// Data of every kind, with brackets, blanks and quotes inside strings that mustn't split it.
+std::string MakeInput(size_t count) {
+    std::string input;
+    for (size_t i = 0; i < count; ++i) {
+        auto n = std::to_string(i);
+        input += "(" + n + " (nested \"a ( b\" 'x) . -" + n + ")\n'" + n + " \"s) \\\" (\"\t";
+        input += i % 10 == 0 ? "'\n(quoted " + n + ")\n" : "sym" + n + " ";
+    }
+    return input;
+}
+
+std::vector<std::string> ReadSequentially(const std::string& input) {
+    std::stringstream stream(input);
+    Tokenizer tokenizer(&stream);
+    std::vector<std::string> data;
+    while (!tokenizer.IsEnd()) {
+        data.push_back(Interpreter::ToString(Read(&tokenizer)));
+    }
+    return data;
+}
+
+void TestSameAsSequential() {
+    auto input = MakeInput(20000);
+    auto expected = ReadSequentially(input);
+    for (size_t threads : {0, 1, 3, 8}) {
+        auto data = ReadAll(input, threads);
+        bool same = data.size() == expected.size();
+        for (size_t i = 0; same && i < data.size(); ++i) {
+            same = Interpreter::ToString(data[i]) == expected[i];
+        }
+        Check(same, "data read by " + std::to_string(threads) + " threads",
+              std::to_string(data.size()) + " of " + std::to_string(expected.size()));
+    }
+    Check(ReadAll("", 4).empty(), "empty input");
+}
+
+// The error of the earliest malformed datum is reported.
+void TestErrors() {
+    auto input = MakeInput(10000) + " (a . b c) " + MakeInput(10000) + " ) ";
+    try {
+        ReadAll(input, 4);
+        Check(false, "malformed input read");
+    } catch (const SyntaxError& error) {
+        Check(std::string(error.what()) == "Scheme pair can only be used at the end of the list",
+              "error of the earliest datum", error.what());
+    }
+    try {
+        ReadAll(MakeInput(10000) + " (unfinished", 4);
+        Check(false, "unfinished input read");
+    } catch (const SyntaxError&) {
+    }
+}
+
+void TestParallelFor() {
+    std::vector<std::atomic<int>> calls(1000);
+    ParallelFor(calls.size(), 4, [&](size_t i) { ++calls[i]; });
+    bool once = true;
+    for (const auto& count : calls) {
+        once = once && count == 1;
+    }
+    Check(once, "every index handed out once");
+    try {
+        ParallelFor(100, 4, [&](size_t i) {
+            if (i == 50) {
+                throw std::runtime_error("fifty");
+            }
+        });
+        Check(false, "exception rethrown");
+    } catch (const std::runtime_error& error) {
+        Check(std::string(error.what()) == "fifty", "rethrown exception", error.what());
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestSameAsSequential();
+    TestErrors();
+    TestParallelFor();
+    return FinishChecks();
+}
@@ -0,0 +1,56 @@
+#include <string>
+
+#include "check.h"
+#include "error.h"
+
+namespace {
+
+const std::string kPoint =
+    "(define-record-type point (make-point x y) point? "
+    "  (x point-x set-point-x!) (y point-y set-point-y!)) ";
+
+void TestRecords() {
+    CheckRun(kPoint + "(define p (make-point 1 2)) (list (point-x p) (point-y p))", "(1 2)");
+    CheckRun(kPoint + "(define p (make-point 1 2)) (set-point-x! p 10) (point-x p)", "10");
+    CheckRun(kPoint + "(list (point? (make-point 1 2)) (point? '(1 2)) (point? 1))", "(#t #f #f)");
+    CheckRun(kPoint + "(make-point 1 (make-point 2 3))", "#<record point 1 #<record point 2 3>>");
+    CheckRun(kPoint + "point", "#<record-type point>");
+    CheckRun(kPoint + "(map point-x (list (make-point 1 2) (make-point 3 4)))", "(1 3)");
+    // Fields left out of the constructor start empty.
+    CheckRun("(define-record-type node (make-node value) node? (value node-value) "
+             "  (next node-next set-node-next!)) "
+             "(define n (make-node 1)) (set-node-next! n (make-node 2)) "
+             "(node-value (node-next n))",
+             "2");
+}
+
+// Records of different types with the same fields aren't mistaken for each other.
+void TestTypes() {
+    const std::string types = kPoint + "(define-record-type pair (make-pair x y) pair-record? "
+                                       "  (x pair-x) (y pair-y)) ";
+    CheckRun(types + "(point? (make-pair 1 2))", "#f");
+    CheckThrows<RuntimeError>(types + "(point-x (make-pair 1 2))",
+                              "point-x requires a record of point");
+    CheckThrows<RuntimeError>(types + "(set-point-x! (make-pair 1 2) 3)",
+                              "set-point-x! requires a record of point");
+    CheckRun(types + "(guard (e (#t 'caught)) (point-y 5))", "caught");
+}
+
+void TestErrors() {
+    CheckThrows<RuntimeError>(kPoint + "(make-point 1)");
+    CheckThrows<SyntaxError>("(define-record-type point (make-point x z) point? (x point-x))",
+                             "Unknown record field z");
+    CheckThrows<SyntaxError>("(define-record-type point (make-point x) point? (x a) (x b))",
+                             "Duplicate record field x");
+    CheckThrows<SyntaxError>("(define-record-type point (make-point x) point? (x))");
+    CheckThrows<SyntaxError>("(define-record-type point)");
+}
+
+}  // namespace
+
+int main() {
+    TestRecords();
+    TestTypes();
+    TestErrors();
+    return FinishChecks();
+}
@@ -0,0 +1,62 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "error.h"
+
+namespace {
+
+const std::string kDepth = "(define (depth n) (if (= n 0) 0 (+ 1 (depth (- n 1))))) ";
+const std::string kNest = "(define (nest n) (if (= n 0) '() (list (nest (- n 1))))) ";
+
+void TestDeepRecursion() {
+    CheckRun(kDepth + "(depth 1000000)", "1000000");
+    CheckRun(kNest + "(define (count l) (if (null? l) 0 (+ 1 (count (car l))))) "
+                     "(count (nest 300000))",
+             "300000");
+    CheckRun("(define (build n) (if (= n 0) '() (cons n (build (- n 1))))) "
+             "(length (build 500000))",
+             "500000");
+}
+
+void TestOverflow() {
+    Interpreter interpreter;
+    interpreter.SetLimits({.max_stack_bytes = 1 << 20});
+    interpreter.RunScript(kDepth);
+    CheckRun(&interpreter, "(depth 1000)", "1000");
+    CheckThrows<RuntimeError>(&interpreter, "(depth 1000000)", "Evaluation stack overflow");
+    CheckRun(&interpreter, "(guard (e (#t (error-object-message e))) (depth 1000000))",
+             "Evaluation stack overflow");
+    // The stack is whole again for the next run.
+    CheckRun(&interpreter, "(depth 1000)", "1000");
+}
+
+// Every thread evaluates on a stack of its own.
+void TestThreads() {
+    std::vector<std::string> results(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < results.size(); ++i) {
+        threads.emplace_back([&, i] {
+            Interpreter interpreter;
+            auto n = std::to_string(200000 * (i + 1));
+            results[i] = interpreter.RunScript(kDepth + "(depth " + n + ")");
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (size_t i = 0; i < results.size(); ++i) {
+        Check(results[i] == std::to_string(200000 * (i + 1)),
+              "depth on thread " + std::to_string(i), results[i]);
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestDeepRecursion();
+    TestOverflow();
+    TestThreads();
+    return FinishChecks();
+}
@@ -0,0 +1,110 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "check.h"
+#include "client.h"
+#include "server.h"
+
+namespace {
+
+void CheckResponse(const Response& response, ResponseStatus status, const std::string& text,
+                   const std::string& name) {
+    Check(response.status == status && text == response.text, name,
+          "got " + std::to_string(static_cast<int>(response.status)) + " " + response.text);
+}
+
+const std::string kPrelude =
+    "(define n 0) (define l (list 1 2)) (define (bump) (set! n (+ n 1)) n)";
+
+// Requests see the prelude as it was left by the prelude itself.
+void TestRequestsAreIsolated() {
+    InterpreterPool pool(1, kPrelude);
+    auto interpreter = pool.Acquire();
+    CheckResponse(Evaluate(interpreter.get(), "(define x 5) (set! n 7) (bump)"),
+                  ResponseStatus::OK, "8", "assignment");
+    CheckResponse(Evaluate(interpreter.get(), "(set-car! l 3)"), ResponseStatus::RUNTIME_ERROR,
+                  "set-car! can't change a frozen pair", "prelude data");
+    CheckResponse(Evaluate(interpreter.get(), "(list (bump) l)"), ResponseStatus::OK,
+                  "(1 (1 2))", "next request");
+    CheckResponse(Evaluate(interpreter.get(), "x"), ResponseStatus::NAME_ERROR,
+                  "Unknown variable : x", "definition");
+    pool.Release(std::move(interpreter));
+}
+
+void TestStatuses() {
+    Interpreter interpreter;
+    Check(Evaluate(&interpreter, "(+ 1").status == ResponseStatus::SYNTAX_ERROR, "syntax error");
+    Check(Evaluate(&interpreter, "(car '())").status == ResponseStatus::RUNTIME_ERROR,
+          "runtime error");
+    auto looping = Evaluate(&interpreter, "(let loop () (loop))", {.max_steps = 1000});
+    Check(looping.status == ResponseStatus::LIMIT_ERROR, "limit error", looping.text);
+}
+
+std::string SocketPath() {
+    return "/tmp/scheme_server_test_" + std::to_string(getpid()) + ".sock";
+}
+
+// Connects without sending anything.
+int Connect(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    return fd;
+}
+
+void TestServer() {
+    ServerOptions options{.socket_path = SocketPath(),
+                          .worker_count = 1,
+                          .prelude = kPrelude,
+                          .io_timeout = std::chrono::milliseconds(200)};
+    Server server(options);
+    std::thread serving([&] { server.Serve(); });
+
+    // A client stalled in the middle of a frame holds the only worker until the timeout, then it
+    // is dropped.
+    int stalled = Connect(options.socket_path);
+    [[maybe_unused]] auto written = write(stalled, "\0\0", 2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<std::thread> clients;
+    std::vector<Response> responses(8);
+    for (size_t i = 0; i < responses.size(); ++i) {
+        clients.emplace_back([&, i] {
+            Client client(options.socket_path);
+            client.Evaluate("(bump)");
+            responses[i] = client.Evaluate("(set! n 10) (bump)");
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    for (const auto& response : responses) {
+        CheckResponse(response, ResponseStatus::OK, "11", "concurrent request");
+    }
+    Client client(options.socket_path);
+    CheckResponse(client.Evaluate("(bump)"), ResponseStatus::OK, "1", "request after others");
+
+    char byte;
+    Check(read(stalled, &byte, 1) == 0, "stalled client disconnected");
+    close(stalled);
+
+    server.Stop();
+    serving.join();
+}
+
+}  // namespace
+
+int main() {
+    TestRequestsAreIsolated();
+    TestStatuses();
+    TestServer();
+    return FinishChecks();
+}
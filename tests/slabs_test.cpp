@@ -0,0 +1,83 @@
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "object.h"
+#include "slab_allocator.h"
+
+namespace {
+
+int64_t ReservedBlocks(SlabArena arena, size_t block_size) {
+    for (const auto& slab : GetSlabStats()) {
+        if (slab.arena == arena && slab.block_size == block_size) {
+            return slab.reserved_blocks;
+        }
+    }
+    return 0;
+}
+
+void TestConstants() {
+    Check(New<Number>(5) == New<Number>(5), "small numbers shared");
+    Check(New<Number>(kMinSharedNumber) == GetSharedNumber(kMinSharedNumber), "smallest shared");
+    Check(New<Number>(kMaxSharedNumber + 1) != New<Number>(kMaxSharedNumber + 1),
+          "large numbers not shared");
+    Check(New<Boolean>(true) == New<Boolean>(true), "true shared");
+    Check(New<Boolean>(false) == GetSharedBoolean(false), "false shared");
+    CheckRun("(list (+ 1 2) (- 1000 1001) (* 1000 1000))", "(3 -1 1000000)");
+}
+
+// Freed blocks are reused, so allocating in a loop doesn't carve new ones.
+void TestReuse() {
+    constexpr size_t kBlockSize = 48;
+    struct Block {
+        char data[kBlockSize];
+    };
+    SlabAllocator<Block> allocator;
+    std::vector<Block*> blocks;
+    for (int i = 0; i < 1000; ++i) {
+        blocks.push_back(allocator.allocate(1));
+    }
+    for (auto* block : blocks) {
+        allocator.deallocate(block, 1);
+    }
+    auto reserved = ReservedBlocks(SlabArena::OBJECTS, kBlockSize);
+    Check(reserved >= 1000, "reserved blocks", std::to_string(reserved));
+    for (int round = 0; round < 10; ++round) {
+        blocks.clear();
+        for (int i = 0; i < 1000; ++i) {
+            blocks.push_back(allocator.allocate(1));
+        }
+        for (auto* block : blocks) {
+            allocator.deallocate(block, 1);
+        }
+    }
+    Check(ReservedBlocks(SlabArena::OBJECTS, kBlockSize) == reserved, "blocks reused",
+          std::to_string(ReservedBlocks(SlabArena::OBJECTS, kBlockSize)));
+}
+
+// Objects may be freed on another thread than the one that made them.
+void TestFreedElsewhere() {
+    std::vector<std::shared_ptr<Object>> objects;
+    std::thread maker([&] {
+        for (int i = 0; i < 100000; ++i) {
+            objects.push_back(New<Number>(100000 + i));
+        }
+    });
+    maker.join();
+    std::thread freer([&] { objects.clear(); });
+    freer.join();
+    CheckRun("(define (range n acc) (if (= n 0) acc (range (- n 1) (cons (* n 1000) acc)))) "
+             "(length (range 100000 '()))",
+             "100000");
+}
+
+}  // namespace
+
+int main() {
+    TestConstants();
+    TestReuse();
+    TestFreedElsewhere();
+    return FinishChecks();
+}
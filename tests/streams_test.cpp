@@ -0,0 +1,105 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "check.h"
+#include "error.h"
+#include "task.h"
+
+namespace {
+
+void TestPromises() {
+    CheckRun("(force (delay (+ 1 2)))", "3");
+    CheckRun("(define n 0) (define p (delay (begin (set! n (+ n 1)) n))) (force p) (force p) n",
+             "1");
+    CheckRun("(force (make-promise 5))", "5");
+    CheckRun("(force 5)", "5");
+    CheckRun("(promise? (delay 1))", "#t");
+    // A promise whose computation raised is forced again.
+    CheckRun("(define n 0) "
+             "(define p (delay (begin (set! n (+ n 1)) (if (= n 1) (car '()) n)))) "
+             "(guard (e (#t 'failed)) (force p)) (force p)",
+             "2");
+    // The first value computed wins over the one of a nested force.
+    CheckRun("(define n 0) "
+             "(define p (delay (begin (set! n (+ n 1)) (if (= n 1) (force p) n)))) "
+             "(force p)",
+             "2");
+}
+
+void TestStreams() {
+    const std::string integers =
+        "(define (from n) (cons-stream n (from (+ n 1)))) (define s (from 1)) ";
+    CheckRun(integers + "(stream->list 5 s)", "(1 2 3 4 5)");
+    CheckRun(integers + "(stream->list 3 (stream-map + s s))", "(2 4 6)");
+    CheckRun(integers + "(stream->list 3 (stream-filter (lambda (x) (> x 2)) s))",
+             "(3 4 5)");
+    CheckRun(integers + "(stream-fold + 0 (stream-take 100000 s))", "5000050000");
+    CheckRun(integers + "(stream-car (stream-cdr s))", "2");
+}
+
+const std::string kSlowPromise =
+    "(define computed 0) "
+    "(define p (delay (begin (let loop ((i 0)) (if (< i 20000) (loop (+ i 1)))) "
+    "                        (set! computed (+ computed 1)) "
+    "                        computed))) ";
+
+// Tasks interleave on one thread, the second one forcing the promise waits for the first.
+void TestTasksShareAPromise() {
+    Interpreter interpreter;
+    interpreter.RunScript(kSlowPromise);
+    auto first = std::make_shared<Task>(&interpreter, "(force p)", 100);
+    auto second = std::make_shared<Task>(&interpreter, "(force p)", 100);
+    Scheduler scheduler;
+    scheduler.Add(first);
+    scheduler.Add(second);
+    scheduler.Run();
+    Check(first->GetResult() == "1", "value of the first task", first->GetResult());
+    Check(second->GetResult() == "1", "value of the second task", second->GetResult());
+    CheckRun(&interpreter, "computed", "1");
+}
+
+// A thread waiting for a promise another thread computes can still be cancelled.
+void TestWaitIsCancelled() {
+    Interpreter parent;
+    parent.RunScript("(define p (delay (let loop () (loop))))");
+    auto computing = parent.Fork();
+    auto waiting = parent.Fork();
+    std::thread computer([&] {
+        CheckThrows<LimitError>(&computing, "(force p)", "Evaluation was cancelled");
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::thread waiter([&] {
+        CheckThrows<LimitError>(&waiting, "(force p)", "Evaluation was cancelled");
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    waiting.GetCancellationHandle()->Cancel();
+    waiter.join();
+    computing.GetCancellationHandle()->Cancel();
+    computer.join();
+}
+
+void TestWaitIsCharged() {
+    Interpreter parent;
+    parent.RunScript("(define p (delay (let loop () (loop))))");
+    auto computing = parent.Fork();
+    auto waiting = parent.Fork();
+    std::thread computer([&] { CheckThrows<LimitError>(&computing, "(force p)"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    waiting.SetLimits({.max_steps = 20});
+    CheckThrows<LimitError>(&waiting, "(force p)", "Evaluation step limit exceeded");
+    computing.GetCancellationHandle()->Cancel();
+    computer.join();
+}
+
+}  // namespace
+
+int main() {
+    TestPromises();
+    TestStreams();
+    TestTasksShareAPromise();
+    TestWaitIsCancelled();
+    TestWaitIsCharged();
+    return FinishChecks();
+}
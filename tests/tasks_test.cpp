@@ -0,0 +1,89 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "error.h"
+#include "task.h"
+
+namespace {
+
+const std::string kCount = "(let loop ((i 0)) (if (< i 10000) (loop (+ i 1)) i))";
+
+void TestResume() {
+    Interpreter interpreter;
+    Task task(&interpreter, kCount, 100);
+    int slices = 1;
+    while (!task.Resume()) {
+        ++slices;
+    }
+    Check(task.IsFinished(), "finished");
+    Check(slices > 10, "slices", std::to_string(slices));
+    Check(task.GetResult() == "10000", "result", task.GetResult());
+}
+
+// Tasks of one interpreter run in turns, so each sees what the others did so far.
+void TestInterleaving() {
+    Interpreter interpreter;
+    interpreter.RunScript("(define log '()) "
+                          "(define (work name n) "
+                          "  (if (> n 0) "
+                          "      (begin (set! log (cons name log)) "
+                          "             (let loop ((i 0)) (if (< i 100) (loop (+ i 1)))) "
+                          "             (work name (- n 1)))))");
+    Scheduler scheduler;
+    scheduler.Add(std::make_shared<Task>(&interpreter, "(work 'a 3)", 100));
+    scheduler.Add(std::make_shared<Task>(&interpreter, "(work 'b 3)", 100));
+    Check(scheduler.GetPendingCount() == 2, "pending tasks");
+    scheduler.Run();
+    Check(scheduler.GetPendingCount() == 0, "pending tasks after Run");
+    CheckRun(&interpreter, "log", "(b a b a b a)");
+}
+
+void TestManyTasks() {
+    Interpreter interpreter;
+    interpreter.RunScript("(define (depth n) (if (= n 0) 0 (+ 1 (depth (- n 1)))))");
+    Scheduler scheduler;
+    std::vector<std::shared_ptr<Task>> tasks;
+    for (int i = 0; i < 100; ++i) {
+        auto source = "(depth " + std::to_string(i * 100) + ")";
+        tasks.push_back(std::make_shared<Task>(&interpreter, source));
+        scheduler.Add(tasks.back());
+    }
+    int rounds = 0;
+    while (scheduler.RunRound()) {
+        ++rounds;
+    }
+    Check(rounds > 1, "rounds", std::to_string(rounds));
+    for (int i = 0; i < 100; ++i) {
+        Check(tasks[i]->GetResult() == std::to_string(i * 100),
+              "result of task " + std::to_string(i), tasks[i]->GetResult());
+    }
+}
+
+void TestErrors() {
+    Interpreter interpreter;
+    auto failing = std::make_shared<Task>(&interpreter, "(define x 1) (car '())");
+    auto fine = std::make_shared<Task>(&interpreter, "(+ 1 2)");
+    Scheduler scheduler;
+    scheduler.Add(failing);
+    scheduler.Add(fine);
+    scheduler.Run();
+    try {
+        failing->GetResult();
+        Check(false, "error of a task");
+    } catch (const RuntimeError&) {
+    }
+    Check(fine->GetResult() == "3", "task next to a failing one", fine->GetResult());
+    CheckRun(&interpreter, "x", "1");
+}
+
+}  // namespace
+
+int main() {
+    TestResume();
+    TestInterleaving();
+    TestManyTasks();
+    TestErrors();
+    return FinishChecks();
+}
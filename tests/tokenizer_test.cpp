@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <optional>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "error.h"
+#include "tokenizer.h"
+
+namespace {
+
+// Makes the input available in pieces of the given size, each only after the previous one is
+// read, like a pipe does.
+class ChunkedBuffer : public std::streambuf {
+public:
+    ChunkedBuffer(std::string data, size_t chunk_size)
+        : data_(std::move(data)), chunk_size_(chunk_size) {
+        setg(data_.data(), data_.data(), data_.data());
+    }
+
+protected:
+    int_type underflow() override {
+        char* end = data_.data() + data_.size();
+        if (egptr() == end) {
+            return traits_type::eof();
+        }
+        setg(egptr(), egptr(), std::min(egptr() + chunk_size_, end));
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    std::string data_;
+    size_t chunk_size_;
+};
+
+// The tokens of the input, read in chunks of the given size if it isn't zero.
+std::vector<Token> Tokenize(const std::string& input, ScanPath path, size_t chunk_size = 0) {
+    std::stringstream whole(input);
+    ChunkedBuffer buffer(input, chunk_size);
+    std::istream chunked(&buffer);
+    Tokenizer tokenizer(chunk_size == 0 ? static_cast<std::istream*>(&whole) : &chunked, path);
+    std::vector<Token> tokens;
+    for (; !tokenizer.IsEnd(); tokenizer.Next()) {
+        tokens.push_back(tokenizer.GetToken());
+    }
+    return tokens;
+}
+
+std::vector<ScanPath> GetSupportedPaths() {
+    std::vector<ScanPath> paths;
+    for (ScanPath path : {ScanPath::SCALAR, ScanPath::SSE42, ScanPath::AVX2}) {
+        if (IsScanPathSupported(path)) {
+            paths.push_back(path);
+        }
+    }
+    return paths;
+}
+
+std::string GetPathName(ScanPath path) {
+    return path == ScanPath::SCALAR ? "scalar" : path == ScanPath::SSE42 ? "sse4.2" : "avx2";
+}
+
+void CheckTokens(const std::string& name, const std::string& input,
+                 const std::vector<Token>& expected) {
+    for (ScanPath path : GetSupportedPaths()) {
+        for (size_t chunk_size : {0, 1, 3, 64}) {
+            auto tokens = Tokenize(input, path, chunk_size);
+            Check(tokens == expected, name,
+                  GetPathName(path) + " path, chunks of " + std::to_string(chunk_size) + ", " +
+                      std::to_string(tokens.size()) + " tokens");
+        }
+    }
+}
+
+const std::string kTokens = "abcdefghij 1234567890123 -42 +7 - + \"st ring\" (a . b) 'q";
+
+const std::vector<Token> kExpectedTokens = {
+    SymbolToken{"abcdefghij"}, ConstantToken{1234567890123}, ConstantToken{-42},
+    ConstantToken{7},          SymbolToken{"-"},             SymbolToken{"+"},
+    StringToken{"st ring"},    BracketToken::OPEN,           SymbolToken{"a"},
+    DotToken{},                SymbolToken{"b"},             BracketToken::CLOSE,
+    QuoteToken{},              SymbolToken{"q"}};
+
+void TestClassifyBlocks() {
+    std::string data(256, '\0');
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i);
+    }
+    constexpr size_t kBlocks = 4;
+    BlockMasks expected[kBlocks];
+    ClassifyBlocks(data.data(), kBlocks, expected, ScanPath::SCALAR);
+    for (size_t i = 0; i < data.size(); ++i) {
+        const BlockMasks& masks = expected[i / kScanBlockSize];
+        uint64_t bit = uint64_t{1} << (i % kScanBlockSize);
+        char c = data[i];
+        Check(((masks.blank & bit) != 0) == (c == ' ' || c == '\t' || c == '\n'),
+              "blank class of byte " + std::to_string(i));
+        Check(((masks.digit & bit) != 0) == (c >= '0' && c <= '9'),
+              "digit class of byte " + std::to_string(i));
+        Check(((masks.symbol & bit) != 0) == IsSymbolChar(c),
+              "symbol class of byte " + std::to_string(i));
+    }
+    for (ScanPath path : GetSupportedPaths()) {
+        BlockMasks masks[kBlocks];
+        ClassifyBlocks(data.data(), kBlocks, masks, path);
+        for (size_t block = 0; block < kBlocks; ++block) {
+            Check(masks[block].blank == expected[block].blank &&
+                      masks[block].digit == expected[block].digit &&
+                      masks[block].symbol == expected[block].symbol,
+                  GetPathName(path) + " masks of block " + std::to_string(block));
+        }
+    }
+}
+
+void TestBlockBoundary() {
+    for (size_t offset = 40; offset <= 2 * kScanBlockSize; ++offset) {
+        CheckTokens("tokens after " + std::to_string(offset) + " blanks",
+                    std::string(offset, ' ') + kTokens, kExpectedTokens);
+    }
+}
+
+// The buffer starts at 4 KiB and grows, so tokens straddle its end at these offsets.
+void TestRefillEdge() {
+    for (size_t end : {4 << 10, 8 << 10}) {
+        for (size_t offset = end - 24; offset <= end + 4; ++offset) {
+            std::string input = std::string(offset, '\n') + kTokens;
+            for (ScanPath path : GetSupportedPaths()) {
+                Check(Tokenize(input, path) == kExpectedTokens,
+                      "tokens after " + std::to_string(offset) + " newlines",
+                      GetPathName(path) + " path");
+            }
+        }
+    }
+}
+
+void TestSignAtEnd() {
+    CheckTokens("minus at the end", "-", {SymbolToken{"-"}});
+    CheckTokens("plus at the end", "(+", {BracketToken::OPEN, SymbolToken{"+"}});
+    CheckTokens("signed numbers", "-5 +5 -0", {ConstantToken{-5}, ConstantToken{5},
+                                               ConstantToken{0}});
+    CheckTokens("sign before a bracket", "-(+)", {SymbolToken{"-"}, BracketToken::OPEN,
+                                                   SymbolToken{"+"}, BracketToken::CLOSE});
+    for (ScanPath path : GetSupportedPaths()) {
+        for (size_t offset = kScanBlockSize - 2; offset <= kScanBlockSize; ++offset) {
+            auto input = std::string(offset, ' ') + "-123";
+            Check(Tokenize(input, path, offset + 1) == std::vector<Token>{ConstantToken{-123}},
+                  "minus ending a chunk at " + std::to_string(offset), GetPathName(path));
+        }
+    }
+}
+
+void TestLongNumbers() {
+    CheckTokens("eight digits", "12345678 87654321", {ConstantToken{12345678},
+                                                        ConstantToken{87654321}});
+    CheckTokens("nine digits", "123456789", {ConstantToken{123456789}});
+    CheckTokens("sixteen digits", "1234567890123456", {ConstantToken{1234567890123456}});
+    CheckTokens("leading zeros", "0000000012345678901", {ConstantToken{12345678901}});
+    CheckTokens("largest number", "9223372036854775807 -9223372036854775807",
+                {ConstantToken{9223372036854775807}, ConstantToken{-9223372036854775807}});
+    for (size_t i = 0; i <= 8; ++i) {
+        Check(ParseEightDigits(&"0123456789876543"[i]) ==
+                  static_cast<uint32_t>(std::stoul(std::string("0123456789876543").substr(i, 8))),
+              "eight digits at " + std::to_string(i));
+    }
+}
+
+void TestErrors() {
+    for (ScanPath path : GetSupportedPaths()) {
+        try {
+            Tokenize("\"unterminated", path, 4);
+            Check(false, "unterminated string", GetPathName(path));
+        } catch (const SyntaxError&) {
+        }
+        try {
+            Tokenize("a ,", path);
+            Check(false, "unknown character", GetPathName(path));
+        } catch (const SyntaxError&) {
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    TestClassifyBlocks();
+    TestBlockBoundary();
+    TestRefillEdge();
+    TestSignAtEnd();
+    TestLongNumbers();
+    TestErrors();
+    return FinishChecks();
+}
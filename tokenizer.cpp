@@ -1,6 +1,10 @@
 #include "tokenizer.h"
 #include "error.h"
 
+#include <bit>
+#include <cctype>
+#include <cstring>
+
 SymbolToken::SymbolToken(const std::string& str) : name(str) {
 }
 
@@ -8,6 +12,10 @@ bool SymbolToken::operator==(const SymbolToken& other) const {
     return name == other.name;
 }
 
+bool StringToken::operator==(const StringToken& other) const {
+    return value == other.value;
+}
+
 bool QuoteToken::operator==(const QuoteToken&) const {
     return true;
 }
@@ -23,88 +31,213 @@ bool ConstantToken::operator==(const ConstantToken& other) const {
     return value == other.value;
 }
 
-Tokenizer::Tokenizer(std::istream* in) : input_stream_(*in) {
-    Next();
+namespace {
+
+constexpr size_t kInitialBufferSize = 4 << 10;
+constexpr size_t kMaxReadSize = 64 << 10;
+
+bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
 }
 
-bool Tokenizer::IsBlank(char c) {
-    return c == ' ' || c == '\t' || c == '\n';
+}  // namespace
+
+Tokenizer::Tokenizer(std::istream* in) : input_stream_(*in), masks_(1) {
+    Next();
 }
 
-void Tokenizer::ToTokenBegin() {
-    while (input_stream_ && IsBlank(input_stream_.peek())) {
-        input_stream_.get();
-    }
+Tokenizer::Tokenizer(std::istream* in, ScanPath scan_path)
+    : input_stream_(*in), masks_(1), scan_path_(scan_path) {
+    Next();
 }
 
 bool Tokenizer::IsEnd() {
     return is_end_;
 }
 
-int64_t Tokenizer::ReadNumber() {
-    int64_t number = 0;
-    while (std::isdigit(input_stream_.peek())) {
-        number = number * 10 + (input_stream_.get() - '0');
+// Drops the consumed bytes, appends whatever input is available and classifies the buffer again.
+// Returns false if no input was appended because it has ended.
+bool Tokenizer::Refill() {
+    size_t capacity = buffer_.empty() ? 0 : buffer_.size() - kScanBlockSize;
+    size_t kept = size_ - position_;
+    if (capacity == 0) {
+        capacity = kInitialBufferSize;
+    } else if ((size_ == capacity && capacity < kMaxReadSize) || kept > capacity / 2) {
+        capacity *= 2;
+    }
+    if (capacity + kScanBlockSize != buffer_.size()) {
+        std::vector<char> buffer(capacity + kScanBlockSize);
+        std::memcpy(buffer.data(), buffer_.data() + position_, kept);
+        buffer_ = std::move(buffer);
+    } else {
+        std::memmove(buffer_.data(), buffer_.data() + position_, kept);
+    }
+    position_ = 0;
+    size_ = kept;
+
+    size_t read = 0;
+    if (!input_end_) {
+        char* free = buffer_.data() + size_;
+        size_t free_size = capacity - size_;
+        read = input_stream_.readsome(free, free_size);
+        if (read == 0) {
+            // Nothing is known to be available, so wait for a single character.
+            int c = input_stream_.get();
+            if (c == EOF) {
+                input_end_ = true;
+            } else {
+                free[0] = static_cast<char>(c);
+                read = 1 + input_stream_.readsome(free + 1, free_size - 1);
+            }
+        }
+        size_ += read;
+    }
+
+    size_t block_count = (size_ + kScanBlockSize - 1) / kScanBlockSize;
+    std::memset(buffer_.data() + size_, 0, block_count * kScanBlockSize - size_);
+    masks_.resize(block_count + 1);
+    if (scan_path_) {
+        ClassifyBlocks(buffer_.data(), block_count, masks_.data(), *scan_path_);
+    } else {
+        ClassifyBlocks(buffer_.data(), block_count, masks_.data());
+    }
+    masks_[block_count] = BlockMasks{};
+    return read != 0;
+}
+
+// The first position at or after from whose byte isn't in the mask, at most size_.
+size_t Tokenizer::FindRunEnd(uint64_t BlockMasks::*mask, size_t from) {
+    size_t block = from / kScanBlockSize;
+    uint64_t outside = ~(masks_[block].*mask) & (~uint64_t{0} << (from % kScanBlockSize));
+    while (outside == 0) {
+        outside = ~(masks_[++block].*mask);
     }
+    return block * kScanBlockSize + std::countr_zero(outside);
+}
+
+// The end of the run of mask bytes starting offset bytes into the token at position_, reading
+// more input while the run reaches the end of the buffer.
+size_t Tokenizer::FindTokenEnd(uint64_t BlockMasks::*mask, size_t offset) {
+    size_t end = FindRunEnd(mask, position_ + offset);
+    while (end == size_) {
+        size_t consumed = position_;
+        bool refilled = Refill();
+        end -= consumed;
+        if (!refilled) {
+            break;
+        }
+        end = FindRunEnd(mask, end);
+    }
+    return end;
+}
+
+uint64_t Tokenizer::ReadNumber(size_t offset) {
+    size_t end = FindTokenEnd(&BlockMasks::digit, offset);
+    const char* digit = buffer_.data() + position_ + offset;
+    const char* digits_end = buffer_.data() + end;
+    uint64_t number = 0;
+    for (; digits_end - digit >= 8; digit += 8) {
+        number = number * 100000000 + ParseEightDigits(digit);
+    }
+    for (; digit != digits_end; ++digit) {
+        number = number * 10 + (*digit - '0');
+    }
+    position_ = end;
     return number;
 }
 
-bool Tokenizer::IsSymbolBegin(char c) {
-    return std::isalpha(c) || c == '<' || c == '=' || c == '>' || c == '*' || c == '/' || c == '#';
+// Reads the literal starting at position_. A backslash escapes the next character, \n and \t
+// stand for a newline and a tab.
+std::string Tokenizer::ReadString() {
+    std::string value;
+    bool escaped = false;
+    for (size_t i = position_ + 1;;) {
+        if (i == size_) {
+            size_t consumed = position_;
+            if (!Refill()) {
+                throw SyntaxError("Unterminated string");
+            }
+            i -= consumed;
+            continue;
+        }
+        char c = buffer_[i++];
+        if (escaped) {
+            value.push_back(c == 'n' ? '\n' : c == 't' ? '\t' : c);
+            escaped = false;
+        } else if (c == '\\') {
+            escaped = true;
+        } else if (c == '"') {
+            position_ = i;
+            return value;
+        } else {
+            value.push_back(c);
+        }
+    }
 }
 
-bool Tokenizer::IsSymbolMiddle(char c) {
-    return IsSymbolBegin(c) || std::isdigit(c) || c == '?' || c == '!' || c == '-';
+bool Tokenizer::IsSymbolBegin(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '<' || c == '=' || c == '>' ||
+           c == '*' || c == '/' || c == '#';
 }
 
 void Tokenizer::Next() {
-    ToTokenBegin();
-    if (input_stream_.peek() == EOF) {
+    do {
+        position_ = FindRunEnd(&BlockMasks::blank, position_);
+    } while (position_ == size_ && Refill());
+    if (position_ == size_) {
         is_end_ = true;
         return;
     }
-    char first_symbol = input_stream_.get();
+    char first_symbol = buffer_[position_];
     if (first_symbol == '\'') {
+        ++position_;
         last_read_token_ = QuoteToken{};
         return;
     }
     if (first_symbol == '.') {
+        ++position_;
         last_read_token_ = DotToken{};
         return;
     }
+    if (first_symbol == '"') {
+        last_read_token_ = StringToken{ReadString()};
+        return;
+    }
     if (first_symbol == '(') {
+        ++position_;
         last_read_token_ = BracketToken::OPEN;
         return;
     }
     if (first_symbol == ')') {
+        ++position_;
         last_read_token_ = BracketToken::CLOSE;
         return;
     }
     if (first_symbol == '-' || first_symbol == '+') {
-        if (std::isdigit(input_stream_.peek())) {
-            if (first_symbol == '-') {
-                last_read_token_ = ConstantToken{-ReadNumber()};
-            } else {
-                last_read_token_ = ConstantToken{ReadNumber()};
-            }
+        if (position_ + 1 == size_) {
+            Refill();
+        }
+        if (IsDigit(buffer_[position_ + 1])) {
+            uint64_t number = ReadNumber(1);
+            last_read_token_ =
+                ConstantToken{static_cast<int64_t>(first_symbol == '-' ? 0 - number : number)};
         } else {
+            ++position_;
             last_read_token_ = SymbolToken{{first_symbol}};
         }
         return;
     }
-    if (std::isdigit(first_symbol)) {
-        input_stream_.unget();
-        last_read_token_ = ConstantToken{ReadNumber()};
+    if (IsDigit(first_symbol)) {
+        last_read_token_ = ConstantToken{static_cast<int64_t>(ReadNumber(0))};
         return;
     }
     if (IsSymbolBegin(first_symbol)) {
-        std::string name = {first_symbol};
-        while (IsSymbolMiddle(input_stream_.peek())) {
-            name.push_back(input_stream_.get());
-        }
-        last_read_token_ = SymbolToken{name};
+        size_t end = FindTokenEnd(&BlockMasks::symbol, 1);
+        last_read_token_ = SymbolToken{std::string(buffer_.data() + position_, end - position_)};
+        position_ = end;
         return;
     }
+    ++position_;
     throw SyntaxError("Can't identify token type");
 }
 
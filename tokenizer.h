@@ -3,6 +3,9 @@
 #include <istream>
 #include <optional>
 #include <variant>
+#include <vector>
+
+#include "scanner.h"
 
 struct SymbolToken {
     std::string name;
@@ -11,6 +14,13 @@ struct SymbolToken {
     bool operator==(const SymbolToken& other) const;
 };
 
+// The text of a string literal, escapes resolved.
+struct StringToken {
+    std::string value;
+
+    bool operator==(const StringToken& other) const;
+};
+
 struct QuoteToken {
     bool operator==(const QuoteToken&) const;
 };
@@ -28,25 +38,39 @@ struct ConstantToken {
     bool operator==(const ConstantToken& other) const;
 };
 
-using Token = std::variant<QuoteToken, ConstantToken, BracketToken, SymbolToken, DotToken>;
+using Token =
+    std::variant<QuoteToken, ConstantToken, BracketToken, SymbolToken, DotToken, StringToken>;
 
+// Reads the input in blocks and classifies each block at once, so blanks, symbols and numbers
+// are found with bit scans instead of a branch per character. Only as much input as is available
+// without blocking is read ahead.
 class Tokenizer {
 public:
     Tokenizer(std::istream* in);
+    // Classifies the input with the given implementation instead of the fastest supported one.
+    Tokenizer(std::istream* in, ScanPath scan_path);
 
     bool IsEnd();
     void Next();
     Token GetToken();
 
 private:
-    bool IsBlank(char c);
     bool IsSymbolBegin(char c);
-    bool IsSymbolMiddle(char c);
 
-    void ToTokenBegin();
-    int64_t ReadNumber();
+    bool Refill();
+    size_t FindRunEnd(uint64_t BlockMasks::*mask, size_t from);
+    size_t FindTokenEnd(uint64_t BlockMasks::*mask, size_t offset);
+    uint64_t ReadNumber(size_t offset);
+    std::string ReadString();
 
     std::istream& input_stream_;
+    // The unread input is buffer_[position_, size_), followed by zeros up to the next block.
+    std::vector<char> buffer_;
+    std::vector<BlockMasks> masks_;
+    size_t position_ = 0;
+    size_t size_ = 0;
+    bool input_end_ = false;
+    std::optional<ScanPath> scan_path_;
     Token last_read_token_;
     bool is_end_ = false;
 };
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "compiler.h"
+#include "error.h"
+#include "parser.h"
+
+// Compiles a script to a C++ module. Build it with
+//   g++ -std=c++20 -O2 -shared -fPIC -I<repository> <output> -o <module>.so
+// and load it with Interpreter::LoadModule from a host linked with -rdynamic.
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <script> <output>\n";
+        return 2;
+    }
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "Can't open " << argv[1] << "\n";
+        return 1;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string module;
+    try {
+        module = CompileModule(ReadAll(ss.str(), 1));
+    } catch (const SyntaxError& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    std::ofstream out(argv[2]);
+    out << module;
+    if (!out) {
+        std::cerr << "Can't write " << argv[2] << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "parallel.h"
+#include "server.h"
+
+namespace {
+
+const char* GetStatusName(ResponseStatus status) {
+    switch (status) {
+        case ResponseStatus::OK:
+            return "ok";
+        case ResponseStatus::SYNTAX_ERROR:
+            return "syntax_error";
+        case ResponseStatus::RUNTIME_ERROR:
+            return "runtime_error";
+        case ResponseStatus::NAME_ERROR:
+            return "name_error";
+        case ResponseStatus::LIMIT_ERROR:
+            return "limit_error";
+        default:
+            return "internal_error";
+    }
+}
+
+std::string EscapeJson(const std::string& str) {
+    std::ostringstream out;
+    for (unsigned char c : str) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c == '\n') {
+            out << "\\n";
+        } else if (c < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+        } else {
+            out << c;
+        }
+    }
+    return out.str();
+}
+
+void CollectFiles(const std::filesystem::path& path, std::vector<std::string>* files) {
+    if (!std::filesystem::is_directory(path)) {
+        files->emplace_back(path.string());
+        return;
+    }
+    std::vector<std::string> found;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".scm") {
+            found.emplace_back(entry.path().string());
+        }
+    }
+    std::sort(found.begin(), found.end());
+    files->insert(files->end(), found.begin(), found.end());
+}
+
+Response EvaluateFile(const std::string& path, const Limits& limits) {
+    std::ifstream in(path);
+    if (!in) {
+        return {ResponseStatus::INTERNAL_ERROR, "Can't open " + path};
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    Interpreter interpreter;
+    return Evaluate(&interpreter, ss.str(), limits);
+}
+
+}  // namespace
+
+// Prints one JSON object per file to stdout as soon as the file is done, in completion order,
+// and the summary to stderr.
+int main(int argc, char** argv) {
+    size_t thread_count = GetDefaultThreadCount();
+    Limits limits = {.max_stack_bytes = 64 << 20};
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.starts_with("--") && i + 1 == argc) {
+            std::cerr << "Missing value of " << arg << "\n";
+            return 2;
+        }
+        if (arg == "--threads") {
+            thread_count = std::max(1ul, std::stoul(argv[++i]));
+        } else if (arg == "--max-steps") {
+            limits.max_steps = std::stoull(argv[++i]);
+        } else if (arg == "--max-bytes") {
+            limits.max_allocated_bytes = std::stoull(argv[++i]);
+        } else if (arg == "--max-depth") {
+            limits.max_depth = std::stoull(argv[++i]);
+        } else if (arg == "--max-stack-bytes") {
+            limits.max_stack_bytes = std::stoull(argv[++i]);
+        } else if (arg.starts_with("--")) {
+            std::cerr << "Unknown flag " << arg << "\n";
+            return 2;
+        } else {
+            CollectFiles(arg, &files);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--threads N] [--max-steps N] [--max-bytes N] [--max-depth N]"
+                     " [--max-stack-bytes N] <file or directory>...\n";
+        return 2;
+    }
+
+    std::mutex output_mutex;
+    std::atomic<size_t> failed = 0;
+    auto start = std::chrono::steady_clock::now();
+    ParallelFor(files.size(), thread_count, [&](size_t i) {
+        auto file_start = std::chrono::steady_clock::now();
+        Response response = EvaluateFile(files[i], limits);
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - file_start;
+        if (response.status != ResponseStatus::OK) {
+            ++failed;
+        }
+        std::ostringstream line;
+        line << "{\"file\":\"" << EscapeJson(files[i]) << "\",\"status\":\""
+             << GetStatusName(response.status) << "\","
+             << (response.status == ResponseStatus::OK ? "\"result\"" : "\"error\"") << ":\""
+             << EscapeJson(response.text) << "\",\"time_ms\":" << elapsed.count() << "}\n";
+        std::lock_guard lock(output_mutex);
+        std::cout << line.str() << std::flush;
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cerr << files.size() << " files, " << failed << " failed, " << thread_count
+              << " threads, " << elapsed.count() << " s, " << files.size() / elapsed.count()
+              << " files/s\n";
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#include <iostream>
+#include <iterator>
+
+#include "client.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket> [EXPRESSION]\n"
+                  << "Reads the script from stdin when no expression is given.\n";
+        return 2;
+    }
+    std::string source;
+    if (argc > 2) {
+        source = argv[2];
+    } else {
+        source.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
+    Client client(argv[1]);
+    Response response = client.Evaluate(source);
+    if (response.status != ResponseStatus::OK) {
+        std::cerr << "error: " << response.text << "\n";
+        return 1;
+    }
+    std::cout << response.text << "\n";
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "client.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <socket> [--connections N] [--requests N] [--expression EXPR]\n";
+        return 2;
+    }
+    std::string socket_path = argv[1];
+    size_t connections = 8;
+    size_t requests = 10000;
+    std::string expression = "(define (f n) (if (< n 2) n (+ (f (- n 1)) (f (- n 2))))) (f 15)";
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--connections") {
+            connections = std::stoul(argv[i + 1]);
+        } else if (flag == "--requests") {
+            requests = std::stoul(argv[i + 1]);
+        } else if (flag == "--expression") {
+            expression = argv[i + 1];
+        } else {
+            std::cerr << "Unknown flag " << flag << "\n";
+            return 2;
+        }
+    }
+
+    std::vector<std::vector<int64_t>> latencies(connections);
+    std::vector<size_t> errors(connections, 0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < connections; ++i) {
+        threads.emplace_back([&, i] {
+            Client client(socket_path);
+            size_t count = requests / connections + (i < requests % connections);
+            latencies[i].reserve(count);
+            for (size_t j = 0; j < count; ++j) {
+                auto request_start = std::chrono::steady_clock::now();
+                if (client.Evaluate(expression).status != ResponseStatus::OK) {
+                    ++errors[i];
+                }
+                auto elapsed = std::chrono::steady_clock::now() - request_start;
+                latencies[i].push_back(
+                    std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int64_t> all;
+    size_t error_count = 0;
+    for (size_t i = 0; i < connections; ++i) {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        error_count += errors[i];
+    }
+    if (all.empty()) {
+        std::cerr << "No requests were sent\n";
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&all](double p) {
+        return all[std::min(all.size() - 1, size_t(p * all.size()))];
+    };
+    std::cout << "requests:   " << all.size() << " (" << error_count << " errors)\n"
+              << "throughput: " << all.size() / seconds << " req/s\n"
+              << "p50:        " << percentile(0.50) << " us\n"
+              << "p99:        " << percentile(0.99) << " us\n"
+              << "max:        " << all.back() << " us\n";
+    return 0;
+}
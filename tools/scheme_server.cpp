@@ -0,0 +1,74 @@
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "server.h"
+
+namespace {
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Can't open " + path);
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <socket> [--workers N] [--interpreters N] [--prelude FILE]"
+                     " [--max-steps N] [--max-bytes N] [--max-depth N] [--max-stack-bytes N]"
+                     " [--io-timeout-ms N]\n";
+        return 2;
+    }
+    ServerOptions options;
+    options.socket_path = argv[1];
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--workers") {
+            options.worker_count = std::stoul(argv[i + 1]);
+        } else if (flag == "--interpreters") {
+            options.interpreter_count = std::stoul(argv[i + 1]);
+        } else if (flag == "--prelude") {
+            options.prelude = ReadFile(argv[i + 1]);
+        } else if (flag == "--max-steps") {
+            options.limits.max_steps = std::stoull(argv[i + 1]);
+        } else if (flag == "--max-bytes") {
+            options.limits.max_allocated_bytes = std::stoull(argv[i + 1]);
+        } else if (flag == "--max-depth") {
+            options.limits.max_depth = std::stoull(argv[i + 1]);
+        } else if (flag == "--max-stack-bytes") {
+            options.limits.max_stack_bytes = std::stoull(argv[i + 1]);
+        } else if (flag == "--io-timeout-ms") {
+            options.io_timeout = std::chrono::milliseconds(std::stoull(argv[i + 1]));
+        } else {
+            std::cerr << "Unknown flag " << flag << "\n";
+            return 2;
+        }
+    }
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    Server server(options);
+    std::thread stopper([&] {
+        int signal;
+        sigwait(&signals, &signal);
+        server.Stop();
+    });
+    stopper.detach();
+    std::cerr << "Listening on " << options.socket_path << " with " << options.worker_count
+              << " workers\n";
+    server.Serve();
+    return 0;
+}